@@ -1,443 +1,422 @@
 #ifndef ALK_HPP
 #define ALK_HPP
 
-#include "cnf2knf.hpp"
+#include <climits>
+#include <unordered_set>
+
+#include "encoded_AMO.hpp"
 
 
 namespace cnf2knf {
 
 using namespace std;
 
-class ALK : public Extraction_engine {
+// Encoded cardinality constraints with arbitrary bounds, such as totalizers
+// and sequential counters.  Clusters are found as for encoded AMOs, but
+// from clauses up to size three.  Clusters are recognized by propagating
+// threshold functions through the encoding (see 'recognize_threshold') and
+// otherwise validated with BDDs (within the size limits of 'Encoded_AMO').
+
+class ALK : public Encoded_AMO {
 
-    public: 
+    public:
 
-        using Extraction_engine::Extraction_engine;
+        using Encoded_AMO::Encoded_AMO;
 
         void init (unordered_map<string, string> engine_options) {
-            ;
+            Encoded_AMO::init (engine_options);
+            AMO = false;
+            max_clause_size = 3;
         }
 
-        void run (double timeout) {
-
-            string temp_s;
-
-            this->stats = new Stats(); // start clock running
-
-            this->timeout = timeout;
-            
-            bool found = true;
-            while (found) {
-                // classify_variables();
-
-                found = false;
-
-                int old_succ = cnf_extractor->stats.bdd_analyze_successes;
-
-                vector<int> e_vars;
-                vector<int> p_vars;
-                vector<int> cls_ids;
-
-                for (int i = 1; i <= 49 ; i++) p_vars.push_back (i);
-                for (int i = 50; i <= 281; i++) e_vars.push_back (i);
-                for (int i = 91; i <= 1000; i++) cls_ids.push_back (i);
-
-                cnf_extractor->validate_constraint (p_vars, e_vars, cls_ids);
-                break;
-
-                // for (unsigned i = 0; i < encoding_variable_list.size(); i++ ) {
-                //     vector<int> e_vars = encoding_variable_list[i];
-                //     vector<int> p_vars = problem_variable_list[i];
-                //     vector<int> cls_ids = cls_ids_list[i];
-
-                //     cnf_extractor->validate_constraint (p_vars, e_vars, cls_ids);
-                // }
 
-                 int new_succ = cnf_extractor->stats.bdd_analyze_successes;
-
-                 if (new_succ > old_succ) found = true;
-
-                // check timeout (may to need nest this)
-                if (stats->get_elapsed_time() > timeout) {
-                    stats->set_end_time();
-                    reached_timeout = true; 
-                    break;
+    protected:
+
+    // Threshold function '|S & support| >= bound' of the set 'S' of true
+    // problem literals (as local indices), which is constant true for bound
+    // zero and constant false for bounds larger than the support.
+    struct Threshold {
+        vector<int> support;
+        int         bound;
+    };
+
+    // Part of a rule for the function of one atom, i.e., a threshold over
+    // the union of some blocks of problem literals.
+    struct Item {
+        vector<int> blocks;
+        int         bound;
+    };
+
+    // Limit on the work of recognizing a cluster, per clause and in total.
+    static const int64_t threshold_work_per_clause = 1 << 10;
+    static const int64_t max_threshold_work = 1 << 26;
+
+    // Both counting directions, with the auxiliary variables of the
+    // direction and then of both directions.
+    bool recognize (Cluster & cluster) const {
+        for (int both = 0; both < 2; both++)
+            for (int flip = 0; flip < 2; flip++) {
+                Cluster candidate = cluster;
+                auxiliary_variables (candidate, flip);
+                if (both) auxiliary_variables (candidate, !flip);
+                if (recognize_threshold (candidate, flip)) {
+                    cluster = candidate;
+                    return true;
                 }
             }
+        return false;
+    }
 
-        }
-
-        void write_stats () {}
-
-
-    private:
-
-    unordered_map<int, int> variable_polarities;
-
-    set<int> temp_depends;
-
-    unordered_map<int, set<int>> lit2cls_idxs;
-    unordered_map<int, vector<int>> lit_dependencies;
-    unordered_map<int, set<int>> rev_lit_dependencies;
-    vector<int> literal_types;
-    vector<int> variable_types;
-
-    vector<int> variable_max_cls_size;
-
-    vector<vector<int>> encoding_variable_list;
-    vector<vector<int>> problem_variable_list;
-    vector<vector<int>> cls_ids_list;
-
-    set<int> seen_e_vars;
+    // Clusters which only project to clauses (such as two ternary clauses
+    // with a common auxiliary variable) are left to the solver.
+    void analyze (Cluster & cluster) {
+        Encoded_AMO::analyze (cluster);
+        for (auto & klause : cluster.klauses) if (klause.is_klause ()) return;
+        cluster.klauses.clear ();
+    }
 
-    void lit2cls_map () {
-        for (unsigned cls_idx = 0; cls_idx < cnf_extractor->clauses.size (); cls_idx++) {
-            auto cls = cnf_extractor->clauses[cls_idx];
-            if (cls.deleted) continue;
-            for (auto lit : cls.literals) {
-                lit2cls_idxs[lit].insert (cls_idx);
-            }
+    // Auxiliary variables which occur with one sign only end up as problem
+    // variables, such as unused outputs of a counter (the upper outputs of a
+    // totalizer for 'at most k') and the counter variables of the first
+    // position in a sequential counter, which are fixed by unit clauses.
+    // They are moved to the encoding variables if they occur in no other
+    // clauses and either occur in a unit clause or could be the head of all
+    // their clauses.  This is sound for any variable which only occurs in
+    // the cluster, as it is existentially quantified.
+    void auxiliary_variables (Cluster & cluster, bool flip) const {
+        const Clause_store &clauses = cnf_extractor->clauses;
+        const vector<int> & ids = cluster.clause_ids;
+        unordered_set<int> problem (cluster.problem_variables.begin (), cluster.problem_variables.end ());
+        vector<int> problem_variables, outputs;
+        for (auto var : cluster.problem_variables) {
+            bool local = true, unit = false, output = true;
+            for (int lit : {var, -var})
+                for (auto cls_idx : clauses.occurrences_of (lit)) {
+                    if (!binary_search (ids.begin (), ids.end (), cls_idx)) local = false;
+                    if (clauses.get_size (cls_idx) == 1) unit = true;
+                    if ((lit > 0) == flip) output = false;
+                    for (auto other : clauses.literals_of (cls_idx))
+                        if (((other > 0) != flip) && other != lit && !problem.count (abs(other))) output = false;
+                }
+            if (local && (unit || output)) outputs.push_back (var);
+            else problem_variables.push_back (var);
         }
+        cluster.problem_variables = problem_variables;
+        cluster.encoding_variables.insert (cluster.encoding_variables.end (), outputs.begin (), outputs.end ());
     }
 
-    void in_clause_size_n () {
-        for (int i = 0; i <= cnf_extractor->nvars; i++)
-            variable_max_cls_size.push_back (0);
-        
-        for (auto cls : cnf_extractor->clauses) {
-            if (cls.deleted) continue;
-            unsigned size = cls.literals.size ();
-            for (auto lit : cls.literals) {
-                if (size > variable_max_cls_size [abs (lit)])
-                    variable_max_cls_size [abs (lit)] = size;
+    // If every clause has at most one positive encoding literal, the clauses
+    // are Horn clauses 'body -> head' for any assignment to the problem
+    // variables, where the problem variables occur with one sign only, say
+    // as '-l', and thus as 'l' in the bodies.  Clauses without head derive
+    // false ('bottom').  Such a formula is satisfiable iff its least model
+    // does not contain 'bottom', and an atom is in the least model iff the
+    // function of one of its rules (the conjunction of its body) is true.
+    // Totalizers and sequential counters (with 'flip' also those counting
+    // with negated outputs) assign to every output a threshold function over
+    // the problem literals of its subtree or prefix.  Thus the functions are
+    // computed as thresholds, bottom up from the problem literals, and the
+    // clauses encode 'at most t-1 of the l' if the function of 'bottom' is
+    // the threshold 't' over all problem literals.
+    //
+    // The function of an atom only depends on the number of true literals
+    // in each block of the coarsest partition of its support which respects
+    // the supports of the items in its rules, and whether it is a threshold
+    // is decided over these counts (see 'threshold_bound').  Recognition
+    // fails for cyclic rules, functions which are not thresholds (as in
+    // sorting networks) and if the work exceeds its limit.
+    bool recognize_threshold (Cluster & cluster, bool flip) const {
+        const Clause_store &clauses = cnf_extractor->clauses;
+        int n = cluster.problem_variables.size ();
+        int m = cluster.encoding_variables.size ();
+        int bottom = m;
+
+        unordered_map<int,int> index;
+        for (int i = 0; i < n; i++) index[cluster.problem_variables[i]] = i;
+        for (int a = 0; a < m; a++) index[cluster.encoding_variables[a]] = n + a;
+
+        // rules as bodies of atoms (and negative problem items '-1-i')
+        vector<int> sign (n, 0);
+        vector<vector<int>> bodies;
+        vector<vector<int>> rules_of (m + 1), depends (m + 1);
+        for (auto cls_idx : cluster.clause_ids) {
+            int head = bottom;
+            vector<int> body;
+            for (auto lit : clauses.literals_of (cls_idx)) {
+                int i = index[abs(lit)];
+                if (i < n) {
+                    int s = (lit < 0) ? -1 : 1;
+                    if (sign[i] && sign[i] != s) return false;
+                    sign[i] = s;
+                    body.push_back (-1 - i);
+                }
+                else if ((lit > 0) != flip) {
+                    if (head != bottom) return false; // not Horn
+                    head = i - n;
+                }
+                else body.push_back (i - n);
             }
+            for (auto item : body) if (item >= 0) depends[head].push_back (item);
+            rules_of[head].push_back (bodies.size ());
+            bodies.push_back (body);
+        }
+        for (int i = 0; i < n; i++) if (!sign[i]) return false;
+
+        // atoms needed for 'bottom' in topological order
+        vector<int> order, state (m + 1, 0);
+        vector<pair<int,size_t>> stack;
+        stack.push_back ({bottom, 0});
+        state[bottom] = 1;
+        while (!stack.empty ()) {
+            int h = stack.back ().first;
+            size_t & next = stack.back ().second;
+            if (next < depends[h].size ()) {
+                int a = depends[h][next++];
+                if (state[a] == 1) return false; // cyclic
+                if (!state[a]) { state[a] = 1; stack.push_back ({a, 0}); }
+            }
+            else { state[h] = 2; order.push_back (h); stack.pop_back (); }
         }
-    }
-
-    void make_maps () {
 
-        lit2cls_idxs.clear ();
-        lit2cls_map ();
+        int64_t budget = threshold_work_per_clause * (int64_t) cluster.clause_ids.size ();
+        if (budget > max_threshold_work) budget = max_threshold_work;
+        vector<Threshold> function (m + 1);
+        vector<int> block_of (n, -1);
+        for (auto h : order) {
+            if (!threshold_of (h, rules_of[h], bodies, function, block_of, budget)) return false;
+            if (budget < 0) return false;
+        }
 
-        variable_max_cls_size.clear ();
-        in_clause_size_n ();
+        const Threshold & result = function[bottom];
+        int t = result.bound;
+        if ((int) result.support.size () != n || t < 2 || t >= n) return false;
 
+        // at most 't-1' of the 'l_i', i.e., at least 'n-t+1' of the literals in the clauses
+        vector<int> literals;
+        for (int i = 0; i < n; i++) literals.push_back (sign[i] * cluster.problem_variables[i]);
+        cluster.klauses.push_back (Klause (literals, n - t + 1));
+        return true;
     }
 
-    // Checks is the formula F(lit) is pure,
-    // i.e., all variables occur in a single polarity.
-    bool is_pure_formula (int in_lit) {
-        bool res = true;
-
-        variable_polarities.clear ();
-        temp_depends.clear ();
-
-        for (auto cls_idx : lit2cls_idxs[in_lit]) {
-            // skip deleted clauses
-            if (cnf_extractor->clauses[cls_idx].deleted) continue;
-
-            // check if literals are pure in all clauses F(lit)
-            for (auto lit : cnf_extractor->clauses[cls_idx].literals) {
-                int var = abs(lit);
-                int polarity = var/lit;
-                auto map_element = variable_polarities.find (var);
-                if (map_element != variable_polarities.end()) {
-                    if (map_element->second != polarity) {
-                        res = false;
-                        break;
-                    }
-                } else {
-                    variable_polarities[var] = polarity;
-                    if (lit != in_lit)
-                        temp_depends.insert (lit);
+    // Compute the function of atom 'h' from the functions of its bodies,
+    // return false if it is not a threshold.
+    bool threshold_of (int h, const vector<int> & rules, const vector<vector<int>> & bodies, vector<Threshold> & function, vector<int> & block_of, int64_t & budget) const {
+        // supports and bounds of the items (problem literals without
+        // support), without constant rules and items
+        vector<vector<pair<const vector<int> *, int>>> live;
+        for (auto r : rules) {
+            vector<pair<const vector<int> *, int>> items;
+            bool constant_false = false;
+            for (auto item : bodies[r]) {
+                if (item < 0) {
+                    items.push_back ({nullptr, -1 - item});
+                    continue;
                 }
+                const Threshold & f = function[item];
+                if (f.bound > (int) f.support.size ()) { constant_false = true; break; }
+                if (f.bound > 0) items.push_back ({&f.support, f.bound});
             }
-            if (!res) break;
+            if (constant_false) continue;
+            if (items.empty ()) { function[h] = Threshold { {}, 0 }; return true; }
+            live.push_back (items);
         }
-
-        if (res) {
-            // add dependencies for pure formula,
-            // i.e., all variables in F(lit)
-            // and reverse dependencies for post-processing
-            for (auto map_element = variable_polarities.begin (); map_element != variable_polarities.end(); map_element++) {
-                rev_lit_dependencies[map_element->first].insert (in_lit);
-                // cout << in_lit << " depends on " << map_element->first << endl;
+        if (live.empty ()) { function[h] = Threshold { {}, 1 }; return true; }
+
+        // Coarsest partition of the union of the supports into blocks.  Each
+        // support splits the blocks it intersects, where 'key' zero stands
+        // for literals not in any block yet.
+        vector<int> elements, split_to (1), split_stamp (1, 0);
+        int nblocks = 0, stamp = 0;
+        auto refine = [&](const int * first, const int * last) {
+            stamp++;
+            for (const int * p = first; p != last; p++) {
+                int v = *p, key = block_of[v] + 1;
+                if (split_stamp[key] != stamp) {
+                    split_stamp[key] = stamp;
+                    split_to[key] = nblocks++;
+                    split_stamp.push_back (0);
+                    split_to.push_back (0);
+                }
+                if (key == 0) elements.push_back (v);
+                block_of[v] = split_to[key];
             }
-            lit_dependencies[in_lit] = vector<int> (temp_depends.begin(), temp_depends.end ());
-            // exit (1);
-        }
-
-        return res;
-    }
-
-    // index lits into an array
-    // -1,1,-2,2, ... nvar (2 *nvar-1)
-    int lit2var (int lit) {if (lit > 0) return 2*lit-1; else return 2*(abs(lit))-2;}
-
-    void variables_from_clauses (int in_lit, set<int> &variables) {
-        for (auto cls_idx : lit2cls_idxs[in_lit]) {
-            // skip deleted clauses
-            if (cnf_extractor->clauses[cls_idx].deleted) continue;
-
-            for (auto lit : cnf_extractor->clauses[cls_idx].literals) {
-                if (lit == in_lit) continue;
-                int var = abs(lit);
-                // add to set
-                variables.insert (var);
-                // if (variables.find (var) == variables.end ()}// && variable_types [var] != 4) {
-                    
-                // } 
+            budget -= last - first;
+        };
+        for (auto & items : live)
+            for (auto & item : items) {
+                if (item.first) refine (item.first->data (), item.first->data () + item.first->size ());
+                else refine (&item.second, &item.second + 1);
             }
-        }
-    }
 
-    void variables_from_clauses_with_ids (int in_lit, set<int> &variables, set<int> &cls_ids) {
-        for (auto cls_idx : lit2cls_idxs[in_lit]) {
-            // skip deleted clauses
-            if (cnf_extractor->clauses[cls_idx].deleted) continue;
-            
-            cls_ids.insert (cls_idx);
-
-            for (auto lit : cnf_extractor->clauses[cls_idx].literals) {
-                if (lit == in_lit) continue;
-                int var = abs(lit);
-                // add to set
-                if (variable_types [var] != 4)
-                    variables.insert (var);
+        vector<int> dense (nblocks, -1), size;
+        for (auto v : elements) {
+            int & b = dense[block_of[v]];
+            if (b < 0) { b = size.size (); size.push_back (0); }
+            size[b]++;
+        }
+        vector<vector<Item>> formula;
+        vector<int> seen (size.size (), -1);
+        int nitems = 0;
+        for (auto & items : live) {
+            vector<Item> rule;
+            for (auto & item : items) {
+                Item it;
+                it.bound = item.first ? item.second : 1;
+                auto add_block = [&](int v) {
+                    int b = dense[block_of[v]];
+                    if (seen[b] != nitems) { seen[b] = nitems; it.blocks.push_back (b); }
+                };
+                if (item.first) for (auto v : *item.first) add_block (v);
+                else add_block (item.second);
+                nitems++;
+                rule.push_back (it);
             }
+            formula.push_back (rule);
         }
-    }
-
-    // vector<int> get_problem_variables () {
-    //     set<int> problem_variables;
 
-    //     for (int var = 1; var <= cnf_extractor->nvars; var++ ) {
-    //         if (variable_types [var] == 4) {
-    //             // Get variables from clauses
-    //             variables_from_clauses (var, problem_variables);
-    //             variables_from_clauses (-var, problem_variables);
-    //         }
-    //     }
-
-    //     return vector<int> (problem_variables.begin (), problem_variables.end ());
-    // }
-
-    void get_problem_variables (set<int> e_vars, set<int> &p_vars, set<int> &cls_ids) {
-
-        for (auto var : e_vars) {
-            variables_from_clauses_with_ids (var, p_vars, cls_ids);
-            variables_from_clauses_with_ids (-var, p_vars, cls_ids);
-        }
+        Threshold & res = function[h];
+        res.support = elements;
+        sort (res.support.begin (), res.support.end ());
+        for (auto v : elements) block_of[v] = -1;
 
+        int t;
+        if (!threshold_bound (formula, size, t, budget)) return false;
+        if (t <= 0) res.support.clear ();
+        res.bound = (t < 0) ? 1 : t;
+        return true;
     }
 
-    void get_encoding_variables (int in_var, set<int> &variables) {
-
-        set<int> frontier;
-
-        frontier.insert (in_var);
-
-        while (!frontier.empty ()) {
-            set<int> next_frontier;
-
-            for (auto var: frontier) {
-                
-                // touched variables
-                set<int> new_variables;
-                variables_from_clauses (var, new_variables);
-                variables_from_clauses (-var, new_variables);
-
-                for (auto new_var : new_variables) {
-                    if (seen_e_vars.find (new_var) != seen_e_vars.end ())
-                        continue;
-                    if (variable_types [new_var] != 4) 
-                        continue;
-                    seen_e_vars.insert (new_var);
-                    variables.insert (new_var);
-                    next_frontier.insert (new_var);
+    // Decide whether the function of 'formula' over blocks with 'size'
+    // literals is a threshold and find its bound ('-1' if constant false).
+    // Dynamic programming over the blocks, where a state consists of the
+    // alive rules (without an item below its bound after the last block of
+    // the item) and the counts of the open items of alive rules, capped at
+    // their bounds.  The function is true as soon as a rule is complete and
+    // false as soon as all rules are dead, such that only the smallest total
+    // for true and the largest total for false are needed, and it is a
+    // threshold iff the latter is smaller.  The blocks are sorted such that
+    // nested items start at the same block, which keeps the states few for
+    // counters (where the items are nested or disjoint).
+    bool threshold_bound (const vector<vector<Item>> & formula, const vector<int> & size, int & bound, int64_t & budget) const {
+        int nblocks = size.size (), nrules = formula.size ();
+        vector<const Item *> items;
+        vector<int> rule_of, total_after (nblocks + 1, 0);
+        for (int r = 0; r < nrules; r++)
+            for (auto & item : formula[r]) {
+                items.push_back (&item);
+                rule_of.push_back (r);
+            }
+        int nitems = items.size ();
+
+        // Order of the blocks refined by the items from the largest, where
+        // the blocks of an item move to the front of their group.
+        vector<int> by_size (nitems);
+        for (int k = 0; k < nitems; k++) by_size[k] = k;
+        stable_sort (by_size.begin (), by_size.end (), [&](int a, int b) { return items[a]->blocks.size () > items[b]->blocks.size (); });
+        vector<int> order (nblocks), position (nblocks), group_of (nblocks, 0);
+        vector<int> group_start (1, 0), group_end (1, nblocks), moved (1, 0), touched;
+        for (int b = 0; b < nblocks; b++) order[b] = position[b] = b;
+        for (auto k : by_size) {
+            touched.clear ();
+            for (auto b : items[k]->blocks) {
+                int g = group_of[b];
+                if (!moved[g]) touched.push_back (g);
+                int q = group_start[g] + moved[g]++, other = order[q];
+                order[position[b]] = other;
+                position[other] = position[b];
+                order[q] = b;
+                position[b] = q;
+            }
+            for (auto g : touched) {
+                if (moved[g] < group_end[g] - group_start[g]) {
+                    int h = group_start.size ();
+                    group_start.push_back (group_start[g]);
+                    group_end.push_back (group_start[g] + moved[g]);
+                    moved.push_back (0);
+                    for (int q = group_start[h]; q < group_end[h]; q++) group_of[order[q]] = h;
+                    group_start[g] = group_end[h];
                 }
+                moved[g] = 0;
             }
-
-            frontier.clear ();
-            frontier.insert (next_frontier.begin(), next_frontier.end());
-            next_frontier.clear();
+            budget -= items[k]->blocks.size ();
         }
-    }
-
-    void expand_encoding_variables (int var) {
-        set<int> e_vars, p_vars, cls_ids;
-
-        // expand encoding variables
-        get_encoding_variables (var, e_vars); 
-
-        // expand to problem variables and get
-        get_problem_variables (e_vars, p_vars, cls_ids);
-
-        // add to list of found constraints
-        encoding_variable_list.push_back (vector<int> (e_vars.begin (), e_vars.end ()));
-        problem_variable_list.push_back (vector<int> (p_vars.begin (), p_vars.end ()));
-        cls_ids_list.push_back (vector<int> (cls_ids.begin (), cls_ids.end ()));
-    }
-
-
-    // Variable types:
-    //    0 : untyped (initial)
-    //    1 : pure (first pass)
-    //    2 : unpure (first pass)
-    //    3 : problem (some of the pure from first pass)
-    //    4 : encoding (some of the pure from first pass)
-    void classify_variables () {
-
-        string log_s;
-
-        literal_types.clear ();
-        variable_types.clear ();
-
-        int nvars = cnf_extractor->nvars;
-        for (unsigned i = literal_types.size(); i <= 2*nvars; i++ )
-            literal_types.push_back (0);
-        
-        // will I ever need to reset variable types?
-        // Yes, if clauses are deleted...
-        for (int i = 0; i <= 2*nvars; i++) {
-            literal_types[i] = 0;
-        }
-
-        for (int i = 0; i <= nvars; i++) {
-            variable_types.push_back (0);
-        }
-
-        make_maps ();
-
-        // reset maps
-        lit_dependencies.clear ();
-        rev_lit_dependencies.clear ();
-        
-        set<int> frontier;
-        vector<int> problem_variables;
-        // check if each lit is pure and build dependency map
-        for (int lit = -nvars; lit <= nvars; lit++) {
-            if (!lit) continue; // not a literal
-
-            if (variable_max_cls_size [abs (lit)] > 3 || variable_max_cls_size [abs (lit)] == 0)
-                literal_types [lit2var (lit)] = 2;
-            else if (is_pure_formula (lit)) {
-                literal_types [lit2var (lit)] = 1;
-                // preload frontier with pure literals
-                frontier.insert (lit);
-            } else 
-                literal_types [lit2var (lit)] = 2;
-        }
-
-        for (int i = 1; i <= nvars; i++) {
-            if (literal_types [lit2var (-i)] == 2 && literal_types [lit2var (i)] == 2)
-                variable_types[i] = 2;
+        for (int p = nblocks - 1; p >= 0; p--) total_after[p] = total_after[p + 1] + size[order[p]];
+
+        // items counted, finished and open after each block, rules completed
+        vector<vector<int>> counted (nblocks), finished (nblocks), open (nblocks), completed (nblocks);
+        vector<int> complete_at (nrules, 0);
+        for (int k = 0; k < nitems; k++) {
+            int first = nblocks, last = 0;
+            for (auto b : items[k]->blocks) {
+                counted[position[b]].push_back (k);
+                first = min (first, position[b]);
+                last = max (last, position[b]);
+            }
+            finished[last].push_back (k);
+            for (int p = first; p < last; p++) open[p].push_back (k);
+            complete_at[rule_of[k]] = max (complete_at[rule_of[k]], last);
         }
-
-        // process dependencies
-        bool first_pass = true;
-        while (!frontier.empty ()) {
-            set<int> next_frontier;
-
-            // get non dependent variables (all unpure or encoding)
-            for (auto lit: frontier) {
-                // skip non pure, or already assigned types
-                int lit_type = literal_types [lit2var (lit)]; 
-                if (lit_type == 2 || lit_type == 4) continue;
-                lit_type = literal_types [lit2var (-lit)]; 
-                if (lit_type == 2 || lit_type == 4) continue;
-
-                int var_type = variable_types [abs (lit)];
-                if (var_type == 2 || var_type == 4) continue;
-
-                //logging
-                log_s = "checking literal: " + to_string(lit);
-                log_comment (log_s , 3);
-
-                // check if non dependent
-                bool encoding = true;
-                for (auto dep_lit: lit_dependencies[lit]) {
-                    int dep_type = literal_types [lit2var (dep_lit)];
-                    int var_type = variable_types [abs (dep_lit)];
-                    if (dep_type == 1 && var_type == 0) {
-                        encoding = false;
-                        break;
+        for (int r = 0; r < nrules; r++) completed[complete_at[r]].push_back (r);
+
+        // States as alive flags of the rules (one bit each) followed by the
+        // counts of the open items, mapped to the smallest and largest total
+        // so far.
+        int nwords = (nrules + 31) / 32;
+        auto alive = [](const vector<int> & key, int r) { return ((unsigned) key[r / 32] >> (r % 32)) & 1; };
+        unordered_map<vector<int>, pair<int,int>, vec_key_hash> states, next;
+        vector<int> initial (nwords, 0);
+        for (int r = 0; r < nrules; r++) initial[r / 32] |= 1u << (r % 32);
+        states[initial] = {0, 0};
+        int smallest_true = INT_MAX, largest_false = -1;
+        vector<int> count (nitems, 0), is_counted (nitems, -1), key;
+        for (int p = 0; p < nblocks; p++) {
+            for (auto k : counted[p]) is_counted[k] = p;
+            next.clear ();
+            for (auto & state : states) {
+                const vector<int> & from = state.first;
+                if (p) for (size_t i = 0; i < open[p - 1].size (); i++) count[open[p - 1][i]] = from[nwords + i];
+                for (int c = 0; c <= size[order[p]]; c++) {
+                    auto count_of = [&](int k) { return min (count[k] + (is_counted[k] == p ? c : 0), items[k]->bound); };
+                    key.assign (from.begin (), from.begin () + nwords);
+                    for (auto k : finished[p]) {
+                        int r = rule_of[k];
+                        if (alive (key, r) && count_of (k) < items[k]->bound) key[r / 32] &= ~(1u << (r % 32));
                     }
-                }
-                if (encoding) {
-                    //logging
-                    log_s = "new encoding literal found: " + to_string(lit);
-                    log_comment (log_s , 3);
-
-                    literal_types [lit2var (lit)] = 4;
-                    variable_types [abs (lit)] = 4;
-
-                    bool problem_variable = true;
-                    // add reverse depends onto frontier
-                    for (auto rev_dep_lit: rev_lit_dependencies[lit]) {
-                        if (literal_types [lit2var (rev_dep_lit)] == 1)
-                            problem_variable = false;
-                        if (next_frontier.find (rev_dep_lit) == next_frontier.end ()) {
-                            next_frontier.insert (rev_dep_lit);
-                            next_frontier.insert (-rev_dep_lit);
-                        }
+                    bool satisfied = false;
+                    for (auto r : completed[p]) if (alive (key, r)) satisfied = true;
+                    if (satisfied) {
+                        smallest_true = min (smallest_true, state.second.first + c);
+                        continue;
                     }
-                    for (auto rev_dep_lit: rev_lit_dependencies[-lit]) {
-                        if (literal_types [lit2var (rev_dep_lit)] == 1)
-                            problem_variable = false;
-                        if (next_frontier.find (rev_dep_lit) == next_frontier.end ()){
-                            next_frontier.insert (rev_dep_lit);
-                            next_frontier.insert (-rev_dep_lit);
-                        }
+                    bool any = false;
+                    for (int i = 0; i < nwords && !any; i++) any = key[i];
+                    if (!any) {
+                        largest_false = max (largest_false, state.second.second + c + total_after[p + 1]);
+                        continue;
+                    }
+                    for (auto k : open[p]) key.push_back (alive (key, rule_of[k]) ? count_of (k) : 0);
+                    budget -= key.size () + finished[p].size () + completed[p].size ();
+                    auto it = next.find (key);
+                    if (it == next.end ()) next[key] = {state.second.first + c, state.second.second + c};
+                    else {
+                        it->second.first = min (it->second.first, state.second.first + c);
+                        it->second.second = max (it->second.second, state.second.second + c);
                     }
-                    // if (problem_variable) 
-                    //     problem_variables.insert (abs(lit));
                 }
             }
-
-            if (first_pass) log_comment ("Finished first pass" , 3);
-
-            // cout << "c size " << next_frontier.size () << endl;
-
-            first_pass = false;
-            frontier.clear ();
-            frontier.insert (next_frontier.begin(), next_frontier.end());
-            next_frontier.clear();
+            if (budget < 0) return false;
+            states.swap (next);
         }
 
-
-        encoding_variable_list.clear ();
-        problem_variable_list.clear ();
-        cls_ids_list.clear ();
-        seen_e_vars.clear();
-
-        // Group encoding variables
-        for (int var = 1; var <= nvars; var++) {
-            if (variable_types [var] == 4 && seen_e_vars.find (var) == seen_e_vars.end ())
-                expand_encoding_variables (var);
-        }
-
-        // get problem variables from encoding variables (closure of encoding clauses)
-        // problem_variables = get_problem_variables ();
-
-        //logging (maps)
-        // log_comment ("problem variables " , 3);
-        // log_s = "";
-        // for (auto lit : problem_variables ) {
-        //     log_s += to_string (lit) + " ";
-        // } log_comment (log_s, 3);
-
-        // log_comment ("encoding variables " , 3);
-        // log_s = "";
-        // for (int i = 1; i <= nvars; i++ ) {
-        //     if (variable_types[i] == 4)
-        //         log_s += to_string (i) + " ";
-        // } log_comment (log_s, 3);
-
+        if (smallest_true == INT_MAX) bound = -1;
+        else if (largest_false < 0) bound = 0;
+        else if (largest_false < smallest_true) bound = smallest_true;
+        else return false;
+        return true;
     }
 
 };
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -17,7 +17,7 @@ using namespace trustbdd;
 
 
 
-    int Cnf_extractor::bdd_analyze (int nvar, int ndata, vector<vector<int>> &constraint_clauses) {
+    int Cnf_extractor::bdd_analyze (int nvar, int ndata, vector<vector<int>> &constraint_clauses, vector<Klause> &analyzed_klauses) {
         // number of klauses generated (0, 1, or 2)
         int nKlauses = 0;
         vector<int> lits;
@@ -30,21 +30,45 @@ using namespace trustbdd;
             int *data = literals.data();
             O.add_clause(data, len);
         }
-        ilist ordering = O.generate_ordering(seed);
+        // Bucket reduction under a bad variable ordering blows up, which is
+        // cut off by the node and time budgets, and then the next ordering
+        // (from another seed) is tried.  The first reduction that completes
+        // decides, since the resulting BDD does not depend on the ordering.
         int vlevel = 0;
-        TermSet T(nvar, ndata, ordering, vlevel);
-        for (auto literals : constraint_clauses) {
-            int len = literals.size();
-            int *data = literals.data();
-            T.add_clause(data, len);
+        int attempt, aborts = 0;
+        bool reduced = false, converted = false;
+        tbdd_set_node_limit(bdd_node_budget);
+        // not beyond the global time limit
+        double time_budget = bdd_time_budget;
+        if (time_limit > 0) {
+            double left = max(remaining_time(time_limit), 1e-3);
+            time_budget = (time_budget > 0) ? min(time_budget, left) : left;
         }
-        if (!T.bucket_reduce()) {
-            // cout << "c Bucket reduce failed" << endl;
+        for (attempt = 0; attempt < bdd_orderings && !reduced; attempt++) {
+            ilist ordering = O.generate_ordering(seed + attempt);
+            TermSet T(nvar, ndata, ordering, vlevel);
+            T.set_time_limit(time_budget);
+            for (auto literals : constraint_clauses) {
+                int len = literals.size();
+                int *data = literals.data();
+                T.add_clause(data, len);
+            }
+            reduced = T.bucket_reduce();
             ilist_free(ordering);
-            return 0;
+            if (!reduced) {
+                // cout << "c Bucket reduce failed" << endl;
+                if (T.budget_exceeded()) aborts++;
+                continue;
+            }
+            converted = T.cardinality_converter(lits, &lower, &upper);
+        }
+        bool later = reduced && attempt > 1;
+        if (aborts || later) {
+            lock_guard<mutex> guard (cache_lock);
+            stats.bdd_budget_aborts += aborts;
+            if (later) stats.bdd_later_orderings++;
         }
-        ilist_free(ordering);
-        if (!T.cardinality_converter(lits, &lower, &upper)) {
+        if (!converted) {
             // cout << "c No cardinality constraints found" << endl;
             return 0;
         }
@@ -0,0 +1,104 @@
+#ifndef CLAUSE_STORE_HPP
+#define CLAUSE_STORE_HPP
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <vector>
+
+
+namespace cnf2knf {
+
+using namespace std;
+
+// Read-only view of consecutive integers, literals of a clause or indices
+// of the clauses a literal occurs in.
+
+class Span {
+
+    public:
+
+        Span (const int * first, const int * last) : first (first), last (last) {}
+
+        const int * begin () const { return first; }
+        const int * end () const { return last; }
+        int size () const { return last - first; }
+        int operator[] (int i) const { return first[i]; }
+
+    private:
+
+        const int * first;
+        const int * last;
+};
+
+// Clauses of the original CNF in one flat literal array ('compressed sparse
+// row' format), where the literals of clause 'i' are at positions
+// 'offsets[i]' up to 'offsets[i+1]'.  After parsing 'build_occurrences'
+// computes for every literal the (increasing) indices of the clauses it
+// occurs in, again as one flat array, which all engines share.
+
+class Clause_store {
+
+    public:
+
+        Clause_store () { offsets.push_back (0); }
+
+        // number of clauses
+        int size () const { return offsets.size () - 1; }
+
+        void reserve (size_t nclauses) { offsets.reserve (nclauses + 1); deleted.reserve (nclauses); }
+
+        void add (const vector<int> & clause) {
+            literals.insert (literals.end (), clause.begin (), clause.end ());
+            offsets.push_back (literals.size ());
+            deleted.push_back (false);
+        }
+
+        Span literals_of (int cls_idx) const {
+            const int * base = literals.data ();
+            return Span (base + offsets[cls_idx], base + offsets[cls_idx + 1]);
+        }
+
+        int get_size (int cls_idx) const { return offsets[cls_idx + 1] - offsets[cls_idx]; }
+
+        bool is_deleted (int cls_idx) const { return deleted[cls_idx]; }
+        void mark_deleted (int cls_idx) { deleted[cls_idx] = true; }
+
+        void build_occurrences () {
+            int max_var = 0;
+            for (auto lit : literals) if (abs (lit) > max_var) max_var = abs (lit);
+            occurrence_offsets.assign (2 * (size_t) max_var + 3, 0);
+            for (auto lit : literals) occurrence_offsets[lit2idx (lit) + 1]++;
+            for (size_t i = 1; i < occurrence_offsets.size (); i++)
+                occurrence_offsets[i] += occurrence_offsets[i - 1];
+            occurrences.resize (literals.size ());
+            vector<int64_t> next (occurrence_offsets.begin (), occurrence_offsets.end () - 1);
+            for (int cls_idx = 0; cls_idx < size (); cls_idx++)
+                for (auto lit : literals_of (cls_idx))
+                    occurrences[next[lit2idx (lit)]++] = cls_idx;
+        }
+
+        // clauses containing 'lit' (including deleted ones)
+        Span occurrences_of (int lit) const {
+            size_t idx = lit2idx (lit);
+            if (idx + 1 >= occurrence_offsets.size ()) return Span (NULL, NULL);
+            const int * base = occurrences.data ();
+            return Span (base + occurrence_offsets[idx], base + occurrence_offsets[idx + 1]);
+        }
+
+    private:
+
+        vector<int>     literals;
+        vector<int64_t> offsets;
+        vector<char>    deleted;
+
+        vector<int>     occurrences;
+        vector<int64_t> occurrence_offsets;
+
+        static size_t lit2idx (int lit) { return 2 * (size_t) abs (lit) + (lit < 0); }
+
+};
+
+}
+
+
+#endif
@@ -3,21 +3,104 @@
 #include "encoded_AMO.hpp"
 #include "ALK.hpp"
 
+#include <csignal>
+
 namespace cnf2knf {
 
 using namespace std;
 
-vector<int> flatten_vectors (vector<vector<int>> & clauses) {
+atomic<bool> Cnf_extractor::interrupted (false);
+
+// The first signal stops the extraction (see 'Extraction_engine::out_of_time'),
+// a second one terminates as usual.
+static void interrupt_extraction (int sig) {
+    Cnf_extractor::interrupted = true;
+    signal (sig, SIG_DFL);
+}
+
+vector<int> flatten_vectors (const vector<vector<int>> & clauses) {
     vector<int> res;
-    for (auto clause : clauses) {
+    for (auto & clause : clauses) {
         for (auto lit : clause) {
             res.push_back (lit);
         }
         res.push_back (0);
     }
+    return res;
+}
+
+// Renumber the variables of a normalized constraint (data variables 1 to
+// ndata, encoding variables up to nvar) and sort its clauses, such that
+// constraints built from the same template get the same 'canonical'
+// clauses.  Variables are distinguished by color refinement on their
+// occurrences until the partition is stable, and the remaining ties are
+// broken by the original numbering.  Thus isomorphic constraints are not
+// always recognized, but equal clauses always mean equal constraints.
+// Variable 'v' becomes 'label[v]'.
+void canonicalize (int nvar, int ndata, const vector<vector<int>> &clauses, vector<vector<int>> &canonical, vector<int> &label) {
+    vector<vector<int>> occurs (nvar + 1);
+    for (int i = 0; i < clauses.size (); i++)
+        for (auto lit : clauses[i]) occurs[abs(lit)].push_back (i);
+
+    vector<uint64_t> color (nvar + 1, 0), next (nvar + 1, 0), values, signature, others;
+    for (int v = 1; v <= nvar; v++) color[v] = (v <= ndata) ? 1 : 2;
+    size_t ncolors = 0;
+    while (true) {
+        for (int v = 1; v <= nvar; v++) {
+            signature.clear ();
+            for (auto i : occurs[v]) {
+                uint64_t own = 0;
+                others.clear ();
+                for (auto lit : clauses[i]) {
+                    uint64_t c = 2 * color[abs(lit)] + (lit < 0);
+                    if (abs(lit) == v) own = c;
+                    else others.push_back (c);
+                }
+                sort (others.begin (), others.end ());
+                uint64_t hash = mix_hash (own);
+                for (auto c : others) hash = mix_hash (hash ^ c);
+                signature.push_back (hash);
+            }
+            sort (signature.begin (), signature.end ());
+            uint64_t hash = mix_hash (color[v]);
+            for (auto s : signature) hash = mix_hash (hash ^ s);
+            next[v] = hash;
+        }
+        // replace hashes by their rank
+        values.assign (next.begin () + 1, next.end ());
+        sort (values.begin (), values.end ());
+        values.erase (unique (values.begin (), values.end ()), values.end ());
+        for (int v = 1; v <= nvar; v++)
+            color[v] = lower_bound (values.begin (), values.end (), next[v]) - values.begin () + 1;
+        if (values.size () == ncolors) break;
+        ncolors = values.size ();
+    }
+
+    vector<int> order;
+    for (int v = 1; v <= nvar; v++) order.push_back (v);
+    sort (order.begin (), order.end (), [&](int v1, int v2) {
+        if ((v1 > ndata) != (v2 > ndata)) return v1 <= ndata;
+        if (color[v1] != color[v2]) return color[v1] < color[v2];
+        return v1 < v2; });
+    label.assign (nvar + 1, 0);
+    for (int i = 0; i < nvar; i++) label[order[i]] = i + 1;
+
+    canonical = clauses;
+    for (auto & clause : canonical) {
+        for (auto & lit : clause) lit = (lit < 0) ? -label[-lit] : label[lit];
+        sort (clause.begin (), clause.end (), [](int l1, int l2) {
+            return abs(l1) < abs(l2) || (abs(l1) == abs(l2) && l1 < l2); });
+    }
+    sort (canonical.begin (), canonical.end ());
 }
 
 bool Cnf_extractor::validate_constraint (vector<int> &problem_variables, vector<int> &encoding_variables,  vector<int> &clause_ids) {
+    vector<Klause> analyzed_klauses;
+    analyze_constraint (problem_variables, encoding_variables, clause_ids, analyzed_klauses);
+    return add_analyzed_klauses (analyzed_klauses, clause_ids);
+}
+
+bool Cnf_extractor::analyze_constraint (const vector<int> &problem_variables, const vector<int> &encoding_variables, const vector<int> &clause_ids, vector<Klause> &analyzed_klauses) {
    // normalize variables and clauses
    vector<vector<int>> normalized_clauses;
    vector<int> literals;
@@ -53,9 +136,9 @@ bool Cnf_extractor::validate_constraint (vector<int> &problem_variables, vector<
        from_normalization[nvar-1] = var;
    }
    for (auto cls_idx : clause_ids) {
-       assert (!clauses[cls_idx].deleted);
+       assert (!clauses.is_deleted (cls_idx));
        literals.clear ();
-       for (auto lit : clauses[cls_idx].literals) {
+       for (auto lit : clauses.literals_of (cls_idx)) {
            assert (to_normalization.find (abs(lit)) != to_normalization.end ());
            literals.push_back ((abs(lit)/lit) * to_normalization[abs(lit)]);
        }
@@ -79,49 +162,81 @@ bool Cnf_extractor::validate_constraint (vector<int> &problem_variables, vector<
 
 
 
-   // // Attempt lookup in cache
-   // vector<int> flattened = flatten_vectors (normalized_clauses);
-   // if (constraint_cache.count (flattened)) {
-   //     // cache hit
+   // Attempt lookup in cache.  On a miss the clauses are analyzed as
+   // normalized (the BDD variable ordering depends on the numbering) and the
+   // result is stored with canonical literals, failures included.
+   vector<vector<int>> canonical_clauses;
+   vector<int> label;
+   canonicalize (nvar, nproblem, normalized_clauses, canonical_clauses, label);
+   vector<int> key = {nproblem, nvar};
+   vector<int> flattened = flatten_vectors (canonical_clauses);
+   key.insert (key.end (), flattened.begin (), flattened.end ());
+
+   bool cached;
+   {
+       lock_guard<mutex> guard (cache_lock);
+       auto it = constraint_cache.find (key);
+       cached = (it != constraint_cache.end ());
+       if (cached) {
+           analyzed_klauses = it->second;
+           stats.cache_hits++;
+       }
+       else stats.cache_misses++;
+   }
 
+   if (cached) {
+       log_ex_comment ("Found in cache", 2);
+       vector<int> unlabel (nvar + 1);
+       for (int v = 1; v <= nvar; v++) unlabel[label[v]] = v;
+       for (auto & klause : analyzed_klauses)
+           for (auto & lit : klause.literals) lit = (lit < 0) ? -unlabel[-lit] : unlabel[lit];
+   }
+   else {
+       // calls bdd_analyze
+       analyzed_klauses.clear();
+       log_ex_comment ("Entering bdd_analyze", 2);
+       // cout << "BDD_analyze " << nvar << " " << nproblem << endl;
+       bdd_analyze (nvar, nproblem, normalized_clauses, analyzed_klauses);
+       log_ex_comment ("Exiting bdd_analyze", 2);
+
+       vector<Klause> canonical_klauses = analyzed_klauses;
+       for (auto & klause : canonical_klauses)
+           for (auto & lit : klause.literals) lit = (lit < 0) ? -label[-lit] : label[lit];
+       lock_guard<mutex> guard (cache_lock);
+       constraint_cache.emplace (key, canonical_klauses);
+   }
+   nKlauses = analyzed_klauses.size ();
 
-   //     return nKlauses;
-   // }
-   
-   // calls bdd_analyze
-   analyzed_klauses.clear();
-   log_ex_comment ("Entering bdd_analyze", 2);
-   // cout << "BDD_analyze " << nvar << " " << nproblem << endl;
-   nKlauses = bdd_analyze (nvar, nproblem, normalized_clauses);
-   log_ex_comment ("Exiting bdd_analyze", 2);
+   // map literals in klauses back to original labelling
+   for (auto & klause : analyzed_klauses) {
+       for (int i = 0; i < klause.get_size() ; i++) {
+           int lit = klause.literals[i];
+           klause.literals[i] = (abs(lit)/lit) * from_normalization[abs(lit)];
+       }
+   }
+
+   return (nKlauses > 0);
+
+}
 
+bool Cnf_extractor::add_analyzed_klauses (const vector<Klause> &analyzed_klauses, const vector<int> &clause_ids) {
    // adds klause if success
-   if (nKlauses > 0) { // found valid klause(s)
-    //    cout << "found clause\n";
+   if (analyzed_klauses.size ()) { // found valid klause(s)
        stats.bdd_analyze_successes += 1;
 
        // add klauses
-       for (auto klause : analyzed_klauses) {
-           // map literals in klause back to original labelling
-           for (int i = 0; i < klause.get_size() ; i++) {
-               int lit = klause.literals[i];
-               klause.literals[i] = (abs(lit)/lit) * from_normalization[abs(lit)];
-           }
-
+       for (auto & klause : analyzed_klauses)
            add_klause(klause, clause_ids); // if two klauses will just mark clause_ids deleted twice
-       }
 
    } else { // failed 
-//    cout << "Failed" << endl;
        stats.bdd_analyze_failures += 1;
    }
 
-   return (nKlauses > 0);
-
+   return (analyzed_klauses.size () > 0);
 }
 
-void Cnf_extractor::mark_deleted_clauses (vector<int> clause_ids) {
-    for (int cls_id : clause_ids) clauses[cls_id].deleted = true;
+void Cnf_extractor::mark_deleted_clauses (const vector<int> &clause_ids) {
+    for (int cls_id : clause_ids) clauses.mark_deleted (cls_id);
 }
 
 void Cnf_extractor::extract_direct () {
@@ -152,6 +267,10 @@ void Cnf_extractor::extract_direct () {
 void Cnf_extractor::init () {
 
     this->logging = stoi (extractor_options["Extractor_logging"]); 
+    this->time_limit = stof (extractor_options["Timeout"]);
+    this->bdd_node_budget = stoi (extractor_options["BDD_node_budget"]);
+    this->bdd_time_budget = stof (extractor_options["BDD_time_budget"]);
+    this->bdd_orderings = max (1, stoi (extractor_options["BDD_orderings"]));
 
 }
 
@@ -161,16 +280,29 @@ void print_help () {
     cout << "****" << endl;
     cout << " Options set to a value:" << endl;
     cout << "-Direct_timeout <float>       (default 1000s)" << endl;
+    cout << "-Direct_budget <int>          (default 10000 search nodes per clique)" << endl;
+    cout << "-Threads <int>                (default 0 for all cores)" << endl;
     cout << "-Encoded_timeout <float>      (default 1000s)" << endl;
+    cout << "-Timeout <float>              (default 0 for none, time limit shared by all engines)" << endl;
     cout << "-Extractor_logging <int>      (default 0)" << endl;
     cout << "-Engine_logging <int>         (default 0)" << endl;
     cout << "-BDD_logging <int>            (default 0)" << endl;
+    cout << "-BDD_node_budget <int>        (default 1000000 nodes per ordering, 0 for no limit)" << endl;
+    cout << "-BDD_time_budget <float>      (default 10s per ordering, 0 for no limit)" << endl;
+    cout << "-BDD_orderings <int>          (default 1, variable orderings tried per constraint)" << endl;
+    cout << "-Binary_KNF <file>            (write binary KNF to <file>)" << endl;
+    cout << "-KNF_file <file>              (write KNF to <file>, default stdout)" << endl;
     cout << "****" << endl;
     cout << " Options set to true or false (--option=true OR --option=false)" << endl;
     cout << "--Direct_AMO           (default true)" << endl;
     cout << "--Direct_AMO_Small     (default true)" << endl;
+    cout << "--Direct_Clique_Cover  (default true, false for greedy cliques)" << endl;
     cout << "--Encoded_AMO          (default true)" << endl;
+    cout << "--Encoded_Others       (default true, other bounds from totalizers and sequential counters)" << endl;
     cout << "--Write_KNF            (default true)" << endl;
+    cout << "--Stream_KNF           (default false, write untouched clauses during extraction)" << endl;
+    cout << "****" << endl;
+    cout << " KNF files ending in .gz, .bz2 or .xz are compressed" << endl;
 }
 
 int Cnf_extractor::main (int argc, char ** argv) {
@@ -190,6 +322,7 @@ int Cnf_extractor::main (int argc, char ** argv) {
     // Parse input CNF formula
     char * input_file = argv[argc-1];
     parse_cnf(input_file);
+    clauses.build_occurrences ();
 
     // // Extract direct encoding
     // extract_direct();
@@ -205,28 +338,59 @@ int Cnf_extractor::main (int argc, char ** argv) {
     return res;
 }
 
-string literals2str (vector<int> literals) {
-    string s;
-    for (auto l : literals) s += to_string(l) + " ";
-    return s;
-}
+// Writes the header, the klauses and the clauses kept after extraction
+// which were not streamed already.  If clauses were streamed the header
+// written before is patched with the final counts.
 
-void Cnf_extractor::write_knf_formula () {
-    int nClauses_kept = 0;
-    for (auto clause : clauses) nClauses_kept += (clause.deleted)?0:1;
-    
-    // header
-    cout << "p knf " << nvars << " " << nClauses_kept + klauses.size() << endl;
+void Cnf_extractor::write_knf_formula (Knf_writer &writer) {
+    int64_t nClauses_kept = 0;
+    bool streaming = !streamed.empty ();
+    for (int i = 0; i < clauses.size (); i++) nClauses_kept += clauses.is_deleted (i)?0:1;
+
+    if (!streaming) writer.header (nvars, nClauses_kept, klauses.size (), false);
 
-    // klauses
-    for (auto klause : klauses)
-        cout << "k " << klause.cardinality_bound << " " << literals2str(klause.literals) << "0" << endl;
+    for (const auto &klause : klauses)
+        writer.klause (klause.cardinality_bound, klause.literals);
 
-    // clauses
-    for (auto clause : clauses) {
-        if (clause.deleted) continue;
-        cout << literals2str(clause.literals) << "0" << endl;
+    for (int i = 0; i < clauses.size (); i++) {
+        if (clauses.is_deleted (i) || (streaming && streamed[i])) continue;
+        writer.clause (clauses.literals_of (i));
     }
+
+    if (streaming) writer.patch_header (nvars, nClauses_kept, klauses.size ());
+}
+
+// Marks the clauses no extraction engine can delete, which are those with
+// more than two literals not containing an encoding variable.  Encoded_AMO
+// only collects longer clauses through encoding variables (variables
+// occurring in both polarities in clauses of at most 'max_clause_size' two)
+// while Direct_AMO only deletes binary clauses.  This has to be kept in sync
+// with the engines.
+
+void Cnf_extractor::mark_untouched_clauses () {
+    const int max_clause_size = 2;
+    vector<char> polarity (nvars + 1, 0);
+    for (int i = 0; i < clauses.size (); i++) {
+        if (clauses.get_size (i) > max_clause_size) continue;
+        for (auto lit : clauses.literals_of (i)) polarity[abs (lit)] |= (lit < 0) ? 2 : 1;
+    }
+    streamed.assign (clauses.size (), false);
+    for (int i = 0; i < clauses.size (); i++) {
+        if (clauses.is_deleted (i) || clauses.get_size (i) <= max_clause_size) continue;
+        bool untouched = true;
+        for (auto lit : clauses.literals_of (i))
+            if (polarity[abs (lit)] == 3) { untouched = false; break; }
+        streamed[i] = untouched;
+    }
+}
+
+// Writes the header with reserved space and the untouched clauses.  Runs
+// concurrently to the extraction engines, which only read these clauses.
+
+void Cnf_extractor::stream_clauses (Knf_writer *writer) {
+    writer->header (nvars, 0, 0, true);
+    for (int i = 0; i < clauses.size (); i++)
+        if (streamed[i]) writer->clause (clauses.literals_of (i));
 }
 
 void process_stats (Cnf_extractor * cnf_extractor, vector<Extraction_engine*> extraction_engines) {
@@ -236,13 +400,13 @@ void process_stats (Cnf_extractor * cnf_extractor, vector<Extraction_engine*> ex
 
     Direct_AMO *d_AMO = (Direct_AMO *) extraction_engines[0];
     Encoded_AMO *e_AMO = (Encoded_AMO *) extraction_engines[1];
-    Encoded_AMO *e_other = (Encoded_AMO *) extraction_engines[2];
+    ALK *e_other = (ALK *) extraction_engines[2];
 
     int total_constraints = 0;
     // if (d_AMO != NULL) total_constraints += d_AMO->stats->nconstraints;
     // if (e_AMO != NULL) total_constraints += e_AMO->stats->nconstraints;
-    for (auto clause : cnf_extractor->clauses) {
-        if (!clause.deleted) total_constraints++;
+    for (int i = 0; i < cnf_extractor->clauses.size (); i++) {
+        if (!cnf_extractor->clauses.is_deleted (i)) total_constraints++;
         // else {
         //     for (auto lit : clause.literals) cout << lit << " ";
         // } cout << endl;
@@ -271,6 +435,11 @@ void process_stats (Cnf_extractor * cnf_extractor, vector<Extraction_engine*> ex
             cout << "c Direct AMO sizes: " << temp_s << endl;
         }
 
+        if (d_AMO->clique_cover) {
+            cout << "c Direct AMO components: " << d_AMO->ncomponents << endl;
+            cout << "c Direct AMO budget exhausted: " << d_AMO->budget_exhausted << endl;
+        }
+
         cout << "c Direct AMO seconds: " << stats->get_final_time () + stats->extra_time << endl;
 
         if (d_AMO->reached_timeout) cout << "c Direct reached timeout: " << d_AMO->timeout << endl;
@@ -280,6 +449,7 @@ void process_stats (Cnf_extractor * cnf_extractor, vector<Extraction_engine*> ex
         Stats * stats = e_AMO->stats;
         total_card_constraints += stats->nconstraints;
         cout << "c Encoded AMO constraints: " << stats->nconstraints << endl;
+        cout << "c Encoded AMO pattern matches: " << stats->pattern_matches << endl;
         if (stats->nconstraints > 0) {
             string temp_s = "";
             vector<tuple<int,int>> pair_sizes;
@@ -314,6 +484,7 @@ void process_stats (Cnf_extractor * cnf_extractor, vector<Extraction_engine*> ex
         Stats * stats = e_other->stats;
         total_card_constraints += stats->nconstraints;
         cout << "c Other constraints: " << stats->nconstraints << endl;
+        cout << "c Other pattern matches: " << stats->pattern_matches << endl;
         if (stats->nconstraints > 0) {
             string temp_s = "";
             vector<tuple<int,int>> pair_sizes;
@@ -338,7 +509,7 @@ void process_stats (Cnf_extractor * cnf_extractor, vector<Extraction_engine*> ex
 
         cout << "c Other constraint seconds: " << stats->get_final_time () + stats->extra_time << endl;
 
-        if (e_AMO->reached_timeout) cout << "c Other reached timeout: " << e_AMO->timeout << endl;
+        if (e_other->reached_timeout) cout << "c Other reached timeout: " << e_other->timeout << endl;
 
         bdd_successes += stats->bdd_analyze_successes;
         bdd_failures += stats->bdd_analyze_failures;
@@ -346,7 +517,14 @@ void process_stats (Cnf_extractor * cnf_extractor, vector<Extraction_engine*> ex
 
     cout << "c BDD analyze successes " << cnf_extractor->stats.bdd_analyze_successes << endl;
     cout << "c BDD analyze failures " << cnf_extractor->stats.bdd_analyze_failures << endl;
-
+    cout << "c BDD budget aborts " << cnf_extractor->stats.bdd_budget_aborts << endl;
+    cout << "c BDD later orderings " << cnf_extractor->stats.bdd_later_orderings << endl;
+    cout << "c BDD cache hits " << cnf_extractor->stats.cache_hits << endl;
+    cout << "c BDD cache misses " << cnf_extractor->stats.cache_misses << endl;
+
+    if (Cnf_extractor::interrupted) cout << "c Interrupted, constraints found so far are kept" << endl;
+    else if (cnf_extractor->time_limit > 0 && cnf_extractor->stats.get_final_time () > cnf_extractor->time_limit)
+        cout << "c Reached time limit: " << cnf_extractor->time_limit << endl;
     cout << "c Total seconds: " << cnf_extractor->stats.get_final_time () 
     << endl;
 
@@ -369,93 +547,142 @@ void Stats::write_stats() {
     cout << "c Total time " << total_time.count() << " seconds" << endl;
 }
 
-int run_extraction_engines (Cnf_extractor * cnf_extractor) {
-    vector<Extraction_engine*> extraction_engines;
+// Engines run one after another, since each classifies the variables on
+// the clauses left by the ones before.  Under a global time limit each gets
+// its share of the remaining time and can be interrupted.
+
+void Cnf_extractor::run_engines (vector<Extraction_engine*> & engines) {
     Direct_AMO *direct_AMO = NULL;
     Encoded_AMO *encoded_AMO = NULL;
-    Encoded_AMO *encoded_Others = NULL;
+    ALK *encoded_Others = NULL;
     double direct_AMO_timeout, encoded_AMO_timeout;
     unordered_map<string, string> engine_options;
-    unordered_map<string, string> extractor_options = cnf_extractor->extractor_options;
     int logging = stoi (extractor_options["Engine_logging"]);
 
     direct_AMO_timeout = encoded_AMO_timeout = 1000;
 
-
-    if (stof (extractor_options["Direct_timeout"]) > 0 ) {
-        direct_AMO_timeout = stof (cnf_extractor->extractor_options["Direct_timeout"] );
-    }
+    if (stof (extractor_options["Direct_timeout"]) > 0 )
+        direct_AMO_timeout = stof (extractor_options["Direct_timeout"]);
     if (stof (extractor_options["Encoded_timeout"]) > 0 )
-        encoded_AMO_timeout = stof (cnf_extractor->extractor_options["Encoded_timeout"] );
+        encoded_AMO_timeout = stof (extractor_options["Encoded_timeout"]);
+
+    engine_options["Threads"] = extractor_options["Threads"];
 
+    int nengines = (extractor_options["Direct_AMO"] == "true") + (extractor_options["Encoded_AMO"] == "true")
+                 + (extractor_options["Encoded_Others"] == "true");
 
     if (extractor_options["Direct_AMO"] == "true") { 
-        direct_AMO = new Direct_AMO (cnf_extractor,logging);
-        // cout << "c find direct AMOS" << endl;
+        direct_AMO = new Direct_AMO (this,logging);
+        engine_options["Clique_cover"] = extractor_options["Direct_Clique_Cover"];
+        engine_options["Clique_budget"] = extractor_options["Direct_budget"];
         direct_AMO->init (engine_options);
-        direct_AMO->run (direct_AMO_timeout);  
+        direct_AMO->run (share_of_time_limit (direct_AMO_timeout, nengines--));  
         direct_AMO->stats->set_end_time ();
 
         direct_AMO->clear_data ();  
     }
 
-
-
     if (extractor_options["Encoded_AMO"] == "true") { 
-        encoded_AMO = new Encoded_AMO (cnf_extractor,logging);
-        // cout << "c find encoded AMOS" << endl;
+        encoded_AMO = new Encoded_AMO (this,logging);
         encoded_AMO->init (engine_options);
-        encoded_AMO->run (encoded_AMO_timeout);  
+        encoded_AMO->run (share_of_time_limit (encoded_AMO_timeout, nengines--));  
         encoded_AMO->stats->set_end_time ();
     }
 
-    double small_time = 0;
     if (extractor_options["Direct_AMO"] == "true" && extractor_options["Direct_AMO_Small"] == "true") { 
-        // cout << "c find small direct AMOS" << endl;
-        small_time = direct_AMO->find_small_AMOs (); 
-        direct_AMO->stats->extra_time = small_time;
+        direct_AMO->stats->extra_time = direct_AMO->find_small_AMOs (); 
     }
 
     if (extractor_options["Encoded_Others"] == "true") {
-        engine_options["AMO"] = "false";
-        engine_options["Max_Size"] = "3";
-        encoded_Others = new Encoded_AMO (cnf_extractor,logging);
+        encoded_Others = new ALK (this,logging);
         encoded_Others->init (engine_options);
-        encoded_Others->run (encoded_AMO_timeout);  
+        encoded_Others->run (share_of_time_limit (encoded_AMO_timeout, nengines--));  
         encoded_Others->stats->set_end_time ();
     }
 
-    extraction_engines.push_back (direct_AMO);
-    extraction_engines.push_back (encoded_AMO);
-    extraction_engines.push_back (encoded_Others);
-
-    cnf_extractor->stats.set_end_time ();
+    engines.clear ();
+    engines.push_back (direct_AMO);
+    engines.push_back (encoded_AMO);
+    engines.push_back (encoded_Others);
 
-    process_stats(cnf_extractor, extraction_engines);
+    stats.set_end_time ();
+}
 
-    if (extractor_options["Write_KNF"] == "true")
-        cnf_extractor->write_knf_formula();
+void Cnf_extractor::add_clause (const vector<int> & clause) {
+    for (auto lit : clause) nvars = max (nvars, abs (lit));
+    clauses.add (clause);
+}
 
-    delete (direct_AMO);
-    delete (encoded_AMO);
-    delete (encoded_Others);
+Extraction_result Cnf_extractor::extract () {
+    Extraction_result result;
+    vector<Extraction_engine*> engines;
 
-    return 0;
+    init ();
+    clauses.build_occurrences ();
+    run_engines (engines);
+
+    result.klauses = klauses;
+    for (int i = 0; i < clauses.size (); i++)
+        if (clauses.is_deleted (i)) result.replaced_clauses.push_back (i);
+    for (auto engine : engines) {
+        if (engine == NULL) continue;
+        vector<int> & eliminated = engine->stats->eliminated_variables;
+        result.eliminated_variables.insert (result.eliminated_variables.end (), eliminated.begin (), eliminated.end ());
+        delete engine;
+    }
+    sort (result.eliminated_variables.begin (), result.eliminated_variables.end ());
 
+    return result;
 }
 
-}
+int run_extraction_engines (Cnf_extractor * cnf_extractor) {
+    vector<Extraction_engine*> extraction_engines;
+    unordered_map<string, string> extractor_options = cnf_extractor->extractor_options;
+
+    // Output is binary KNF if requested and text KNF otherwise.  With
+    // streaming the untouched clauses are written by a separate thread while
+    // the engines run, which needs an output file that can be rewound.
+    bool binary = (extractor_options["Binary_KNF"] != "");
+    bool write = binary || extractor_options["Write_KNF"] == "true";
+    Knf_writer writer (binary);
+    thread stream_thread;
+    if (write) {
+        string path = binary ? extractor_options["Binary_KNF"] : extractor_options["KNF_file"];
+        if (!writer.open (path)) {
+            cout << "c ERROR could not open " << path << " for writing" << endl;
+            write = false;
+        }
+        else if (extractor_options["Stream_KNF"] == "true") {
+            if (writer.seekable) {
+                cnf_extractor->mark_untouched_clauses ();
+                stream_thread = thread (&Cnf_extractor::stream_clauses, cnf_extractor, &writer);
+            }
+            else cout << "c WARNING streaming needs an uncompressed output file" << endl;
+        }
+    }
 
+    signal (SIGINT, interrupt_extraction);
+    signal (SIGTERM, interrupt_extraction);
 
+    cnf_extractor->run_engines (extraction_engines);
 
-int main (int argc, char ** argv) {
-  cnf2knf::Cnf_extractor * cnf_extractor;
-  cnf_extractor = new cnf2knf::Cnf_extractor();
-  int res;
-  res = cnf_extractor->main (argc, argv);
-  if (res) return 0;
+    signal (SIGINT, SIG_DFL);
+    signal (SIGTERM, SIG_DFL);
 
-  cnf2knf::run_extraction_engines (cnf_extractor);
+    if (stream_thread.joinable ()) stream_thread.join ();
+
+    process_stats(cnf_extractor, extraction_engines);
+
+    if (write) {
+        cout.flush ();
+        cnf_extractor->write_knf_formula (writer);
+        writer.close ();
+    }
+
+    for (auto engine : extraction_engines) delete engine;
+
+    return 0;
+
+}
 
-  return res;
 }
@@ -6,6 +6,9 @@
 #include <vector>
 #include <iostream>
 #include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
 #include <unordered_map>
 #include <map>
 #include <set>
@@ -13,6 +16,8 @@
 #include "assert.h"
 
 #include "klause.hpp"
+#include "clause_store.hpp"
+#include "knf_writer.hpp"
 
 
 namespace cnf2knf {
@@ -30,13 +35,20 @@ struct pair_key_hash //: public unary_function<pair_key, size_t> //
  }
 };
 
-// hash for unordered map on (int,int) key
-struct vec_key_hash //: public unary_function<pair_key, size_t> //
+// finalizer of 'splitmix64', every input bit affects all output bits
+static inline uint64_t mix_hash (uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// hash for unordered map on vector<int> key
+struct vec_key_hash
 {
  size_t operator()(const vector<int>& k) const
  {
-    int hash = 0;
-    for (int i = 0; i < k.size(); i++) hash += i * k[i];
+    uint64_t hash = mix_hash (k.size ());
+    for (auto x : k) hash = mix_hash (hash ^ (uint32_t) x);
     return hash;
  }
 };
@@ -60,6 +72,9 @@ class Stats {
 
         int bdd_analyze_failures;
         int bdd_analyze_successes;
+        int bdd_budget_aborts;    // orderings abandoned at the node or time budget
+        int bdd_later_orderings;  // analyses completed only with a later ordering
+        int pattern_matches;      // constraints recognized without BDDs
 
         int nconstraints;
         unordered_map<int,int> constraint_sizes;
@@ -76,6 +91,9 @@ class Stats {
             cache_misses = 0;
             bdd_analyze_failures = 0;
             bdd_analyze_successes = 0;
+            bdd_budget_aborts = 0;
+            bdd_later_orderings = 0;
+            pattern_matches = 0;
 
             nconstraints = 0;
 
@@ -107,43 +125,106 @@ class Stats {
 
 };
 
+class Extraction_engine;
+
+// Result of 'Cnf_extractor::extract'.  Clauses are identified by their
+// position in the order they were added (starting from 0).
+class Extraction_result {
+
+    public:
+
+        vector<Klause> klauses;              // Extracted cardinality constraints
+        vector<int>    replaced_clauses;     // Clauses replaced by the klauses
+        vector<int>    eliminated_variables; // Encoding variables no longer occurring
+
+};
+
 class Cnf_extractor {
 
     public:
 
         int             nvars;   // Number of variables
-        vector<Klause>  clauses; // Clauses from original CNF formula
+        Clause_store    clauses; // Clauses from original CNF formula
         vector<Klause>  klauses; // All klauses generated during extraction
 
         unordered_map<string, string> extractor_options;
 
         int logging;
 
-        vector<Klause>  analyzed_klauses; // Klauses generated in current analyze step
+        // Global time limit of the extraction (0 for none), shared by the
+        // engines (see 'share_of_time_limit')
+        double time_limit;
+
+        // Set on SIGINT or SIGTERM, such that the engines stop and the
+        // constraints found so far are written
+        static atomic<bool> interrupted;
+
+        // Budgets of 'bdd_analyze' per ordering, and number of orderings
+        int    bdd_node_budget;
+        double bdd_time_budget;
+        int    bdd_orderings;
 
         Stats stats;
 
+        // Klauses of analyzed constraints in canonical form (see 'canonicalize')
         unordered_map<vector<int>, vector<Klause>, vec_key_hash> constraint_cache;
 
         Cnf_extractor () {
+            nvars = 0;
+            time_limit = 0;
             // populate options
             extractor_options["Direct_timeout"] = "1000";
+            extractor_options["Direct_budget"] = "10000";
+            extractor_options["Threads"] = "0";
             extractor_options["Encoded_timeout"] = "1000"; 
+            extractor_options["Timeout"] = "0";
             extractor_options["Extractor_logging"] = "0";
             extractor_options["Engine_logging"] = "0";
             extractor_options["BDD_logging"] = "0";
+            extractor_options["BDD_node_budget"] = "1000000";
+            extractor_options["BDD_time_budget"] = "10";
+            extractor_options["BDD_orderings"] = "1";
             extractor_options["Direct_AMO"] = "true";
             extractor_options["Direct_AMO_Small"] = "true";
+            extractor_options["Direct_Clique_Cover"] = "true";
             extractor_options["Encoded_AMO"] = "true";
-            extractor_options["Encoded_Others"] = "false";
+            extractor_options["Encoded_Others"] = "true";
             extractor_options["Write_KNF"] = "true";
+            extractor_options["Binary_KNF"] = "";
+            extractor_options["KNF_file"] = "";
+            extractor_options["Stream_KNF"] = "false";
             
             }
 
         void init ();
 
+        // Seconds left of the global time limit (or 'timeout' if none)
+        double remaining_time (double timeout) {
+            if (time_limit <= 0) return timeout;
+            return min (timeout, max (0.0, time_limit - stats.get_elapsed_time ()));
+        }
+
+        // Timeout of the next engine, which gets its share of the remaining
+        // time with 'engines' (including itself) still to run, and at most
+        // its own 'timeout'.  Time left over by one engine goes to the next.
+        double share_of_time_limit (double timeout, int engines) {
+            if (time_limit <= 0) return timeout;
+            return remaining_time (timeout) / max (1, engines);
+        }
+
         int main (int argc, char ** argv);
 
+        // In-memory interface (library 'libcnf2knf.a'): set options in
+        // 'extractor_options' (names as on the command line), add the
+        // clauses and call 'extract', which runs the engines without reading
+        // or writing files.  An extractor is meant for one extraction.
+        void add_clause (const vector<int> & clause);
+        Extraction_result extract ();
+
+        // Run the enabled engines in order, with 'engines' set to the
+        // Direct_AMO, Encoded_AMO and ALK engine ('NULL' if disabled)
+        void run_engines (vector<Extraction_engine*> & engines);
+
         // extract directly encoded AMO constraints
         void extract_direct();
 
@@ -151,35 +232,50 @@ class Cnf_extractor {
         // and encoding variables numbered from ndata+1 to nvar
         // Return number of klauses generated (0 if failure)
         // Place new klauses into analyzed_klauses 
-        //   which will be cleared before each call to bdd_analyze
-       int bdd_analyze (int nvar, int ndata, vector<vector<int>> &constraint_clauses);
+       int bdd_analyze (int nvar, int ndata, vector<vector<int>> &constraint_clauses, vector<Klause> &analyzed_klauses);
 
+       // Analyze the clauses and add the resulting klauses, replacing the clauses
        bool validate_constraint (vector<int> &problem_variables, vector<int> &encoding_variables,  vector<int> &clause_ids);
 
+       // The two steps of 'validate_constraint'.  Analysis only reads the
+       // clauses and can run in parallel threads (each with its own BDD
+       // package), while adding the klauses has to be serialized.
+       bool analyze_constraint (const vector<int> &problem_variables, const vector<int> &encoding_variables, const vector<int> &clause_ids, vector<Klause> &analyzed_klauses);
+       bool add_analyzed_klauses (const vector<Klause> &analyzed_klauses, const vector<int> &clause_ids);
+
         // parsing
         int parse_options (int argc, char ** argv);
         bool findOption(char ** start, char ** end, const string & marker);
         bool commandLineParseOption(char ** start, char ** end, const string & marker);
 
         int parse_cnf (char *);
+        int parse_binary_cnf (FILE *);
 
         // writing
-        void write_knf_formula ();
+        vector<bool> streamed; // Clauses already written by stream_clauses
 
-        void add_klause (Klause klause, vector<int> clause_ids) {
+        void write_knf_formula (Knf_writer &writer);
+        void mark_untouched_clauses ();
+        void stream_clauses (Knf_writer *writer);
+
+        void add_klause (const Klause &klause, const vector<int> &clause_ids) {
             klauses.push_back (klause);
             mark_deleted_clauses (clause_ids);
         }
 
         void log_ex_comment (string line, int log_if) {
         if (log_if <= logging) {
+            lock_guard<mutex> guard (log_lock);
             cout << "c " << line << endl; 
         }
     }
 
         private :
 
-        void mark_deleted_clauses (vector<int> clause_ids);
+        mutex log_lock;   // 'analyze_constraint' logs from several threads
+        mutex cache_lock; // and uses 'constraint_cache'
+
+        void mark_deleted_clauses (const vector<int> &clause_ids);
 
 
 };
@@ -200,12 +296,20 @@ class Extraction_engine {
         this->logging = logging;
     }
 
+    virtual ~Extraction_engine () {}
+
     // dictionary containing parameters for initializing this engine
     virtual void init (unordered_map<string, string> engine_options) {};
     
     // start extraction with timeout
     virtual void run (double timeout) {};
 
+    // Checked between candidates, thus the engine can stop at any time with
+    // all constraints found so far.
+    bool out_of_time () {
+        return stats->get_elapsed_time () > timeout || Cnf_extractor::interrupted;
+    }
+
     // write stats to standard out
     virtual void write_stats () {};
 
@@ -218,7 +322,8 @@ class Extraction_engine {
     
 };
 
-
+// Command line extraction after 'Cnf_extractor::main' (statistics and KNF output)
+int run_extraction_engines (Cnf_extractor * cnf_extractor);
 
 
 }
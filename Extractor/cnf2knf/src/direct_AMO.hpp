@@ -2,23 +2,61 @@
 #define DIRECT_AMO_HPP
 
 #include "cnf2knf.hpp"
+#include "thread_pool.hpp"
 
 
 namespace cnf2knf {
 
 using namespace std;
 
+// Binary clauses are the edges of a graph on (negated) literals, stored as
+// an array of edges sorted by their literal pair and sorted adjacency rows in
+// one flat array.  Edges are removed by clearing their 'alive' flag, and
+// removed neighbours are dropped from a row whenever it is expanded.  Since
+// the graph only shrinks, the smallest remaining edge, from which the next
+// clique is expanded, is found by advancing a pointer over the edge array.
+//
+// Two ways to cover the edges with cliques are available.  The greedy one
+// expands a clique from the smallest remaining edge by adding neighbours in
+// increasing order and removes its edges.  On overlapping AMOs this often
+// picks literals of different AMOs and splits them into many small cliques.
+//
+// The clique cover (default) visits the literals in degeneracy order and
+// takes for each edge not covered yet a maximum clique containing it in the
+// whole graph, i.e., cliques may share edges and one clause can be implied by
+// several AMOs.  The clique is found by branch and bound with pivoting
+// (Tomita) on an adjacency matrix of the common neighbours of the edge.  The
+// search is limited to 'clique_budget' nodes per clique, after which the
+// largest clique found so far is taken.  In this mode 'alive' means not
+// covered and rows are never compacted.
+
 class Direct_AMO : public Extraction_engine {
 
     public: 
 
-        // unordered_map<tuple<int, int>, int, pair_key_hash> clause_id_map;
-        // unordered_map<int, set<int>> edge_map;
-
-        // ordered map for determinism with clause order shuffling
-        // logarithmic operations
-        map<tuple<int, int>, int, compare_pair> clause_id_map;
-        map<int, set<int>> edge_map;
+        // edge between 'l1' and 'l2' with abs(l1) < abs(l2)
+        struct Edge {
+            int l1, l2;
+            int cls_idx;
+        };
+
+        struct Neighbour {
+            int lit;
+            int edge;
+        };
+
+        vector<Edge>      edges;      // sorted by (l1,l2)
+        vector<char>      alive;      // edge not removed yet
+        vector<Neighbour> neighbours; // rows sorted by literal
+        vector<int64_t>   neighbour_offsets;
+        vector<int64_t>   neighbour_ends;    // end of row after compaction
+        size_t            next_edge;
+
+        bool    clique_cover;     // maximum cliques instead of greedy expansion
+        int64_t clique_budget;    // search nodes per clique
+        int     budget_exhausted; // searches stopped by the budget
+        int     nthreads;         // threads of the clique cover (0 = all cores)
+        int     ncomponents;      // connected components of the graph
 
         using Extraction_engine::Extraction_engine;
 
@@ -29,78 +67,72 @@ class Direct_AMO : public Extraction_engine {
             if (engine_options.find ("max count") != engine_options.end()) 
                 int max_count = stoi (engine_options["max count"]);
 
+            clique_cover = (engine_options["Clique_cover"] != "false");
+            clique_budget = 10000;
+            if (engine_options["Clique_budget"] != "")
+                clique_budget = stoll (engine_options["Clique_budget"]);
+            budget_exhausted = 0;
+            nthreads = 0;
+            if (engine_options["Threads"] != "")
+                nthreads = stoi (engine_options["Threads"]);
+            ncomponents = 0;
+
         }
 
         void clear_data () {
-          clause_id_map.clear();
-          edge_map.clear();
+          vector<Edge> ().swap (edges);
+          vector<char> ().swap (alive);
+          vector<Neighbour> ().swap (neighbours);
+          vector<int64_t> ().swap (neighbour_offsets);
+          vector<int64_t> ().swap (neighbour_ends);
+          vector<int> ().swap (position);
+          vector<Cover_worker> ().swap (workers);
         }
 
         void run (double timeout) {
-            int l1,l2;
 
             this->stats = new Stats(); // start clock running
             this->timeout = timeout;
 
             generate_maps();
 
-            // logging (maps)
-            log_comment ("cls id map " , 4);
-            for (auto it = clause_id_map.begin() ; it != clause_id_map.end (); it++ ) {
-                string temp_s = to_string(get<0>(it->first)) + " , " + to_string (get<1>(it->first)) + " : " + to_string (it->second);
-                log_comment (temp_s, 4);
-            }
-            log_comment ("edge map " , 4);
-            for (auto it = edge_map.begin() ; it != edge_map.end (); it++ ) {
-                string temp_s = to_string(it->first) + " : ";
-                for (auto it2 = it->second.begin(); it2 != it->second.end(); it2++) {
-                    temp_s += to_string (*it2) + " ";
+            // logging (graph)
+            if (logging >= 4) {
+                log_comment ("cls id map " , 4);
+                for (auto & edge : edges) {
+                    string temp_s = to_string (edge.l1) + " , " + to_string (edge.l2) + " : " + to_string (edge.cls_idx);
+                    log_comment (temp_s, 4);
                 }
-                log_comment (temp_s, 4);
+                log_comment ("edge map " , 4);
+                int max_var = (neighbour_offsets.size () - 2) / 2;
+                for (int lit = -max_var; lit <= max_var; lit++) {
+                    if (!lit || !degree (lit)) continue;
+                    string temp_s = to_string (lit) + " : ";
+                    for (int64_t i = row_begin (lit); i < row_end (lit); i++)
+                        temp_s += to_string (neighbours[i].lit) + " ";
+                    log_comment (temp_s, 4);
+                }
+            }
+
+            if (clique_cover) {
+                cover_cliques ();
+                return;
             }
 
+            while (true) {
 
-            while (clause_id_map.size ()) {
+                // smallest remaining edge
+                while (next_edge < edges.size () && !alive[next_edge]) next_edge++;
+                if (next_edge == edges.size ()) break;
 
-                if (stats->get_elapsed_time() > timeout) {
+                if (out_of_time ()) {
                     stats->set_end_time();
                     reached_timeout = true; 
                     break;
                 }
 
-                auto it = clause_id_map.begin ();
-                l1 = get<0>(it->first);
-                l2 = get<1>(it->first);
-
-                expand_clique (l1);
-
-                sort (clique_set.begin (), clique_set.end (), [](int l1, int l2) { return abs(l1) < abs(l2); });
-
-                if (clique_set.size () < 3) {
-                    // not interesting
-                    l1 = clique_set[0];
-                    l2 = clique_set[1];
-                    remove_edge (l1, l2);
-                    continue;
-                }
-
-                find_clique_clauses ();
-
-                // logging (clique set and ids)
-                string temp_s = "clique set : ";
-                for (auto var : clique_set) temp_s += to_string (var) + " ";
-                log_comment (temp_s, 1);
-                temp_s = "clique ids : ";
-                for (auto idx : clique_clause_ids) temp_s += to_string (idx) + " ";
-                log_comment (temp_s, 1);
-
-                if (clique_set.size () <= 4) {
-                    small_clique_literals.push_back (clique_set);
-                    small_clique_clauses.push_back (clique_clause_ids);
-                }
-                else {
-                    emit_AMO ();
-                }
+                expand_clique (edges[next_edge].l1);
+                take_clique ();
             }
         }
 
@@ -114,7 +146,7 @@ class Direct_AMO : public Extraction_engine {
 
                 present = true;
                 for (auto cls_idx : clique_clause_ids) {
-                    if (cnf_extractor->clauses[cls_idx].deleted) {present = false; break;}
+                    if (cnf_extractor->clauses.is_deleted (cls_idx)) {present = false; break;}
                 }
 
                 if (present) emit_AMO ();
@@ -134,105 +166,539 @@ class Direct_AMO : public Extraction_engine {
     // expanded clique set
     vector<int> clique_set;
     vector<int> clique_clause_ids;
+    vector<int> fresh_clause_ids;
 
     vector<vector<int>> small_clique_literals;
     vector<vector<int>> small_clique_clauses;
 
+    // Dense neighbourhoods (at least this many neighbours) are expanded
+    // with bitsets instead of looking up each pair of literals.
+    static const int64_t dense_degree = 64;
+
+    // position (plus one) of a literal in the row of the literal being
+    // expanded by 'expand_dense', zero otherwise
+    vector<int> position;
+
+    static size_t lit2idx (int lit) { return 2 * (size_t) abs (lit) + (lit < 0); }
+
+    int64_t row_begin (int lit) const { return neighbour_offsets[lit2idx (lit)]; }
+    int64_t row_end (int lit) const { return neighbour_ends[lit2idx (lit)]; }
+    int64_t degree (int lit) const { return row_end (lit) - row_begin (lit); }
+
     void generate_maps () {
         int l1,l2;
+        const Clause_store &clauses = cnf_extractor->clauses;
 
-        for (int cls_idx = 0; cls_idx < cnf_extractor->clauses.size(); cls_idx++) {
+        for (int cls_idx = 0; cls_idx < clauses.size(); cls_idx++) {
             // skip deleted clauses
-            if (cnf_extractor->clauses[cls_idx].deleted) continue;
+            if (clauses.is_deleted (cls_idx)) continue;
 
             // skip non-binary clauses
-            if (cnf_extractor->clauses[cls_idx].get_size () != 2) continue;
+            if (clauses.get_size (cls_idx) != 2) continue;
 
             // abs(l1) < abs(l2)
             // store negation of literal since we are looking for
             //   direct AMOs and literals in constraint are negated
-            if (abs (cnf_extractor->clauses[cls_idx].literals[0]) < abs (cnf_extractor->clauses[cls_idx].literals[1])) {
-                l1 = - cnf_extractor->clauses[cls_idx].literals[0];
-                l2 = - cnf_extractor->clauses[cls_idx].literals[1];
-            } else {
-                l2 = - cnf_extractor->clauses[cls_idx].literals[0];
-                l1 = - cnf_extractor->clauses[cls_idx].literals[1];
-            }
+            Span literals = clauses.literals_of (cls_idx);
+            if (abs (literals[0]) < abs (literals[1])) {
+                l1 = - literals[0];
+                l2 = - literals[1];
+            } else if (abs (literals[0]) > abs (literals[1])) {
+                l2 = - literals[0];
+                l1 = - literals[1];
+            } else continue; // tautology or repeated literal
+
+            edges.push_back (Edge {l1, l2, cls_idx});
+        }
 
-            // insert clause index into index map
-            clause_id_map[tuple<int,int>{l1,l2}] = cls_idx;
+        // sort edges, for duplicate clauses the last one is kept
+        sort (edges.begin (), edges.end (), [](const Edge & e1, const Edge & e2) {
+            if (e1.l1 != e2.l1) return e1.l1 < e2.l1;
+            if (e1.l2 != e2.l2) return e1.l2 < e2.l2;
+            return e1.cls_idx < e2.cls_idx; });
+        size_t kept = 0;
+        for (size_t i = 0; i < edges.size (); i++) {
+            if (i + 1 < edges.size () && edges[i].l1 == edges[i+1].l1 && edges[i].l2 == edges[i+1].l2) continue;
+            edges[kept++] = edges[i];
+        }
+        edges.resize (kept);
+        alive.assign (kept, true);
+        next_edge = 0;
+
+        // adjacency rows, each sorted by neighbour literal
+        int max_var = 0;
+        for (auto & edge : edges) max_var = max (max_var, abs (edge.l2));
+        neighbour_offsets.assign (2 * (size_t) max_var + 3, 0);
+        for (auto & edge : edges) {
+            neighbour_offsets[lit2idx (edge.l1) + 1]++;
+            neighbour_offsets[lit2idx (edge.l2) + 1]++;
+        }
+        for (size_t i = 1; i < neighbour_offsets.size (); i++)
+            neighbour_offsets[i] += neighbour_offsets[i - 1];
+        neighbours.resize (2 * edges.size ());
+        vector<int64_t> next (neighbour_offsets.begin (), neighbour_offsets.end () - 1);
+        for (size_t e = 0; e < edges.size (); e++) {
+            neighbours[next[lit2idx (edges[e].l1)]++] = Neighbour {edges[e].l2, (int) e};
+            neighbours[next[lit2idx (edges[e].l2)]++] = Neighbour {edges[e].l1, (int) e};
+        }
+        for (size_t i = 0; i + 1 < neighbour_offsets.size (); i++)
+            sort (neighbours.begin () + neighbour_offsets[i], neighbours.begin () + neighbour_offsets[i + 1],
+                [](const Neighbour & n1, const Neighbour & n2) { return n1.lit < n2.lit; });
 
-            // insert edge into both literals edge map
-            edge_map[l1].insert (l2);
-            edge_map[l2].insert (l1);
+        neighbour_ends.assign (neighbour_offsets.begin () + 1, neighbour_offsets.end ());
+        position.assign (neighbour_offsets.size (), 0);
+    }
 
-        }
+    // drop removed edges from the row of 'lit'
+    void compact_row (int lit) {
+        int64_t j = row_begin (lit);
+        for (int64_t i = j; i < row_end (lit); i++)
+            if (alive[neighbours[i].edge]) neighbours[j++] = neighbours[i];
+        neighbour_ends[lit2idx (lit)] = j;
+    }
+
+    // index of the remaining edge between 'l1' and 'l2' (or any edge with
+    // 'removed'), -1 if there is none
+    int find_edge (int l1, int l2, bool removed = false) const {
+        auto first = neighbours.begin () + row_begin (l1);
+        auto last = neighbours.begin () + row_end (l1);
+        auto it = lower_bound (first, last, l2, [](const Neighbour & n, int lit) { return n.lit < lit; });
+        if (it == last || it->lit != l2 || (!removed && !alive[it->edge])) return -1;
+        return it->edge;
     }
 
+    // Greedily add the neighbours of 'lit' in increasing order, if they
+    // are adjacent to all literals added before.
     void expand_clique (int lit) {
         clique_set.clear();
-        bool include;
-        set<int> clique_set_local;
-        clique_set_local.insert (lit);
-
-        assert (edge_map.find (lit) != edge_map.end ());
-        for (auto olit : edge_map[lit]) {
-            include = true;
-            for (auto it = clique_set_local.begin() ; it != clique_set_local.end(); it++) {
-                int clit = *it;
-                if (olit != clit && edge_map[olit].find (clit) == edge_map[olit].end()) {
+        clique_set.push_back (lit);
+        compact_row (lit);
+
+        if (degree (lit) >= dense_degree) { expand_dense (lit); return; }
+
+        for (int64_t i = row_begin (lit); i < row_end (lit); i++) {
+            int olit = neighbours[i].lit;
+            bool include = true;
+            for (int j = 1; j < clique_set.size (); j++) {
+                if (find_edge (olit, clique_set[j]) < 0) {
                     include = false;
                     break;
                 }
             }
-            if (include) clique_set_local.insert (olit);
+            if (include) clique_set.push_back (olit);
+        }
+    }
+
+    // Same as 'expand_clique' with the neighbours of 'lit' numbered by their
+    // position in its (compacted) row.  A bitset over these positions holds
+    // the neighbours adjacent to all literals added so far, which is
+    // intersected with the neighbourhood of each added literal.
+    void expand_dense (int lit) {
+        int64_t first = row_begin (lit), n = degree (lit);
+        vector<uint64_t> common ((n + 63) / 64, 0), adjacent ((n + 63) / 64);
+
+        for (int64_t i = 0; i < n; i++) {
+            position[lit2idx (neighbours[first + i].lit)] = i + 1;
+            common[i / 64] |= (uint64_t) 1 << (i % 64);
+        }
+
+        for (int64_t i = 0; i < n; i++) {
+            if (!(common[i / 64] & ((uint64_t) 1 << (i % 64)))) continue;
+            int olit = neighbours[first + i].lit;
+            clique_set.push_back (olit);
+            fill (adjacent.begin (), adjacent.end (), 0);
+            compact_row (olit);
+            for (int64_t j = row_begin (olit); j < row_end (olit); j++) {
+                int64_t p = position[lit2idx (neighbours[j].lit)] - 1;
+                if (p > i) adjacent[p / 64] |= (uint64_t) 1 << (p % 64);
+            }
+            for (size_t w = i / 64; w < common.size (); w++) common[w] &= adjacent[w];
         }
 
-        // using sets in case there are duplicates
-        clique_set.assign( clique_set_local.begin(), clique_set_local.end() );
+        for (int64_t i = 0; i < n; i++) position[lit2idx (neighbours[first + i].lit)] = 0;
     }
 
+    // Remove the edges of 'clique_set' and add it (see 'add_clique').
+    void take_clique () {
+        int l1,l2;
 
-    void remove_edge (int l1, int l2) {
-        assert (abs(l1) < abs(l2));
-        tuple<int,int> edge_pair;
-        edge_pair = tuple<int,int>{l1,l2};
-        int removed;
+        sort (clique_set.begin (), clique_set.end (), [](int l1, int l2) { return abs(l1) < abs(l2); });
 
-        removed = clause_id_map.erase (edge_pair);
-        assert (removed);
+        if (clique_set.size () < 3) {
+            // not interesting
+            l1 = clique_set[0];
+            l2 = clique_set[1];
+            remove_edge (l1, l2);
+            return;
+        }
 
-        removed = edge_map[l1].erase (l2);
-        assert (removed);
+        find_clique_clauses ();
+        add_clique (clique_clause_ids, fresh_clause_ids);
+    }
 
-        removed = edge_map[l2].erase (l1);
-        assert (removed);
+    // Emit 'clique_set' as AMO constraint, where cliques of size 3 and 4 are
+    // deferred to 'find_small_AMOs', which only checks the clauses not
+    // covered by other cliques before ('fresh').
+    void add_clique (const vector<int> & ids, const vector<int> & fresh) {
+        // logging (clique set and ids)
+        string temp_s = "clique set : ";
+        for (auto var : clique_set) temp_s += to_string (var) + " ";
+        log_comment (temp_s, 1);
+        temp_s = "clique ids : ";
+        for (auto idx : ids) temp_s += to_string (idx) + " ";
+        log_comment (temp_s, 1);
+
+        if (clique_set.size () <= 4) {
+            small_clique_literals.push_back (clique_set);
+            small_clique_clauses.push_back (fresh);
+        }
+        else {
+            clique_clause_ids = ids;
+            emit_AMO ();
+        }
+    }
 
+    /*------------------------------------------------------------------------*/
+
+    // Connected components of the graph are covered independently by the
+    // threads of a 'Thread_pool'.  Each worker has its own search state and
+    // collects the cliques it takes.  After all components are done they
+    // are added ordered by the position (in degeneracy order) of the literal
+    // they were taken for, thus the result does not depend on the number of
+    // threads.  Workers only write the 'alive' flags and 'position' entries
+    // of edges and literals in their own components.
+
+    // Larger sets of common neighbours are expanded greedily (the adjacency
+    // matrix needs 'n * n / 8' bytes).
+    static const int64_t max_neighbourhood = 4096;
+
+    // Components with fewer edges are batched into one task.
+    static const int64_t min_task_edges = 4096;
+
+    struct Taken_clique {
+        int64_t key;      // position of the literal in degeneracy order
+        int64_t first_literal;  // in 'literals' of the worker
+        int64_t first_id;       // in 'ids' of the worker
+        int     size;
+        int     nids;     // all clauses, or only fresh ones for small cliques
+    };
+
+    struct Cover_worker {
+        vector<uint64_t> matrix;      // adjacency matrix of the common neighbours
+        int64_t          words;       // words per row of 'matrix'
+        int64_t          nodes;       // search nodes of the current search
+        vector<int>      current;     // positions in the current clique
+        vector<int>      best;        // positions in the largest clique found
+        vector<int>      common;      // common neighbours of the covered edge
+        vector<vector<uint64_t>> candidates; // candidate set per search depth
+
+        vector<int>      clique_set;
+        vector<int>      all_ids, fresh_ids;
+
+        vector<Taken_clique> taken;
+        vector<int>      literals, ids;
+
+        int              budget_exhausted = 0;
+        bool             timeout = false;
+    };
+
+    vector<Cover_worker> workers;
+
+    static int idx2lit (size_t idx) { return (idx & 1) ? - (int) (idx / 2) : (int) (idx / 2); }
+
+    static bool test (const uint64_t * bits, int64_t i) { return (bits[i / 64] >> (i % 64)) & 1; }
+    static void clear (uint64_t * bits, int64_t i) { bits[i / 64] &= ~((uint64_t) 1 << (i % 64)); }
+    static void set (uint64_t * bits, int64_t i) { bits[i / 64] |= (uint64_t) 1 << (i % 64); }
+
+    static int64_t count (const uint64_t * bits, int64_t words) {
+        int64_t res = 0;
+        for (int64_t w = 0; w < words; w++) res += __builtin_popcountll (bits[w]);
+        return res;
     }
 
-    void find_clique_clauses () {
-        clique_clause_ids.clear();
-        int l1,l2, cls_id;
-        
-        for (int i = 0; i < clique_set.size() ; i++) {
-            l1 = clique_set[i];
+    // Literals ordered by repeatedly removing one of smallest degree
+    // (Batagelj and Zaversnik), ties are broken by literal index.
+    vector<int> degeneracy_order () {
+        size_t n = neighbour_offsets.size () - 1;
+        vector<int64_t> deg (n), bin, pos (n);
+        vector<int> vert (n);
+        int64_t max_deg = 0;
+        for (size_t v = 0; v < n; v++) {
+            deg[v] = neighbour_ends[v] - neighbour_offsets[v];
+            max_deg = max (max_deg, deg[v]);
+        }
+        bin.assign (max_deg + 1, 0);
+        for (size_t v = 0; v < n; v++) bin[deg[v]]++;
+        int64_t start = 0;
+        for (int64_t d = 0; d <= max_deg; d++) {
+            int64_t num = bin[d];
+            bin[d] = start;
+            start += num;
+        }
+        for (size_t v = 0; v < n; v++) {
+            pos[v] = bin[deg[v]]++;
+            vert[pos[v]] = v;
+        }
+        for (int64_t d = max_deg; d > 0; d--) bin[d] = bin[d - 1];
+        bin[0] = 0;
+        for (size_t i = 0; i < n; i++) {
+            int v = vert[i];
+            for (int64_t j = neighbour_offsets[v]; j < neighbour_ends[v]; j++) {
+                size_t u = lit2idx (neighbours[j].lit);
+                if (deg[u] <= deg[v]) continue;
+                int64_t du = deg[u], pu = pos[u], pw = bin[du];
+                size_t w = vert[pw];
+                if (u != w) {
+                    pos[u] = pw; vert[pu] = w;
+                    pos[w] = pu; vert[pw] = u;
+                }
+                bin[du]++;
+                deg[u]--;
+            }
+        }
+        vector<int> order;
+        for (size_t i = 0; i < n; i++)
+            if (neighbour_ends[vert[i]] > neighbour_offsets[vert[i]])
+                order.push_back (idx2lit (vert[i]));
+        return order;
+    }
 
-            //logging
-            string temp_s = "find ids with " + to_string(l1) + " , ";
+    void cover_cliques () {
+        vector<int> order = degeneracy_order ();
+
+        // components numbered by their first literal in degeneracy order
+        vector<int> component (neighbour_offsets.size () - 1, -1);
+        vector<int64_t> component_edges;
+        vector<int> stack;
+        for (auto lit : order) {
+            if (component[lit2idx (lit)] >= 0) continue;
+            int c = component_edges.size ();
+            component_edges.push_back (0);
+            component[lit2idx (lit)] = c;
+            stack.push_back (lit);
+            while (!stack.empty ()) {
+                int l = stack.back ();
+                stack.pop_back ();
+                component_edges[c] += degree (l);
+                for (int64_t i = row_begin (l); i < row_end (l); i++) {
+                    int olit = neighbours[i].lit;
+                    if (component[lit2idx (olit)] >= 0) continue;
+                    component[lit2idx (olit)] = c;
+                    stack.push_back (olit);
+                }
+            }
+        }
+        ncomponents = component_edges.size ();
+
+        // positions in degeneracy order of the literals of each component
+        vector<int64_t> members (order.size ()), member_start (ncomponents + 1, 0);
+        for (auto lit : order) member_start[component[lit2idx (lit)] + 1]++;
+        for (int c = 0; c < ncomponents; c++) member_start[c + 1] += member_start[c];
+        vector<int64_t> next (member_start.begin (), member_start.end () - 1);
+        for (size_t i = 0; i < order.size (); i++) members[next[component[lit2idx (order[i])]]++] = i;
+
+        // tasks of components with decreasing number of edges
+        vector<int> sorted (ncomponents);
+        for (int c = 0; c < ncomponents; c++) sorted[c] = c;
+        stable_sort (sorted.begin (), sorted.end (),
+            [&component_edges](int c1, int c2) { return component_edges[c1] > component_edges[c2]; });
+        vector<int> task_start;
+        int64_t task_edges = min_task_edges;
+        for (int i = 0; i < ncomponents; i++) {
+            if (task_edges >= min_task_edges) { task_start.push_back (i); task_edges = 0; }
+            task_edges += component_edges[sorted[i]];
+        }
+        task_start.push_back (ncomponents);
+
+        Thread_pool pool (nthreads);
+        workers = vector<Cover_worker> (pool.size ());
+        pool.run (task_start.size () - 1, [&](size_t task, int w) {
+            Cover_worker & worker = workers[w];
+            for (int i = task_start[task]; i < task_start[task + 1]; i++) {
+                int c = sorted[i];
+                for (int64_t j = member_start[c]; j < member_start[c + 1]; j++) {
+                    if (worker.timeout || out_of_time ()) {
+                        worker.timeout = true;
+                        return;
+                    }
+                    int lit = order[members[j]];
+                    for (int64_t k = row_begin (lit); k < row_end (lit); k++)
+                        if (alive[neighbours[k].edge]) cover_edge (worker, lit, neighbours[k].lit, members[j]);
+                }
+            }
+        });
+
+        // add cliques in degeneracy order of their literals
+        vector<tuple<int64_t,int,int64_t>> taken;
+        for (int w = 0; w < (int) workers.size (); w++) {
+            for (int64_t i = 0; i < (int64_t) workers[w].taken.size (); i++)
+                taken.push_back (tuple<int64_t,int,int64_t>{workers[w].taken[i].key, w, i});
+            budget_exhausted += workers[w].budget_exhausted;
+            if (workers[w].timeout) reached_timeout = true;
+        }
+        sort (taken.begin (), taken.end ());
+        vector<int> ids;
+        for (auto & t : taken) {
+            Cover_worker & worker = workers[get<1>(t)];
+            Taken_clique & clique = worker.taken[get<2>(t)];
+            auto literals = worker.literals.begin () + clique.first_literal;
+            clique_set.assign (literals, literals + clique.size);
+            auto first_id = worker.ids.begin () + clique.first_id;
+            ids.assign (first_id, first_id + clique.nids);
+            add_clique (ids, ids);
+        }
+        if (reached_timeout) stats->set_end_time();
+        vector<Cover_worker> ().swap (workers);
+    }
 
-            for (int j = i+1; j < clique_set.size() ; j++) {
-                l2 = clique_set[j];
+    // Take a maximum clique containing the edge between 'l1' and 'l2'.
+    void cover_edge (Cover_worker & w, int l1, int l2, int64_t key) {
+        // common neighbours
+        w.common.clear ();
+        int64_t i = row_begin (l1), j = row_begin (l2);
+        while (i < row_end (l1) && j < row_end (l2)) {
+            if (neighbours[i].lit < neighbours[j].lit) i++;
+            else if (neighbours[i].lit > neighbours[j].lit) j++;
+            else { w.common.push_back (neighbours[i].lit); i++; j++; }
+        }
 
-                assert (clause_id_map.find (tuple<int,int>{l1,l2}) != clause_id_map.end());
+        w.clique_set.clear ();
+        w.clique_set.push_back (l1);
+        w.clique_set.push_back (l2);
+
+        int64_t n = w.common.size ();
+        if (n > max_neighbourhood) {
+            // greedily in increasing order
+            for (auto olit : w.common) {
+                bool include = true;
+                for (int k = 2; k < w.clique_set.size (); k++) {
+                    if (find_edge (olit, w.clique_set[k], true) < 0) {
+                        include = false;
+                        break;
+                    }
+                }
+                if (include) w.clique_set.push_back (olit);
+            }
+        }
+        else if (n) {
+            int64_t words = w.words = (n + 63) / 64;
+            for (int64_t k = 0; k < n; k++) position[lit2idx (w.common[k])] = k + 1;
+            w.matrix.assign (n * words, 0);
+            for (int64_t k = 0; k < n; k++) {
+                for (int64_t r = row_begin (w.common[k]); r < row_end (w.common[k]); r++) {
+                    int64_t p = position[lit2idx (neighbours[r].lit)] - 1;
+                    if (p >= 0) set (&w.matrix[k * words], p);
+                }
+            }
+            for (int64_t k = 0; k < n; k++) position[lit2idx (w.common[k])] = 0;
+
+            if (w.candidates.empty ()) w.candidates.resize (1);
+            w.candidates[0].assign (words, 0);
+            for (int64_t k = 0; k < n; k++) set (w.candidates[0].data (), k);
+            w.current.clear ();
+            w.best.clear ();
+            w.nodes = 0;
+            search (w, 0);
+            if (w.nodes > clique_budget) w.budget_exhausted++;
+            for (auto k : w.best) w.clique_set.push_back (w.common[k]);
+        }
 
-                cls_id = clause_id_map[tuple<int,int>{l1,l2}];
-                clique_clause_ids.push_back (cls_id);
+        sort (w.clique_set.begin (), w.clique_set.end (), [](int l1, int l2) { return abs(l1) < abs(l2); });
 
-                //logging
-                string temp_j = temp_s +  to_string (l2) + " :  " + to_string (cls_id);
-                log_comment (temp_j, 3);
+        if (w.clique_set.size () < 3) {
+            remove_edge (w.clique_set[0], w.clique_set[1]);
+            return;
+        }
 
-                remove_edge (l1,l2);
+        collect_clique_clauses (w.clique_set, w.all_ids, w.fresh_ids);
+        const vector<int> & ids = (w.clique_set.size () <= 4) ? w.fresh_ids : w.all_ids;
+        w.taken.push_back (Taken_clique {key, (int64_t) w.literals.size (), (int64_t) w.ids.size (),
+                                         (int) w.clique_set.size (), (int) ids.size ()});
+        w.literals.insert (w.literals.end (), w.clique_set.begin (), w.clique_set.end ());
+        w.ids.insert (w.ids.end (), ids.begin (), ids.end ());
+    }
+
+    // Extend 'current' by a maximum clique in the candidates at 'depth'.
+    // After the budget is used up only the first branch is followed, such
+    // that some maximal clique is found.
+    void search (Cover_worker & cw, size_t depth) {
+        int64_t words = cw.words;
+        uint64_t * P = cw.candidates[depth].data ();
+        int64_t size = count (P, words);
+        if (!size) {
+            if (cw.current.size () > cw.best.size ()) cw.best = cw.current;
+            return;
+        }
+        if (cw.current.size () + size <= cw.best.size ()) return;
+        if (cw.nodes++ > clique_budget && !cw.best.empty ()) return;
+
+        // pivot with most neighbours among the candidates
+        int64_t pivot = -1, pivot_count = -1;
+        for (int64_t u = 0; u < words * 64; u++) {
+            if (!test (P, u)) continue;
+            int64_t c = 0;
+            const uint64_t * row = &cw.matrix[u * words];
+            for (int64_t w = 0; w < words; w++) c += __builtin_popcountll (P[w] & row[w]);
+            if (c > pivot_count) { pivot = u; pivot_count = c; }
+        }
+
+        if (cw.candidates.size () <= depth + 1) cw.candidates.resize (depth + 2);
+        vector<uint64_t> branch (P, P + words);
+        const uint64_t * pivot_row = &cw.matrix[pivot * words];
+        for (int64_t w = 0; w < words; w++) branch[w] &= ~pivot_row[w];
+
+        for (int64_t v = 0; v < words * 64; v++) {
+            if (!test (branch.data (), v)) continue;
+            P = cw.candidates[depth].data ();
+            const uint64_t * row = &cw.matrix[v * words];
+            cw.candidates[depth + 1].resize (words);
+            for (int64_t w = 0; w < words; w++) cw.candidates[depth + 1][w] = P[w] & row[w];
+            cw.current.push_back (v);
+            search (cw, depth + 1);
+            cw.current.pop_back ();
+            clear (cw.candidates[depth].data (), v);
+            if (cw.nodes > clique_budget && !cw.best.empty ()) return;
+            if (cw.current.size () + count (cw.candidates[depth].data (), words) <= cw.best.size ()) return;
+        }
+    }
+
+    /*------------------------------------------------------------------------*/
+
+    void remove_edge (int l1, int l2) {
+        assert (abs(l1) < abs(l2));
+        int e = find_edge (l1, l2);
+        assert (e >= 0);
+        alive[e] = false;
+    }
+
+    // Collects the clauses of all edges in 'clique' and the ones of edges
+    // not removed (covered) before in 'fresh', and removes the edges.
+    void collect_clique_clauses (const vector<int> & clique, vector<int> & all, vector<int> & fresh) {
+        all.clear();
+        fresh.clear();
+
+        for (int i = 0; i < clique.size() ; i++) {
+            for (int j = i+1; j < clique.size() ; j++) {
+                int e = find_edge (clique[i], clique[j], true);
+                assert (e >= 0);
+
+                all.push_back (edges[e].cls_idx);
+                if (alive[e]) fresh.push_back (edges[e].cls_idx);
+                alive[e] = false;
+            }
+        }
+    }
+
+    void find_clique_clauses () {
+        collect_clique_clauses (clique_set, clique_clause_ids, fresh_clause_ids);
+
+        //logging
+        int k = 0;
+        for (int i = 0; i < clique_set.size() ; i++) {
+            string temp_s = "find ids with " + to_string(clique_set[i]) + " , ";
+            for (int j = i+1; j < clique_set.size() ; j++) {
+                string temp_j = temp_s +  to_string (clique_set[j]) + " :  " + to_string (clique_clause_ids[k++]);
+                log_comment (temp_j, 3);
             }
         }
     }
@@ -1,7 +1,10 @@
 #ifndef ENCODED_AMO_HPP
 #define ENCODED_AMO_HPP
 
+#include <unordered_set>
+
 #include "cnf2knf.hpp"
+#include "thread_pool.hpp"
 
 
 namespace cnf2knf {
@@ -14,6 +17,7 @@ class Encoded_AMO : public Extraction_engine {
 
         int max_clause_size;
         bool AMO;
+        int nthreads;     // threads validating clusters (0 = all cores)
 
         unordered_map<int, tuple<int, int>> variable_polarity_map;
         unordered_map<int, vector<int>> encoding_variable_map;
@@ -26,6 +30,10 @@ class Encoded_AMO : public Extraction_engine {
             max_clause_size = 2; // default value
             AMO = true;
 
+            nthreads = 0;
+            if (engine_options["Threads"] != "")
+                nthreads = stoi (engine_options["Threads"]);
+
         }
 
         void run (double timeout) {
@@ -63,72 +71,77 @@ class Encoded_AMO : public Extraction_engine {
             }
 
 
-            while (encoding_variable_map.size() ){
+            // All candidate clusters are collected first and validated
+            // best-first, i.e., by decreasing 'score' (ties in the order they
+            // were found), such that a tight timeout is spent on the most
+            // promising ones.  They are validated in batches on the thread
+            // pool (see 'analyze'), each with its own BDD package, and the
+            // klauses are added in the order of the clusters.  A cluster that
+            // lost a clause to an earlier cluster is expanded and validated
+            // again, thus the result is the same as validating one after
+            // another.
+            vector<Cluster> candidates;
+            while (encoding_variable_map.size () && !out_of_time ()) {
+                Cluster cluster;
+                if (next_cluster (cluster)) {
+                    cluster.score = score (cluster);
+                    candidates.push_back (move (cluster));
+                }
+            }
+            vector<size_t> order (candidates.size ());
+            for (size_t i = 0; i < order.size (); i++) order[i] = i;
+            stable_sort (order.begin (), order.end (),
+                [&candidates](size_t i, size_t j) { return candidates[i].score > candidates[j].score; });
+
+            Thread_pool pool (nthreads);
+            size_t batch_size = (pool.size () > 1) ? 16 * pool.size () : 1;
 
-                if (stats->get_elapsed_time() > timeout) {
+            for (size_t first = 0; first < order.size (); first += batch_size) {
+
+                if (out_of_time ()) {
                     stats->set_end_time();
                     reached_timeout = true; 
                     break;
                 }
 
-                get_cluster ();
-
-                //logging (cluster)
-                temp_s = "problem_variable_set : ";
-                for (auto it = problem_variable_set.begin(); it != problem_variable_set.end(); it++) temp_s += to_string (*it) + " ";
-                log_comment (temp_s, 1);
-                temp_s = "encoding_variable_set : ";
-                for (auto it = encoding_variable_set.begin(); it != encoding_variable_set.end(); it++) temp_s += to_string (*it) + " ";
-                log_comment (temp_s, 1);
-                temp_s = "clause_ids_set : ";
-                for (auto it = clause_ids_set.begin(); it != clause_ids_set.end(); it++) temp_s += to_string (*it) + " ";
-                log_comment (temp_s, 1);
-
-                if (!encoding_variable_not_in_cluster || problem_variable_set.size() < 3) continue;
-
-                if (problem_variable_set.size () > 300) continue;
+                size_t last = min (first + batch_size, order.size ());
+                pool.run (last - first, [&](size_t i, int w) { analyze (candidates[order[first + i]]); });
 
-                if (encoding_variable_set.size () > 600) continue;
+                for (size_t i = first; i < last; i++) {
+                    Cluster & cluster = candidates[order[i]];
+                    if (!refresh (cluster)) continue;
 
-                if (AMO && encoding_variable_set.size () > 3 * problem_variable_set.size ()) continue;
-
-                if (!AMO && 2 * encoding_variable_set.size () > problem_variable_set.size () * problem_variable_set.size ()) continue;
-
-                if (problem_variable_set.size () > 10 && 3 * encoding_variable_set.size () < problem_variable_set.size () ) continue;
-
-                expand_cluster ();
-
-                bool normalized = normalize_cluster ();
-
-                if (normalized) {
-                    vector<int> clause_ids;
-                    clause_ids.assign (clause_ids_set.begin(), clause_ids_set.end());
-
-                    //logging (expanded cluster)
-                    temp_s = "clause_ids_set : ";
-                    for (auto it = clause_ids_set.begin(); it != clause_ids_set.end(); it++) temp_s += to_string (*it) + " ";
-                    log_comment (temp_s, 1);
-
-                    bool validated = cnf_extractor->validate_constraint (problem_variables, encoding_variables, clause_ids);
+                    bool validated;
+                    if (cluster.recognized) {
+                        for (auto & klause : cluster.klauses) cnf_extractor->add_klause (klause, cluster.clause_ids);
+                        stats->pattern_matches++;
+                        validated = true;
+                    }
+                    else if (cluster.large) continue;
+                    else validated = cnf_extractor->add_analyzed_klauses (cluster.klauses, cluster.clause_ids);
 
                     if (validated) { 
                         // stats
 
                         // constraints
-                        int csize = problem_variables.size ();
+                        int csize = cluster.problem_variables.size ();
                         stats->nconstraints++;
                         if (stats->constraint_sizes.find (csize) == stats->constraint_sizes.end ())
                             stats->constraint_sizes[csize] = 0;
                         stats->constraint_sizes[csize]++;
 
                         // eliminated variables
-                        for (auto ev : encoding_variables) {
+                        for (auto ev : cluster.encoding_variables) {
                             stats->eliminated_variables.push_back (ev);
                         }
 
                     }   
                 }
             }
+            if (!reached_timeout && out_of_time ()) {
+                stats->set_end_time();
+                reached_timeout = true; 
+            }
             
 
         }
@@ -136,7 +149,219 @@ class Encoded_AMO : public Extraction_engine {
         void write_stats () {}
 
 
-    private:
+    protected:
+
+    // Candidate constraint and the result of its analysis.
+    struct Cluster {
+        vector<int>    problem_variables;
+        vector<int>    encoding_variables;
+        vector<int>    clause_ids;
+        vector<Klause> klauses;
+        int64_t        score = 0;           // see 'score'
+        bool           large = false;       // too large for BDDs
+        bool           recognized = false;  // by 'recognize'
+    };
+
+    // Expected benefit of a cluster: the size of the constraint, the
+    // clauses it replaces and the encoding variables it eliminates.
+    static int64_t score (const Cluster & cluster) {
+        return (int64_t) cluster.problem_variables.size () + cluster.clause_ids.size ()
+             + cluster.encoding_variables.size ();
+    }
+
+    // If a clause of the cluster was deleted by an earlier cluster, expand
+    // it again from its variables and the remaining clauses (the clauses
+    // with encoding variables belong to this cluster only) and analyze it
+    // again.  Return false if it is no candidate anymore.
+    bool refresh (Cluster & cluster) {
+        const Clause_store & clauses = cnf_extractor->clauses;
+        bool stale = false;
+        for (auto cls_idx : cluster.clause_ids)
+            if (clauses.is_deleted (cls_idx)) stale = true;
+        if (!stale) return true;
+        problem_variable_set.clear ();
+        problem_variable_set.insert (cluster.problem_variables.begin (), cluster.problem_variables.end ());
+        encoding_variable_set.clear ();
+        encoding_variable_set.insert (cluster.encoding_variables.begin (), cluster.encoding_variables.end ());
+        clause_ids_set.clear ();
+        for (auto cls_idx : cluster.clause_ids)
+            if (!clauses.is_deleted (cls_idx)) clause_ids_set.insert (cls_idx);
+        if (!expand_and_normalize (cluster)) return false;
+        analyze (cluster);
+        return true;
+    }
+
+    // Recognition without BDDs (see 'ALK' for other bounds).
+    virtual bool recognize (Cluster & cluster) const { return recognize_AMO (cluster); }
+
+    // Only reads the clauses, thus clusters can be analyzed in parallel.
+    virtual void analyze (Cluster & cluster) {
+        cluster.klauses.clear ();
+        cluster.recognized = recognize (cluster);
+        if (!cluster.recognized && !cluster.large)
+            cnf_extractor->analyze_constraint (cluster.problem_variables, cluster.encoding_variables, cluster.clause_ids, cluster.klauses);
+    }
+
+    // Larger clusters need too much memory for the reachability bitsets.
+    static const int64_t max_reach_words = 1 << 25;
+
+    // Clusters of binary clauses are recognized without BDDs, which covers
+    // the sequential counter, product, commander, bimander and binary
+    // encodings of AMO constraints.  Projecting a satisfiable 2-CNF onto the
+    // problem variables gives the binary (and unit) clauses over them which
+    // follow from paths in the implication graph.  If every problem variable
+    // occurs with one sign only, say as '-l', such clauses are '-l_i | -l_j'
+    // for paths from 'l_i' to '-l_j'.  Thus the clauses encode exactly the
+    // AMO constraint over the literals 'l' if they are satisfiable, each 'l_i'
+    // reaches all '-l_j' and no 'l_i' reaches '-l_i'.  Reachable literals are
+    // collected as bitsets over the strongly connected components.
+    bool recognize_AMO (Cluster & cluster) const {
+        const Clause_store &clauses = cnf_extractor->clauses;
+        int n = cluster.problem_variables.size ();
+        int nvars = n + cluster.encoding_variables.size ();
+
+        unordered_map<int,int> index;
+        for (int i = 0; i < n; i++) index[cluster.problem_variables[i]] = i;
+        for (int i = n; i < nvars; i++) index[cluster.encoding_variables[i - n]] = i;
+        auto node = [&index](int lit) { return 2 * index[abs(lit)] + (lit < 0); };
+
+        // implication graph with 'sign' of the problem variables
+        vector<int> sign (n, 0);
+        vector<vector<int>> out (2 * nvars), in (2 * nvars);
+        for (auto cls_idx : cluster.clause_ids) {
+            Span literals = clauses.literals_of (cls_idx);
+            if (literals.size () != 2 || abs(literals[0]) == abs(literals[1])) return false;
+            for (auto lit : literals) {
+                int i = index[abs(lit)];
+                if (i >= n) continue;
+                int s = (lit < 0) ? -1 : 1;
+                if (sign[i] && sign[i] != s) return false;
+                sign[i] = s;
+            }
+            int a = node (literals[0]), b = node (literals[1]);
+            out[a ^ 1].push_back (b); in[b].push_back (a ^ 1);
+            out[b ^ 1].push_back (a); in[a].push_back (b ^ 1);
+        }
+        for (int i = 0; i < n; i++) if (!sign[i]) return false;
+
+        // strongly connected components (Kosaraju), numbered in topological order
+        int nnodes = 2 * nvars;
+        vector<int> finished, component (nnodes, -1);
+        vector<char> visited (nnodes, 0);
+        vector<pair<int,size_t>> stack;
+        for (int root = 0; root < nnodes; root++) {
+            if (visited[root]) continue;
+            visited[root] = 1;
+            stack.push_back ({root, 0});
+            while (!stack.empty ()) {
+                int u = stack.back ().first;
+                size_t & next = stack.back ().second;
+                if (next < out[u].size ()) {
+                    int v = out[u][next++];
+                    if (!visited[v]) { visited[v] = 1; stack.push_back ({v, 0}); }
+                }
+                else { finished.push_back (u); stack.pop_back (); }
+            }
+        }
+        int ncomponents = 0;
+        vector<int> todo;
+        for (int k = nnodes - 1; k >= 0; k--) {
+            int root = finished[k];
+            if (component[root] >= 0) continue;
+            component[root] = ncomponents;
+            todo.push_back (root);
+            while (!todo.empty ()) {
+                int u = todo.back ();
+                todo.pop_back ();
+                for (auto v : in[u])
+                    if (component[v] < 0) { component[v] = ncomponents; todo.push_back (v); }
+            }
+            ncomponents++;
+        }
+        for (int i = 0; i < nvars; i++)
+            if (component[2 * i] == component[2 * i + 1]) return false; // unsatisfiable
+
+        // '-l_j' reachable from each component, in reverse topological order
+        int64_t words = (n + 63) / 64;
+        if (ncomponents * words > max_reach_words) return false;
+        vector<uint64_t> reach (ncomponents * words, 0);
+        vector<vector<int>> members (ncomponents);
+        for (int u = 0; u < nnodes; u++) members[component[u]].push_back (u);
+        for (int c = ncomponents - 1; c >= 0; c--) {
+            uint64_t * bits = &reach[c * words];
+            for (auto u : members[c]) {
+                if (u < 2 * n && (u & 1) == (sign[u / 2] < 0)) bits[u / 128] |= (uint64_t) 1 << ((u / 2) % 64);
+                for (auto v : out[u]) {
+                    if (component[v] == c) continue;
+                    const uint64_t * other = &reach[component[v] * words];
+                    for (int64_t w = 0; w < words; w++) bits[w] |= other[w];
+                }
+            }
+        }
+        for (int i = 0; i < n; i++) {
+            // node of 'l_i', the negation of 'sign[i] * x_i' in the clauses
+            int l = 2 * i + (sign[i] > 0);
+            const uint64_t * bits = &reach[component[l] * words];
+            if ((bits[i / 64] >> (i % 64)) & 1) return false;
+            int64_t count = 0;
+            for (int64_t w = 0; w < words; w++) count += __builtin_popcountll (bits[w]);
+            if (count != n - 1) return false;
+        }
+
+        // AMO over the 'l_i', i.e., at least 'n-1' of the literals in the clauses
+        vector<int> literals;
+        for (int i = 0; i < n; i++) literals.push_back (sign[i] * cluster.problem_variables[i]);
+        cluster.klauses.push_back (Klause (literals, n - 1));
+        return true;
+    }
+
+    // Find the next cluster, return false if it is not a candidate.
+    bool next_cluster (Cluster & cluster) {
+        string temp_s;
+
+        get_cluster ();
+        if (out_of_time ()) return false;
+
+        //logging (cluster)
+        temp_s = "problem_variable_set : ";
+        for (auto it = problem_variable_set.begin(); it != problem_variable_set.end(); it++) temp_s += to_string (*it) + " ";
+        log_comment (temp_s, 1);
+        temp_s = "encoding_variable_set : ";
+        for (auto it = encoding_variable_set.begin(); it != encoding_variable_set.end(); it++) temp_s += to_string (*it) + " ";
+        log_comment (temp_s, 1);
+        temp_s = "clause_ids_set : ";
+        for (auto it = clause_ids_set.begin(); it != clause_ids_set.end(); it++) temp_s += to_string (*it) + " ";
+        log_comment (temp_s, 1);
+
+        if (!encoding_variable_not_in_cluster || problem_variable_set.size() < 3) return false;
+
+        if (AMO && encoding_variable_set.size () > 3 * problem_variable_set.size ()) return false;
+
+        if (problem_variable_set.size () > 10 && 3 * encoding_variable_set.size () < problem_variable_set.size () ) return false;
+
+        cluster.large = (problem_variable_set.size () > 300 || encoding_variable_set.size () > 600);
+        if (!AMO && 2 * encoding_variable_set.size () > problem_variable_set.size () * problem_variable_set.size ()) cluster.large = true;
+
+        return expand_and_normalize (cluster);
+    }
+
+    bool expand_and_normalize (Cluster & cluster) {
+        expand_cluster ();
+
+        bool normalized = normalize_cluster ();
+        if (!normalized) return false;
+
+        cluster.problem_variables = problem_variables;
+        cluster.encoding_variables = encoding_variables;
+        cluster.clause_ids.assign (clause_ids_set.begin(), clause_ids_set.end());
+
+        //logging (expanded cluster)
+        string temp_s = "clause_ids_set : ";
+        for (auto it = clause_ids_set.begin(); it != clause_ids_set.end(); it++) temp_s += to_string (*it) + " ";
+        log_comment (temp_s, 1);
+
+        return true;
+    }
 
     bool encoding_variable_not_in_cluster;
     set<int> problem_variable_set;
@@ -150,14 +375,16 @@ class Encoded_AMO : public Extraction_engine {
         int var;
         bool pos,neg;
 
-        for (int cls_idx = 0; cls_idx < cnf_extractor->clauses.size(); cls_idx++) {
+        const Clause_store &clauses = cnf_extractor->clauses;
+
+        for (int cls_idx = 0; cls_idx < clauses.size(); cls_idx++) {
             // skip deleted clauses
-            if (cnf_extractor->clauses[cls_idx].deleted) continue;
+            if (clauses.is_deleted (cls_idx)) continue;
 
             // skip clauses smaller than max_clause_size
-            if (cnf_extractor->clauses[cls_idx].get_size () > max_clause_size) continue;
+            if (clauses.get_size (cls_idx) > max_clause_size) continue;
 
-            for (auto lit : cnf_extractor->clauses[cls_idx].literals) {
+            for (auto lit : clauses.literals_of (cls_idx)) {
                 var = abs(lit);
                 auto map_element = variable_polarity_map.find (var);
                 pos = neg = false;
@@ -174,32 +401,24 @@ class Encoded_AMO : public Extraction_engine {
         }
     }
 
+    // clauses of each classified variable from the shared occurrence lists
     void generate_maps () {
         int var;
-        bool pos, neg, assigned;
+        bool pos, neg;
+        const Clause_store &clauses = cnf_extractor->clauses;
 
         for (auto it : variable_polarity_map) {
             var = it.first;
             pos = get<0>(it.second);
             neg = get<1>(it.second);
 
-            if (pos && neg) encoding_variable_map[var] = vector<int>();
-            else problem_variable_map[var] = vector<int>();
-        }
-
-
-        for (int cls_idx = 0; cls_idx < cnf_extractor->clauses.size(); cls_idx++) {
-            // skip deleted clauses
-            if (cnf_extractor->clauses[cls_idx].deleted) continue;
-
-            assigned = false;
-            for (auto lit : cnf_extractor->clauses[cls_idx].literals) {
-                var = abs (lit);
-
-                if (encoding_variable_map.find (var) != encoding_variable_map.end()) encoding_variable_map[var].push_back (cls_idx);
-                else if (problem_variable_map.find (var) != problem_variable_map.end()) problem_variable_map[var].push_back (cls_idx);
-
-            }
+            vector<int> &cls_idxs = (pos && neg) ? encoding_variable_map[var] : problem_variable_map[var];
+            Span positive = clauses.occurrences_of (var);
+            Span negative = clauses.occurrences_of (-var);
+            cls_idxs.resize (positive.size () + negative.size ());
+            merge (positive.begin (), positive.end (), negative.begin (), negative.end (), cls_idxs.begin ());
+            cls_idxs.erase (remove_if (cls_idxs.begin (), cls_idxs.end (),
+                [&clauses](int cls_idx) { return clauses.is_deleted (cls_idx); }), cls_idxs.end ());
         }
     }
 
@@ -221,6 +440,8 @@ class Encoded_AMO : public Extraction_engine {
         encoding_variable_set.insert (encoding_variable);
 
         while (trace_variable_set.size ()) {
+            // a cluster can have millions of clauses
+            if (out_of_time ()) break;
             encoding_variable = *(trace_variable_set.begin());
             trace_variable_set.erase (encoding_variable);
 
@@ -229,7 +450,7 @@ class Encoded_AMO : public Extraction_engine {
             for (auto cls_idx : encoding_variable_map[encoding_variable]) {
                 clause_ids_set.insert (cls_idx);
                 
-                for (auto lit : cnf_extractor->clauses[cls_idx].literals) {
+                for (auto lit : cnf_extractor->clauses.literals_of (cls_idx)) {
                     var = abs (lit);
 
                     if (var == encoding_variable || problem_variable_set.find (var) != problem_variable_set.end () || encoding_variable_set.find (var) != encoding_variable_set.end ()) continue;
@@ -256,7 +477,7 @@ class Encoded_AMO : public Extraction_engine {
             tainted_variable_set.erase (encoding_variable);
 
             for (auto cls_idx : encoding_variable_map[encoding_variable]) {
-                for (auto lit : cnf_extractor->clauses[cls_idx].literals) {
+                for (auto lit : cnf_extractor->clauses.literals_of (cls_idx)) {
                     var = abs (lit);
                     if (var == encoding_variable) continue;
                     if (encoding_variable_set.find (var) != encoding_variable_set.end ()) tainted_variable_set.insert (var);
@@ -275,15 +496,13 @@ class Encoded_AMO : public Extraction_engine {
             problem_variable = *it;
 
             for (auto cls_idx : problem_variable_map[problem_variable]) {
-                if (cnf_extractor->clauses[cls_idx].deleted) continue;
-
-                Klause clause = cnf_extractor->clauses[cls_idx];
+                if (cnf_extractor->clauses.is_deleted (cls_idx)) continue;
 
-                if (clause.get_size () > 2) continue;
+                if (cnf_extractor->clauses.get_size (cls_idx) > max_clause_size) continue;
 
                 in_cluster = true;
 
-                for (auto lit : clause.literals) {
+                for (auto lit : cnf_extractor->clauses.literals_of (cls_idx)) {
                     var = abs(lit);
                     if (problem_variable_set.find (var) == problem_variable_set.end () && encoding_variable_set.find (var) == encoding_variable_set.end ()) {in_cluster = false; break;}
                 }
@@ -303,22 +522,16 @@ class Encoded_AMO : public Extraction_engine {
         clause_ids.assign (clause_ids_set.begin () , clause_ids_set.end ());
         sort (clause_ids.begin(), clause_ids.end());
 
+        // variables in order of first occurrence
+        unordered_set<int> placed;
         for (auto cls_idx : clause_ids) {
-            Klause clause = cnf_extractor->clauses[cls_idx];
-            for (auto lit : clause.literals) {
+            for (auto lit : cnf_extractor->clauses.literals_of (cls_idx)) {
                 var = abs(lit);
-                if (problem_variable_set.find (var) != problem_variable_set.end ()) {
-                    problem_variables.push_back (var);
-                    problem_variable_set.erase (var);
-                }
-                else if (encoding_variable_set.find (var) != encoding_variable_set.end ()) {
-                    encoding_variables.push_back (var);
-                    encoding_variable_set.erase (var);
-                } 
-                else {
-                    if ((find (problem_variables.begin(),problem_variables.end(), var) == problem_variables.end()  && find (encoding_variables.begin(),encoding_variables.end(), var) == encoding_variables.end()))
-                        return false;
-                }
+                if (placed.count (var)) continue;
+                if (problem_variable_set.erase (var)) problem_variables.push_back (var);
+                else if (encoding_variable_set.erase (var)) encoding_variables.push_back (var);
+                else return false;
+                placed.insert (var);
             }
         }
         assert (!problem_variable_set.size());
@@ -0,0 +1,173 @@
+#ifndef KNF_WRITER_HPP
+#define KNF_WRITER_HPP
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "zfile.h"
+#include "bknf.h"
+
+
+namespace cnf2knf {
+
+using namespace std;
+
+// Buffered writer for text KNF and binary KNF (see 'Binary KNF format' in
+// the top-level README).  Output goes to standard output (empty path or
+// '-') or a file, which is compressed in-process if the path ends in
+// '.gz', '.bz2' or '.xz' (see 'Tools/zfile.h').  Numbers are formatted
+// directly into the buffer.
+//
+// The header can be written with reserved space ('pad') and rewritten by
+// 'patch_header' after the formula is complete, which is needed if clauses
+// are written before the number of constraints is known.  This requires
+// that the output is 'seekable', i.e., an uncompressed file.
+
+class Knf_writer {
+
+    public:
+
+        bool binary;    // Write binary KNF instead of text KNF
+        bool seekable;  // Output is a regular file (header can be patched)
+
+        Knf_writer (bool binary) {
+            this->binary = binary;
+            seekable = false;
+            file = NULL;
+            padded = false;
+            size = 0;
+            buffer = (char *) malloc (capacity);
+        }
+
+        ~Knf_writer () {
+            close ();
+            free (buffer);
+        }
+
+        // return false if the output can not be opened
+        bool open (const string & path) {
+            if (path == "" || path == "-") file = stdout;
+            else {
+                file = zfopen (path.c_str (), binary ? "wb" : "w");
+                seekable = (file != NULL) && !zfile_type (path.c_str ());
+            }
+            return (file != NULL);
+        }
+
+        void close () {
+            if (!file) return;
+            flush ();
+            if (file != stdout) fclose (file);
+            else fflush (file);
+            file = NULL;
+        }
+
+        // Header with number of variables, clauses and cardinality
+        // constraints.  With 'pad' each number gets enough room for any
+        // later value in 'patch_header'.
+        void header (int nvars, int64_t nclauses, int64_t nklauses, bool pad) {
+            padded = pad;
+            if (binary) {
+                put ("BKNF"); put ((char) BKNF_VERSION);
+                put_varint (nvars, pad);
+                put_varint (nclauses, pad);
+                put_varint (nklauses, pad);
+                put_varint (0, pad); // no guarded constraints
+            }
+            else {
+                size_t start = size;
+                put ("p knf "); put_int (nvars);
+                put (' '); put_int (nclauses + nklauses);
+                if (pad) while (size - start < text_header_width) put (' ');
+                put ('\n');
+            }
+        }
+
+        // Rewrite the padded header at the start of the output.
+        bool patch_header (int nvars, int64_t nclauses, int64_t nklauses) {
+            if (!seekable || !padded) return false;
+            flush ();
+            if (fseek (file, 0, SEEK_SET)) return false;
+            header (nvars, nclauses, nklauses, true);
+            flush ();
+            return !fseek (file, 0, SEEK_END);
+        }
+
+        template <class Literals> void clause (const Literals & literals) {
+            if (binary) {
+                put ((char) BKNF_CLAUSE);
+                put_literals (literals);
+            }
+            else {
+                for (auto lit : literals) { put_int (lit); put (' '); }
+                put ("0\n");
+            }
+        }
+
+        template <class Literals> void klause (int cardinality_bound, const Literals & literals) {
+            if (binary) {
+                put ((char) BKNF_CARDINALITY);
+                put_varint (cardinality_bound, false);
+                put_literals (literals);
+            }
+            else {
+                put ("k "); put_int (cardinality_bound); put (' ');
+                for (auto lit : literals) { put_int (lit); put (' '); }
+                put ("0\n");
+            }
+        }
+
+        void flush () {
+            if (size) fwrite (buffer, 1, size, file);
+            size = 0;
+        }
+
+    private:
+
+        static const size_t capacity = 1 << 20;
+        static const size_t text_header_width = 32;
+
+        FILE * file;
+        bool   padded;
+        char * buffer;
+        size_t size;
+
+        void put (char ch) {
+            if (size == capacity) flush ();
+            buffer[size++] = ch;
+        }
+
+        void put (const char * s) { while (*s) put (*s++); }
+
+        void put_int (int64_t x) {
+            char digits[24];
+            int n = 0;
+            uint64_t u = (x < 0) ? - (uint64_t) x : (uint64_t) x;
+            do { digits[n++] = '0' + u % 10; u /= 10; } while (u);
+            if (x < 0) put ('-');
+            while (n) put (digits[--n]);
+        }
+
+        // Padded varints use redundant continuation bytes up to 35 bits.
+        void put_varint (uint64_t x, bool pad) {
+            unsigned char bytes[BKNF_MAX_VARINT];
+            unsigned n = bknf_put_varint (bytes, x, pad ? 5 : 0);
+            for (unsigned i = 0; i < n; i++) put ((char) bytes[i]);
+        }
+
+        // literals as zig-zag encoded deltas
+        template <class Literals> void put_literals (const Literals & literals) {
+            uint64_t prev = 0;
+            put_varint (literals.size (), false);
+            for (auto lit : literals) put_varint (bknf_delta (&prev, lit), false);
+        }
+
+};
+
+}
+
+
+#endif
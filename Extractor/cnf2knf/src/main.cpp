@@ -0,0 +1,14 @@
+#include "cnf2knf.hpp"
+
+
+int main (int argc, char ** argv) {
+  cnf2knf::Cnf_extractor * cnf_extractor;
+  cnf_extractor = new cnf2knf::Cnf_extractor();
+  int res;
+  res = cnf_extractor->main (argc, argv);
+  if (res) return 0;
+
+  cnf2knf::run_extraction_engines (cnf_extractor);
+
+  return res;
+}
@@ -46,27 +46,42 @@ bool Cnf_extractor::findOption(char ** start, char ** end, const string & marker
 int Cnf_extractor::parse_options (int argc, char ** argv) {
 
     commandLineParseOption(argv, argv+argc, "Direct_timeout");
+    commandLineParseOption(argv, argv+argc, "Direct_budget");
+    commandLineParseOption(argv, argv+argc, "Threads");
     commandLineParseOption(argv, argv+argc, "Encoded_timeout");
+    commandLineParseOption(argv, argv+argc, "Timeout");
     commandLineParseOption(argv, argv+argc, "Extractor_logging");
     commandLineParseOption(argv, argv+argc, "Engine_logging");
     commandLineParseOption(argv, argv+argc, "BDD_logging");
+    commandLineParseOption(argv, argv+argc, "BDD_node_budget");
+    commandLineParseOption(argv, argv+argc, "BDD_time_budget");
+    commandLineParseOption(argv, argv+argc, "BDD_orderings");
+    commandLineParseOption(argv, argv+argc, "Binary_KNF");
+    commandLineParseOption(argv, argv+argc, "KNF_file");
 
     findOption (argv, argv+argc, "Direct_AMO");
     findOption (argv, argv+argc, "Direct_AMO_Small");
+    findOption (argv, argv+argc, "Direct_Clique_Cover");
     findOption (argv, argv+argc, "Encoded_AMO");
     findOption (argv, argv+argc, "Encoded_Others");
     findOption (argv, argv+argc, "Write_KNF");
+    findOption (argv, argv+argc, "Stream_KNF");
 
     return 0;
 }
 
 
 int Cnf_extractor::parse_cnf (char * input_file) {
-    FILE* file = fopen(input_file, "r");
+    FILE* file = zfopen(input_file, "r");
     string input_file_s(input_file);
     if (!file) throw "File " + input_file_s + " cannot be opened.";
     
     int c = getc_unlocked(file);
+    if (c == 'B') { // binary KNF signature
+        int res = parse_binary_cnf (file);
+        fclose(file);
+        return res;
+    }
     SkipWhitespace(file, c);
     int statement_type = 0;
     std::vector<int> literals;
@@ -126,7 +141,7 @@ int Cnf_extractor::parse_cnf (char * input_file) {
       Parseliterals (file, c, literals);
       if(statement_type == 'a') {
         // literals addition
-        clauses.push_back (Klause (literals,1));
+        clauses.add (literals);
       } 
       SkipWhitespace(file, c);
     }
@@ -134,6 +149,64 @@ int Cnf_extractor::parse_cnf (char * input_file) {
     return 0; // completed parsing without error
   }
 
+// Binary KNF, see 'Binary KNF format' in the top-level README.
+// The signature byte 'B' was already read.  Only clauses are accepted.
+
+bool ParseVarint(FILE *file, uint64_t &res) {
+  int ch, more;
+  unsigned shift = 0;
+  res = 0;
+  do {
+    if ((ch = getc_unlocked(file)) == EOF) return false;
+    if ((more = bknf_get_varint(&res, &shift, ch)) < 0) return false;
+  } while (more);
+  return true;
+}
+
+int Cnf_extractor::parse_binary_cnf (FILE *file) {
+    uint64_t header[4], size, zigzag, prev;
+    if (getc_unlocked(file) != 'K' || getc_unlocked(file) != 'N' ||
+        getc_unlocked(file) != 'F' || getc_unlocked(file) != BKNF_VERSION) {
+        cout << "c ERROR unsupported binary KNF signature or version" << endl;
+        return -1;
+    }
+    for (int i = 0; i < 4; i++)
+        if (!ParseVarint(file, header[i])) return -1;
+    if (header[2] || header[3]) {
+        cout << "c ERROR binary input contains cardinality constraints" << endl;
+        return -1;
+    }
+    nvars = header[0];
+    clauses.reserve (header[1]);
+
+    cout << "c Found binary header with " << nvars << " variables and " << header[1] << " clauses" << endl;
+
+    std::vector<int> literals;
+    int type;
+    while ((type = getc_unlocked(file)) != EOF) {
+        if (type == BKNF_COMMENT) {
+            if (!ParseVarint(file, size)) return -1;
+            while (size--) getc_unlocked(file);
+            continue;
+        }
+        if (type & ~BKNF_ENCODING) return -1; // not a clause
+        if (!ParseVarint(file, size)) return -1;
+        literals.clear();
+        prev = 0;
+        while (size--) {
+            if (!ParseVarint(file, zigzag)) return -1;
+            int lit = bknf_undelta(&prev, zigzag);
+            if (!lit) {
+                cout << "c ERROR invalid literal in binary KNF" << endl;
+                return -1;
+            }
+            literals.push_back (lit);
+        }
+        clauses.add (literals);
+    }
+    return 0;
+}
+
 bool ParseString(
   FILE *file, int &current_symbol, string s) {
     string temp_s;
@@ -0,0 +1,89 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace cnf2knf {
+
+using namespace std;
+
+// Runs independent tasks (numbered '0' up to 'ntasks-1') on a fixed number
+// of threads.  Every worker owns a deque of tasks, which is filled round
+// robin, such that tasks should be numbered by decreasing cost.  A worker
+// takes tasks from the front of its own deque and when it runs out steals
+// from the back of the others.  With one thread the tasks are executed in
+// order on the calling thread.
+//
+// The task function gets the task and the worker (to select thread local
+// state), and results have to be merged by the caller after 'run' returns.
+
+class Thread_pool {
+
+    public:
+
+        Thread_pool (int nthreads) {
+            if (nthreads <= 0) nthreads = thread::hardware_concurrency ();
+            this->nthreads = nthreads > 0 ? nthreads : 1;
+        }
+
+        int size () const { return nthreads; }
+
+        void run (size_t ntasks, const function<void (size_t, int)> & task) {
+            if (nthreads == 1 || ntasks <= 1) {
+                for (size_t i = 0; i < ntasks; i++) task (i, 0);
+                return;
+            }
+            queues = vector<Queue> (nthreads);
+            for (size_t i = 0; i < ntasks; i++) queues[i % nthreads].tasks.push_back (i);
+            vector<thread> workers;
+            for (int w = 0; w < nthreads; w++)
+                workers.push_back (thread (&Thread_pool::work, this, w, cref (task)));
+            for (auto & worker : workers) worker.join ();
+        }
+
+    private:
+
+        struct Queue {
+            mutex         lock;
+            deque<size_t> tasks;
+        };
+
+        int           nthreads;
+        vector<Queue> queues;
+
+        bool pop (int w, size_t & task) {
+            lock_guard<mutex> guard (queues[w].lock);
+            if (queues[w].tasks.empty ()) return false;
+            task = queues[w].tasks.front ();
+            queues[w].tasks.pop_front ();
+            return true;
+        }
+
+        bool steal (int w, size_t & task) {
+            for (int i = 1; i < nthreads; i++) {
+                Queue & victim = queues[(w + i) % nthreads];
+                lock_guard<mutex> guard (victim.lock);
+                if (victim.tasks.empty ()) continue;
+                task = victim.tasks.back ();
+                victim.tasks.pop_back ();
+                return true;
+            }
+            return false;
+        }
+
+        void work (int w, const function<void (size_t, int)> & task) {
+            size_t next;
+            while (pop (w, next) || steal (w, next)) task (next, w);
+        }
+
+};
+
+}
+
+
+#endif
@@ -85,6 +85,12 @@
 #include <stdio.h>
 #include <stdbool.h>
 
+/* The state of the package (node table, caches, proof generation) is kept
+   per thread.  Every thread that uses BDDs has to call bdd_init (or one of
+   the tbdd_init functions) and bdd_done on its own, and BDDs can not be
+   passed between threads. */
+#define BDD_THREAD_LOCAL __thread
+
 /*=== Defined operators for apply calls, and for op field in cache ====*/
 
 /* Covered by apply operations */
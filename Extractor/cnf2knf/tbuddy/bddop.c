@@ -118,38 +118,38 @@ static int oprres[OPERATOR_NUM][4] =
 
 
    /* Variables needed for the operators */
-static int applyop;                 /* Current operator for apply */
-static int appexop;                 /* Current operator for appex */
-static int appexid;                 /* Current cache id for appex */
-static int quantid;                 /* Current cache id for quantifications */
-static int *quantvarset;            /* Current variable set for quant. */
-static int quantvarsetID;           /* Current id used in quantvarset */
-static int quantlast;               /* Current last variable to be quant. */
-static int replaceid;               /* Current cache id for replace */
-static int *replacepair;            /* Current replace pair */
-static int replacelast;             /* Current last var. level to replace */
-static int composelevel;            /* Current variable used for compose */
-static int miscid;                  /* Current cache id for other results */
-static int *varprofile;             /* Current variable profile */
-static int supportID;               /* Current ID (true value) for support */
-static int supportMin;              /* Min. used level in support calc. */
-static int supportMax;              /* Max. used level in support calc. */
-static int* supportSet;             /* The found support set */
-static int supportSize;             /* Number of int's allocated for supportSet */
-static BddCache opcache;            /* Cache for all operations */
-static int cacheratio;
-static BDD satPolarity;
-static int firstReorder;            /* Used instead of local variable in order
+static BDD_THREAD_LOCAL int applyop;                 /* Current operator for apply */
+static BDD_THREAD_LOCAL int appexop;                 /* Current operator for appex */
+static BDD_THREAD_LOCAL int appexid;                 /* Current cache id for appex */
+static BDD_THREAD_LOCAL int quantid;                 /* Current cache id for quantifications */
+static BDD_THREAD_LOCAL int *quantvarset;            /* Current variable set for quant. */
+static BDD_THREAD_LOCAL int quantvarsetID;           /* Current id used in quantvarset */
+static BDD_THREAD_LOCAL int quantlast;               /* Current last variable to be quant. */
+static BDD_THREAD_LOCAL int replaceid;               /* Current cache id for replace */
+static BDD_THREAD_LOCAL int *replacepair;            /* Current replace pair */
+static BDD_THREAD_LOCAL int replacelast;             /* Current last var. level to replace */
+static BDD_THREAD_LOCAL int composelevel;            /* Current variable used for compose */
+static BDD_THREAD_LOCAL int miscid;                  /* Current cache id for other results */
+static BDD_THREAD_LOCAL int *varprofile;             /* Current variable profile */
+static BDD_THREAD_LOCAL int supportID;               /* Current ID (true value) for support */
+static BDD_THREAD_LOCAL int supportMin;              /* Min. used level in support calc. */
+static BDD_THREAD_LOCAL int supportMax;              /* Max. used level in support calc. */
+static BDD_THREAD_LOCAL int* supportSet;             /* The found support set */
+static BDD_THREAD_LOCAL int supportSize;             /* Number of int's allocated for supportSet */
+static BDD_THREAD_LOCAL BddCache opcache;            /* Cache for all operations */
+static BDD_THREAD_LOCAL int cacheratio;
+static BDD_THREAD_LOCAL BDD satPolarity;
+static BDD_THREAD_LOCAL int firstReorder;            /* Used instead of local variable in order
 				       to avoid compiler warning about 'first'
 				       being clobbered by setjmp */
 
-static int this_apply_counter;    /* Keep track of number of calls to current apply operation */
+static BDD_THREAD_LOCAL int this_apply_counter;    /* Keep track of number of calls to current apply operation */
 #define THIS_APPLY_REPORT 1000000   /* How often should program report apply operations */
 
-static char*            allsatProfile; /* Variable profile for bdd_allsat() */
-static bddallsathandler allsatHandler; /* Callback handler for bdd_allsat() */
+static BDD_THREAD_LOCAL char*            allsatProfile; /* Variable profile for bdd_allsat() */
+static BDD_THREAD_LOCAL bddallsathandler allsatHandler; /* Callback handler for bdd_allsat() */
 
-extern bddCacheStat bddcachestats;
+extern BDD_THREAD_LOCAL bddCacheStat bddcachestats;
 
    /* Internal prototypes */
 static BDD    not_rec(BDD);
@@ -41,7 +41,14 @@ using namespace trustbdd;
 #define COLLECT_FRACTION 0.10
 
 
-static int next_term_id = 1;
+static thread_local int next_term_id = 1;
+
+// Set by the BDD error handler, e.g., when the node limit is reached
+static thread_local bool bdd_failed = false;
+
+static void record_bdd_error(int errcode) {
+    bdd_failed = true;
+}
 
 Term::Term (tbdd t) { 
     term_id = next_term_id++;
@@ -80,6 +87,25 @@ TermSet::TermSet(int nv, int nd, ilist var_order, int vlevel) {
     max_bdd = 0;
     root = bdd_false();
     next_term_id = 1;
+    // Errors abort the reduction instead of the program
+    bdd_failed = false;
+    bdd_error_hook(record_bdd_error);
+    has_deadline = false;
+    exceeded = false;
+}
+
+void TermSet::set_time_limit(double seconds) {
+    has_deadline = seconds > 0;
+    deadline = chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(seconds));
+}
+
+bool TermSet::out_of_budget() {
+    if (!exceeded && (bdd_failed || (has_deadline && chrono::steady_clock::now() > deadline))) {
+	exceeded = true;
+	if (verblevel >= 1)
+	    std::cout << "c BDD " << (bdd_failed ? "node" : "time") << " limit exceeded" << std::endl;
+    }
+    return exceeded;
 }
 
 TermSet::~TermSet() {
@@ -109,6 +135,8 @@ long int TermSet::bdd_size_limit() {
 int TermSet::add(tbdd t) {
     Term *tp = new Term(t);
     terms.push_back(tp);
+    if (out_of_budget())
+	return -1;
     max_bdd = max(max_bdd, tp->get_node_count());
     if (max_bdd > bdd_size_limit()) {
 	cout << "c ERROR.  BDD size " << max_bdd << " exceeds limit " << bdd_size_limit() << endl;
@@ -201,6 +229,9 @@ int TermSet::find_bucket_level(int tid) {
 
 
 bool TermSet::bucket_reduce() {
+    // Clauses added after an error are meaningless
+    if (out_of_budget())
+	return false;
     vector<vector<int>> buckets;
     buckets.resize(nvar+1);
     int tcount = 0;
@@ -587,8 +618,7 @@ void Ordering::order_encoded(vector<int> &evar) {
     float best_distance = 0;
     float best_sum = 0;
     for (int t = 0; t < min(nencode, START_COUNT); t++) {
-	float r = (float) random() / RAND_MAX;
-	int vsource = ndata + 1 + (int) (nencode * r);
+	int vsource = ndata + 1 + rand_r(&rng_state) % nencode;
 	float hdistance = 0.0;
 	float hsum = 0.0;
 	int hop;
@@ -625,7 +655,7 @@ void Ordering::order_encoded(vector<int> &evar) {
 
 
 ilist Ordering::generate_ordering(unsigned seed) {
-    srandom(seed);
+    rng_state = seed;
     ilist result = ilist_new(nvar);
     unordered_set<int> data_added;
     vector<int> evar;
@@ -34,6 +34,7 @@
 #pragma once
 
 #include <vector>
+#include <chrono>
 #include <unordered_set>
 #include <unordered_map>
 
@@ -97,6 +98,10 @@ private:
   int and_count;
   int quant_count;
   int max_bdd;
+  // Budget
+  bool has_deadline;
+  chrono::steady_clock::time_point deadline;
+  bool exceeded;
 
 public:
   TermSet(int nvar, int ndata, ilist var_order, int vlevel);
@@ -106,9 +111,16 @@ public:
   int add_clause(ilist literals);
   int add_clause(int *ldata, int len);
 
+  // Limit the time for building and reducing the terms (0 for no limit)
+  void set_time_limit(double seconds);
+
   // Reduce via bucket elimination.  Return true if successful
   bool bucket_reduce();
 
+  // Did the reduction fail because the time limit or the node limit
+  // (see tbdd_set_node_limit) was reached
+  bool budget_exceeded() { return exceeded; }
+
   // Get root of resulting BDD
   bdd get_root() { return root; }
 
@@ -127,6 +139,9 @@ private:
 
   int add(tbdd t);
 
+  // Check for errors and the deadline
+  bool out_of_budget();
+
   void check_gc();
 
   int conjunct(int tid1, int tid2);
@@ -176,6 +191,8 @@ private:
   // Mapping from pair of encoding variables to edge index
   // to ensure that edge is unique
   unordered_map<int,int> unique_edge;
+  // State of random number generator (thread safe)
+  unsigned rng_state;
   
 
 public:
@@ -183,6 +200,7 @@ public:
   void add_clause(int *ldata, int len);
 
   // Construct an suitable ordering of all of the variables
+  // Different seeds give different orderings
   ilist generate_ordering(unsigned seed);
 
 private:
@@ -115,45 +115,45 @@ const BDD bddfalse=0;                    /* The constant false bdd */
 
 /* Min. number of nodes (%) that has to be left after a garbage collect
    unless a resize should be done. */
-static int minfreenodes=20;
+static BDD_THREAD_LOCAL int minfreenodes=20;
 
 
 /*=== GLOBAL KERNEL VARIABLES ==========================================*/
 
-int          bddrunning;            /* Flag - package initialized */
-int          bdderrorcond;          /* Some error condition */
-int          bddnodesize;           /* Number of allocated nodes */
-int          bddmaxnodesize;        /* Maximum allowed number of nodes */
-int          bddmaxnodeincrease;    /* Max. # of nodes used to inc. table */
-BddNode*     bddnodes;          /* All of the bdd nodes */
-int          bddfreepos;        /* First free node */
-int          bddfreenum;        /* Number of free nodes */
-long int     bddproduced;       /* Number of new nodes ever produced */
-int          bddvarnum;         /* Number of defined BDD variables */
-int*         bddrefstack;       /* Internal node reference stack */
-int*         bddrefstacktop;    /* Internal node reference stack top */
-int*         bddvar2level;      /* Variable -> level table */
-int*         bddlevel2var;      /* Level -> variable table */
-jmp_buf      bddexception;      /* Long-jump point for interrupting calc. */
-int          bddresized;        /* Flag indicating a resize of the nodetable */
-
-bddCacheStat bddcachestats;
+BDD_THREAD_LOCAL int          bddrunning;            /* Flag - package initialized */
+BDD_THREAD_LOCAL int          bdderrorcond;          /* Some error condition */
+BDD_THREAD_LOCAL int          bddnodesize;           /* Number of allocated nodes */
+BDD_THREAD_LOCAL int          bddmaxnodesize;        /* Maximum allowed number of nodes */
+BDD_THREAD_LOCAL int          bddmaxnodeincrease;    /* Max. # of nodes used to inc. table */
+BDD_THREAD_LOCAL BddNode*     bddnodes;          /* All of the bdd nodes */
+BDD_THREAD_LOCAL int          bddfreepos;        /* First free node */
+BDD_THREAD_LOCAL int          bddfreenum;        /* Number of free nodes */
+BDD_THREAD_LOCAL long int     bddproduced;       /* Number of new nodes ever produced */
+BDD_THREAD_LOCAL int          bddvarnum;         /* Number of defined BDD variables */
+BDD_THREAD_LOCAL int*         bddrefstack;       /* Internal node reference stack */
+BDD_THREAD_LOCAL int*         bddrefstacktop;    /* Internal node reference stack top */
+BDD_THREAD_LOCAL int*         bddvar2level;      /* Variable -> level table */
+BDD_THREAD_LOCAL int*         bddlevel2var;      /* Level -> variable table */
+BDD_THREAD_LOCAL jmp_buf      bddexception;      /* Long-jump point for interrupting calc. */
+BDD_THREAD_LOCAL int          bddresized;        /* Flag indicating a resize of the nodetable */
+
+BDD_THREAD_LOCAL bddCacheStat bddcachestats;
 
 #if ENABLE_BTRACE
-FILE *bdd_trace_file = NULL;
+BDD_THREAD_LOCAL FILE *bdd_trace_file = NULL;
 #endif 
 
 
 /*=== PRIVATE KERNEL VARIABLES =========================================*/
 
-static BDD*     bddvarset;             /* Set of defined BDD variables */
-static int      gbcollectnum;          /* Number of garbage collections */
-static int      cachesize;             /* Size of the operator caches */
-static long int gbcclock;              /* Clock ticks used in GBC */
-static int      usednodes_nextreorder; /* When to do reorder next time */
-static bddinthandler  err_handler;     /* Error handler */
-static bddgbchandler  gbc_handler;     /* Garbage collection handler */
-static bdd2inthandler resize_handler;  /* Node-table-resize handler */
+static BDD_THREAD_LOCAL BDD*     bddvarset;             /* Set of defined BDD variables */
+static BDD_THREAD_LOCAL int      gbcollectnum;          /* Number of garbage collections */
+static BDD_THREAD_LOCAL int      cachesize;             /* Size of the operator caches */
+static BDD_THREAD_LOCAL long int gbcclock;              /* Clock ticks used in GBC */
+static BDD_THREAD_LOCAL int      usednodes_nextreorder; /* When to do reorder next time */
+static BDD_THREAD_LOCAL bddinthandler  err_handler;     /* Error handler */
+static BDD_THREAD_LOCAL bddgbchandler  gbc_handler;     /* Garbage collection handler */
+static BDD_THREAD_LOCAL bdd2inthandler resize_handler;  /* Node-table-resize handler */
 
 
    /* Strings for all error mesages */
@@ -35,41 +35,42 @@
 
 
 /* Global variables exported by prover */
-proof_type_t proof_type = PROOF_FRAT;
-int verbosity_level = 1;
-int *variable_counter = NULL;
-int *clause_id_counter = NULL;
-int clause_limit = CLAUSE_LIMIT_LRAT;
-int total_clause_count = 0;
-int input_clause_count = 0;
-int input_variable_count = 0;
-int max_live_clause_count = 0;
-int deleted_clause_count = 0;
+BDD_THREAD_LOCAL proof_type_t proof_type = PROOF_FRAT;
+BDD_THREAD_LOCAL int verbosity_level = 1;
+BDD_THREAD_LOCAL int *variable_counter = NULL;
+BDD_THREAD_LOCAL int *clause_id_counter = NULL;
+BDD_THREAD_LOCAL int clause_limit = CLAUSE_LIMIT_LRAT;
+BDD_THREAD_LOCAL int node_limit = 0;
+BDD_THREAD_LOCAL int total_clause_count = 0;
+BDD_THREAD_LOCAL int input_clause_count = 0;
+BDD_THREAD_LOCAL int input_variable_count = 0;
+BDD_THREAD_LOCAL int max_live_clause_count = 0;
+BDD_THREAD_LOCAL int deleted_clause_count = 0;
 
 /* Global variables used by prover */
-static FILE *proof_file = NULL;
+static BDD_THREAD_LOCAL FILE *proof_file = NULL;
 /* 
    For LRAT, only need to keep dictionary of input clauses.
    For DRAT & FRAT, need dictionary of all clauses in order to delete them.
 */
 
-static bool do_binary = false;
-static ilist *all_clauses = NULL;
-static int alloc_clause_count = 0;
-static int live_clause_count = 0;
-static ilist deferred_deletion_list = NULL;
+static BDD_THREAD_LOCAL bool do_binary = false;
+static BDD_THREAD_LOCAL ilist *all_clauses = NULL;
+static BDD_THREAD_LOCAL int alloc_clause_count = 0;
+static BDD_THREAD_LOCAL int live_clause_count = 0;
+static BDD_THREAD_LOCAL ilist deferred_deletion_list = NULL;
 /* Track empty clause to:
    1) Know if it has been generated
    2) Finalize it for FRAT proof
    3) Make sure it only gets finalized once
 */
-static int empty_clause_id = TAUTOLOGY;
-static bool empty_clause_finalized = false;
+static BDD_THREAD_LOCAL int empty_clause_id = TAUTOLOGY;
+static BDD_THREAD_LOCAL bool empty_clause_finalized = false;
 
 
 // Buffer used when generating binary files
-static unsigned char *dest_buf = NULL;
-static size_t dest_buf_len = 0;
+static BDD_THREAD_LOCAL unsigned char *dest_buf = NULL;
+static BDD_THREAD_LOCAL size_t dest_buf_len = 0;
 
 // Parameters
 // Cutoff betweeen large and small allocations (in terms of clauses)
@@ -94,6 +95,8 @@ static size_t dest_buf_len = 0;
 #define BUDDY_INCREASE_LARGE (4*1000*1000)
 #define BUDDY_INCREASE_SMALL (1* 100*1000)
 #endif
+// Smallest node limit (beyond the nodes for the variables)
+#define BUDDY_NODES_MIN 1000
 
 // How many clauses should allocated for clauses
 #define INITIAL_CLAUSE_COUNT 1000
@@ -176,6 +179,17 @@ int prover_init(FILE *pfile, int *var_counter, int *cls_counter, ilist *input_cl
     int bnodes = small ? BUDDY_NODES_SMALL : BUDDY_NODES_LARGE;
     int bcache = bnodes/BUDDY_CACHE_RATIO;
     int bincrease = small ? BUDDY_INCREASE_SMALL : BUDDY_INCREASE_LARGE;
+    /* With a node limit, start with (at most) half of it and grow in steps of at most half */
+    int nlimit = node_limit;
+    if (nlimit > 0) {
+	if (nlimit < 4*input_variable_count + BUDDY_NODES_MIN)
+	    nlimit = 4*input_variable_count + BUDDY_NODES_MIN;
+	if (bnodes > nlimit/2)
+	    bnodes = nlimit/2;
+	if (bincrease > nlimit/2)
+	    bincrease = nlimit/2;
+	bcache = bnodes/BUDDY_CACHE_RATIO;
+    }
     int rval = bdd_init(bnodes, bcache);
 
     int *varlist = NULL;
@@ -198,6 +212,8 @@ int prover_init(FILE *pfile, int *var_counter, int *cls_counter, ilist *input_cl
 
     bdd_setcacheratio(BUDDY_CACHE_RATIO);
     bdd_setmaxincrease(bincrease);
+    if (nlimit > bdd_getallocnum())
+	bdd_setmaxnodenum(nlimit);
     bdd_setvarnum_ordered(input_variable_count+1, varlist);
     bdd_disable_reorder();
     return rval;
@@ -706,10 +722,10 @@ const char *hint_name[HINT_COUNT+1] = {"RESHU", "ARG1HD", "ARG2HD", "OPH", "RESL
   Data structures used during proof generation
  */
 
-static int hint_id[HINT_COUNT+1];
-static int hint_buf[HINT_COUNT+1][MAX_CLAUSE+ILIST_OVHD];
-static ilist hint_clause[HINT_COUNT+1];
-static bool hint_used[HINT_COUNT+1];
+static BDD_THREAD_LOCAL int hint_id[HINT_COUNT+1];
+static BDD_THREAD_LOCAL int hint_buf[HINT_COUNT+1][MAX_CLAUSE+ILIST_OVHD];
+static BDD_THREAD_LOCAL ilist hint_clause[HINT_COUNT+1];
+static BDD_THREAD_LOCAL bool hint_used[HINT_COUNT+1];
 
 static jtype_t hint_hl_order[HINT_COUNT] = 
     { HINT_RESHU, HINT_ARG1HD, HINT_ARG2HD, HINT_OPH, HINT_RESLU, HINT_ARG1LD, HINT_ARG2LD, HINT_OPL };
@@ -725,7 +741,7 @@ static jtype_t hint_l_order[HINT_COUNT/2+1] =
     { HINT_EXTRA, HINT_RESLU, HINT_ARG1LD, HINT_ARG2LD, HINT_OPL };
 
 
-static char hstring[1024];
+static BDD_THREAD_LOCAL char hstring[1024];
 
 static void initialize_hints() {
     jtype_t hi;
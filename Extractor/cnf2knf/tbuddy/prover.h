@@ -50,16 +50,17 @@ extern "C" {
 #endif
 
 /* Global variables exported by prover */
-extern proof_type_t proof_type;
-extern int verbosity_level;
-extern int clause_limit;
-extern int *variable_counter;
-extern int *clause_id_counter;
-extern int total_clause_count;
-extern int input_variable_count;
-extern int input_clause_count;
-extern int max_live_clause_count;
-extern int deleted_clause_count;
+extern BDD_THREAD_LOCAL proof_type_t proof_type;
+extern BDD_THREAD_LOCAL int verbosity_level;
+extern BDD_THREAD_LOCAL int clause_limit;
+extern BDD_THREAD_LOCAL int node_limit;
+extern BDD_THREAD_LOCAL int *variable_counter;
+extern BDD_THREAD_LOCAL int *clause_id_counter;
+extern BDD_THREAD_LOCAL int total_clause_count;
+extern BDD_THREAD_LOCAL int input_variable_count;
+extern BDD_THREAD_LOCAL int input_clause_count;
+extern BDD_THREAD_LOCAL int max_live_clause_count;
+extern BDD_THREAD_LOCAL int deleted_clause_count;
 
 /* Prover setup and completion */
 extern int prover_init(FILE *pfile, int *variable_counter, int *clause_counter, ilist *clauses, ilist variable_ordering, proof_type_t ptype, bool binary);
@@ -63,19 +63,19 @@
 #define __USERESIZE /* FIXME */
 
    /* Current auto reord. method and number of automatic reorderings left */
-static int bddreordermethod;
-static int bddreordertimes;
+static BDD_THREAD_LOCAL int bddreordermethod;
+static BDD_THREAD_LOCAL int bddreordertimes;
 
    /* Flag for disabling reordering temporarily */
-static int reorderdisabled;
+static BDD_THREAD_LOCAL int reorderdisabled;
 
    /* Store for the variable relationships */
-static BddTree *vartree;
-static int blockid;
+static BDD_THREAD_LOCAL BddTree *vartree;
+static BDD_THREAD_LOCAL int blockid;
 
    /* Store for the ref.cou. of the external roots */
-static int *extroots;
-static int extrootsize;
+static BDD_THREAD_LOCAL int *extroots;
+static BDD_THREAD_LOCAL int extrootsize;
 
 /* Level data */
 typedef struct _levelData
@@ -86,28 +86,28 @@ typedef struct _levelData
    int nodenum;  /* Number of nodes in this level */
 } levelData;
 
-static levelData *levels; /* Indexed by variable! */
+static BDD_THREAD_LOCAL levelData *levels; /* Indexed by variable! */
 
    /* Interaction matrix */
-static imatrix *iactmtx;
+static BDD_THREAD_LOCAL imatrix *iactmtx;
 
    /* Reordering information for the user */
-static int verbose;
-static bddinthandler reorder_handler;
-static bddfilehandler reorder_filehandler;
-static bddsizehandler reorder_nodenum;
+static BDD_THREAD_LOCAL int verbose;
+static BDD_THREAD_LOCAL bddinthandler reorder_handler;
+static BDD_THREAD_LOCAL bddfilehandler reorder_filehandler;
+static BDD_THREAD_LOCAL bddsizehandler reorder_nodenum;
 
    /* Number of live nodes before and after a reordering session */
-static int usednum_before;
-static int usednum_after;
+static BDD_THREAD_LOCAL int usednum_before;
+static BDD_THREAD_LOCAL int usednum_after;
 	    
    /* Kernel variables needed for reordering */
-extern int bddfreepos;
-extern int bddfreenum;
-extern int bddproduced;
+extern BDD_THREAD_LOCAL int bddfreepos;
+extern BDD_THREAD_LOCAL int bddfreenum;
+extern BDD_THREAD_LOCAL int bddproduced;
 
    /* Flag telling us when a node table resize is done */
-static int resizedInMakenode;
+static BDD_THREAD_LOCAL int resizedInMakenode;
 
    /* New node hashing function for use with reordering */
 #define NODEHASH(var,l,h) ((PAIR((l),(h))%levels[var].size)+levels[var].start)
@@ -1566,7 +1566,7 @@ int bdd_swapvar(int v1, int v2)
 
 void bdd_default_reohandler(int prestate)
 {
-   static long c1;
+   static BDD_THREAD_LOCAL long c1;
 
    if (verbose > 0)
    {
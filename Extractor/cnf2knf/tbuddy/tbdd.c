@@ -40,23 +40,23 @@
 
 #define BUFLEN 2048
 // For formatting information
-static char ibuf[BUFLEN];
+static BDD_THREAD_LOCAL char ibuf[BUFLEN];
 
 #define FUN_MAX 10
-static tbdd_info_fun ifuns[FUN_MAX];
-static int ifun_count = 0;
+static BDD_THREAD_LOCAL tbdd_info_fun ifuns[FUN_MAX];
+static BDD_THREAD_LOCAL int ifun_count = 0;
 
-static tbdd_done_fun dfuns[FUN_MAX];
-static int dfun_count = 0;
+static BDD_THREAD_LOCAL tbdd_done_fun dfuns[FUN_MAX];
+static BDD_THREAD_LOCAL int dfun_count = 0;
 
-static int last_variable = 0;
-static int last_clause_id = 0;
+static BDD_THREAD_LOCAL int last_variable = 0;
+static BDD_THREAD_LOCAL int last_clause_id = 0;
 
 
 /* Unit clauses that have not been deleted */
-static ilist created_unit_clauses;
+static BDD_THREAD_LOCAL ilist created_unit_clauses;
 /* Unit clauses that (should) have been deleted */
-static ilist dead_unit_clauses;
+static BDD_THREAD_LOCAL ilist dead_unit_clauses;
 
 /* Managing reference counts for TBDDs */
 
@@ -72,14 +72,14 @@ static ilist dead_unit_clauses;
 #define TABLE_SCALE 2
 
 /* Table of references */
-static int *rc_table = NULL;
+static BDD_THREAD_LOCAL int *rc_table = NULL;
 /* Number of allocated table entries */
-static int rc_allocated_count = 0;
+static BDD_THREAD_LOCAL int rc_allocated_count = 0;
 /*
   Head of free list.  Free list threads through unused table
   positions, terminating with value -1
 */
-static int rc_freepos;
+static BDD_THREAD_LOCAL int rc_freepos;
 
 /*============================================
   Local functions
@@ -272,6 +272,10 @@ void tbdd_set_clause_limit(int clim) {
     clause_limit = clim;
 }
 
+void tbdd_set_node_limit(int nlim) {
+    node_limit = nlim < 0 ? 0 : nlim;
+}
+
 void bdd_report() {
     if (verbosity_level >= 1) {
 	bddStat s;
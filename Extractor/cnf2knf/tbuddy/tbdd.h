@@ -156,6 +156,14 @@ extern void tbdd_set_verbose(int level);
  */
 extern void tbdd_set_clause_limit(int clim);
 
+/*
+  Set limit on the number of BDD nodes for subsequent initializations
+  (of the calling thread).  Setting to 0 removes the limit.
+  When the limit is reached, the BDD error handler is called with BDD_NODENUM
+  and further operations yield bdd_false() (see bdd_clear_error)
+ */
+extern void tbdd_set_node_limit(int nlim);
+
 /*============================================
  Creation and manipulation of trusted BDDs
 ============================================*/
@@ -2,7 +2,6 @@
 
 DERIVATION=Tools/derivation
 CHECK=Tools/check-sat/check-sat
-PROCESSASS=Tools/process-assignment.py
 CCDCL="cardinality-cadical/build/cadical"
 CADICAL="Tools/cadical/build/cadical"
 DRAT="Tools/drat-trim/drat-trim"
@@ -40,7 +39,7 @@ then # CNF input formula
   echo "Start Cadical"
   
   # Run cadical on propagated CNF, with a 5000 second timeout
-  ./$CADICAL $TMP/encoded.cnf $TMP/solve.drat --no-binary -t $TIMEOUT > $TMP/cadical.out
+  ./$CADICAL $TMP/encoded.cnf $TMP/solve.drat -t $TIMEOUT > $TMP/cadical.out
 
   echo "End Cadical"
 
@@ -61,34 +60,21 @@ then # CNF input formula
 
       ./$CCDCL $INPUTFORMULA -c 0 --printUnits=1 > $TMP/prop.out
 
-      # get units from assignment
-      grep "^v " $TMP/cadical.out | tr " " "\n"  | grep -v -e "v" -e "^0" | awk '{print $1" 0"}' > $TMP/tmp-assignment-units.out
-      
-      # check if any variables were eliminated
-      head -n 30 $INPUTKNF | grep "c Eliminated variables IDs:" | tr " " "\n"  | grep -v -e "c" -e "Eliminated" -e "variables" -e "IDs:" > $TMP/eliminatedVars.txt
+      grep "^v " $TMP/cadical.out > $TMP/solve.sol
 
-      grep "Eliminated Variables " $TMP/prop.out | tr " " "\n" | grep -v -e "Eliminated" -e "Variables" > $TMP/EliminatedUnits.txt
+      # variables without value in the model: the encoding variables
+      # eliminated by the extractor (listed in its statistics) and the
+      # variables fixed by unit propagation
+      grep "^c .*variables IDs:" $INPUTKNF > $TMP/eliminatedVars.txt
+      grep "Eliminated Variables " $TMP/prop.out >> $TMP/eliminatedVars.txt
 
-      cat $TMP/EliminatedUnits.txt >> $TMP/eliminatedVars.txt
-      
-      p=$( wc $TMP/eliminatedVars.txt | awk '{print  $1}')
-      if [ $p -gt 0 ]
-      then # remove eliminated encoding variables from the assignment
-        python3 $PROCESSASS -i $TMP/tmp-assignment-units.out -e $TMP/eliminatedVars.txt -o $TMP/assignment-units.out
-      else # no encoding variables eliminated
-        mv $TMP/tmp-assignment-units.out $TMP/assignment-units.out
-      fi
-      
-      # add units to original CNF formula
-      cat $INPUTFORMULA $TMP/assignment-units.out > $TMP/cnf-with-units.cnf
-      # check by running cadical with units
-      ./$CADICAL -f $TMP/cnf-with-units.cnf > $TMP/sat-check.out
-      
-      # if cadical returns satisfiable, units satisfied formula
-      p=$(grep "s SATISFIABLE" $TMP/sat-check.out | wc | awk '{print  $1}')
+      # check-sat reconstructs their values and checks the original formula
+      ./$CHECK $INPUTFORMULA $TMP/solve.sol -eliminated $TMP/eliminatedVars.txt > $TMP/sat-check.out
+
+      p=$(grep "c VERIFIED SATISFIABLE" $TMP/sat-check.out | wc | awk '{print  $1}')
       if [ $p -gt 0 ]
       then
-        echo "Verified SAT by propagating assignment on reencoded formula"
+        echo "Verified SAT by reconstructing eliminated variables on original formula"
       fi
       echo "End SAT Checking"
         
@@ -98,7 +84,7 @@ then # CNF input formula
       then
         # UNSAT case
         echo "Start UNSAT Checking"
-        ./$DERIVATION $INPUTKNF > $TMP/deriv.drat
+        ./$DERIVATION $INPUTKNF --binary > $TMP/deriv.drat
 
         cat $TMP/deriv.drat $TMP/solve.drat > $TMP/proof.drat
 
@@ -128,7 +114,7 @@ else # KNF input formula
   echo "Start Cadical"
   
   # Run cadical on propagated CNF, with a 5000 second timeout
-  ./$CADICAL $TMP/encoded.cnf $TMP/solve.drat --no-binary -t $TIMEOUT > $TMP/cadical.out
+  ./$CADICAL $TMP/encoded.cnf $TMP/solve.drat -t $TIMEOUT > $TMP/cadical.out
 
   echo "End Cadical"
 
@@ -157,7 +143,7 @@ else # KNF input formula
         echo "Start UNSAT Checking"
 
         
-        ./$DERIVATION $INPUTKNF > $TMP/deriv.drat
+        ./$DERIVATION $INPUTKNF --binary > $TMP/deriv.drat
 
         cat $TMP/deriv.drat $TMP/solve.drat > $TMP/proof.drat
 
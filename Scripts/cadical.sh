@@ -24,7 +24,7 @@ then # CNF input formula
   echo "Start Cadical"
 
   # Run cadical on the propagated CNF, with a 5000 second timeout
-  ./$CADICAL $TMP/prop.cnf $TMP/solve.drat --no-binary -t $TIMEOUT > $TMP/cadical.out
+  ./$CADICAL $TMP/prop.cnf $TMP/solve.drat -t $TIMEOUT > $TMP/cadical.out
 
   echo "End Cadical"
 
@@ -72,7 +72,7 @@ else # KNF input formula
   echo "Start Cadical"
   
   # Run cadical on propagated CNF, with a 5000 second timeout
-  ./$CADICAL $TMP/encoded.cnf $TMP/solve.drat --no-binary -t $TIMEOUT > $TMP/cadical.out
+  ./$CADICAL $TMP/encoded.cnf $TMP/solve.drat -t $TIMEOUT > $TMP/cadical.out
 
   echo "End Cadical"
 
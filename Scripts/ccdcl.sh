@@ -1,11 +1,10 @@
 #!bin/bash
 
-DERIVATION=Tools/derivation
 CHECK=Tools/check-sat/check-sat
-PROCESSASS=Tools/process-assignment.py
 CCDCL="cardinality-cadical/build/cadical"
 CADICAL="Tools/cadical/build/cadical"
 DRAT="Tools/drat-trim/drat-trim"
+VERIPB="veripb"
 KNF2CNF="Tools/knf2cnf"
 EXTRACTOR="Extractor/cnf2knf/src/cnf2knf"
 
@@ -38,7 +37,7 @@ then # CNF input formula
   echo "Start Cadical"
 
   # Run cadical on the propagated CNF, with a 5000 second timeout
-  ./$CCDCL $TMP/prop.cnf $TMP/solve.drat --no-binary -t $TIMEOUT > $TMP/cadical.out
+  ./$CCDCL $TMP/prop.cnf $TMP/solve.drat -t $TIMEOUT > $TMP/cadical.out
 
   echo "End Cadical"
 
@@ -59,34 +58,21 @@ then # CNF input formula
 
       ./$CCDCL $INPUTFORMULA -c 0 --printUnits=1 > $TMP/prop.out
 
-      # get units from assignment
-      grep "^v " $TMP/cadical.out | tr " " "\n"  | grep -v -e "v" -e "^0" | awk '{print $1" 0"}' > $TMP/tmp-assignment-units.out
-      
-      # check if any variables were eliminated
-      head -n 30 $INPUTKNF | grep "c Eliminated variables IDs:" | tr " " "\n"  | grep -v -e "c" -e "Eliminated" -e "variables" -e "IDs:" > $TMP/eliminatedVars.txt
+      grep "^v " $TMP/cadical.out > $TMP/solve.sol
 
-      grep "Eliminated Variables " $TMP/prop.out | tr " " "\n" | grep -v -e "Eliminated" -e "Variables" > $TMP/EliminatedUnits.txt
+      # variables without value in the model: the encoding variables
+      # eliminated by the extractor (listed in its statistics) and the
+      # variables fixed by unit propagation
+      grep "^c .*variables IDs:" $INPUTKNF > $TMP/eliminatedVars.txt
+      grep "Eliminated Variables " $TMP/prop.out >> $TMP/eliminatedVars.txt
 
-      cat $TMP/EliminatedUnits.txt >> $TMP/eliminatedVars.txt
-      
-      p=$( wc $TMP/eliminatedVars.txt | awk '{print  $1}')
-      if [ $p -gt 0 ]
-      then # remove eliminated encoding variables from the assignment
-        python3 $PROCESSASS -i $TMP/tmp-assignment-units.out -e $TMP/eliminatedVars.txt -o $TMP/assignment-units.out
-      else # no encoding variables eliminated
-        mv $TMP/tmp-assignment-units.out $TMP/assignment-units.out
-      fi
-      
-      # add units to original CNF formula
-      cat $INPUTFORMULA $TMP/assignment-units.out > $TMP/cnf-with-units.cnf
-      # check by running cadical with units
-      ./$CADICAL -f $TMP/cnf-with-units.cnf > $TMP/sat-check.out
-      
-      # if cadical returns satisfiable, units satisfied formula
-      p=$(grep "s SATISFIABLE" $TMP/sat-check.out | wc | awk '{print  $1}')
+      # check-sat reconstructs their values and checks the original formula
+      ./$CHECK $INPUTFORMULA $TMP/solve.sol -eliminated $TMP/eliminatedVars.txt > $TMP/sat-check.out
+
+      p=$(grep "c VERIFIED SATISFIABLE" $TMP/sat-check.out | wc | awk '{print  $1}')
       if [ $p -gt 0 ]
       then
-        echo "Verified SAT by propagating assignment on reencoded formula"
+        echo "Verified SAT by reconstructing eliminated variables on original formula"
       fi
       echo "End SAT Checking"
         
@@ -117,8 +103,20 @@ else # KNF input formula
 
   echo "Start Cadical"
   
+  # Without VeriPB fall back to a DRAT proof checked by drat-trim
+  if [ $PROOFCHECKING -gt 1 ] && ! command -v $VERIPB > /dev/null
+  then
+    echo "VeriPB not found, checking with drat-trim"
+    PROOFCHECKING=1
+  fi
+
   # Run cadical on KNF, with a 5000 second timeout
-  ./$CCDCL $INPUTFORMULA $TMP/solve.drat --no-binary -t $TIMEOUT > $TMP/cadical.out
+  if [ $PROOFCHECKING -gt 1 ]
+  then # native VeriPB proof, formula written to solve.pbp.opb
+    ./$CCDCL $INPUTFORMULA $TMP/solve.pbp --veripb=1 -t $TIMEOUT > $TMP/cadical.out
+  else
+    ./$CCDCL $INPUTFORMULA $TMP/solve.drat -t $TIMEOUT > $TMP/cadical.out
+  fi
 
   echo "End Cadical"
 
@@ -146,12 +144,21 @@ else # KNF input formula
       # UNSAT case
         echo "Start UNSAT Checking"
 
-        ./$KNF2CNF $INPUTFORMULA > $TMP/encoded.cnf
-        ./$DERIVATION $INPUTKNF > $TMP/deriv.drat
+        if [ $PROOFCHECKING -gt 1 ]
+        then
+          if $VERIPB $TMP/solve.pbp.opb $TMP/solve.pbp > $TMP/veripb-check.out
+          then
+            echo "Verified UNSAT with VeriPB on original formula"
+          else
+            echo "NOT VERIFIED UNSAT with VeriPB"
+          fi
+          echo "End UNSAT Checking"
+          exit 0
+        fi
 
-        cat $TMP/deriv.drat $TMP/solve.drat > $TMP/proof.drat
+        ./$KNF2CNF $INPUTFORMULA > $TMP/encoded.cnf
 
-        ./$DRAT $TMP/encoded.cnf $TMP/proof.drat > $TMP/drat-check.out
+        ./$DRAT $TMP/encoded.cnf $TMP/solve.drat > $TMP/drat-check.out
         # cat $TMP/drat-check.out | grep -v "WARNING"
         
         p=$(grep "s VERIFIED" $TMP/drat-check.out | wc | awk '{print  $1}')
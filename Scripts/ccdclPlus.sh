@@ -2,9 +2,7 @@
 
 #!bin/bash
 
-DERIVATION=Tools/derivation
 CHECK=Tools/check-sat/check-sat
-PROCESSASS=Tools/process-assignment.py
 CCDCL="cardinality-cadical/build/cadical"
 CADICAL="Tools/cadical/build/cadical"
 DRAT="Tools/drat-trim/drat-trim"
@@ -38,25 +36,12 @@ then # CNF input formula
 
   echo "End Extraction"
 
-  AUX=$(grep "p knf" $INPUTKNF | awk '{print $3}')
-
-  ./$KONLY $TMP/extracted.knf > $TMP/encode.cnf
-
-  cat $TMP/extracted.knf $TMP/encode.cnf > $TMP/full.knf
-
-  VAR=$(grep "p cnf" $TMP/encode.cnf | awk '{print $3}')
-  CLS1=$(grep "p cnf" $TMP/encode.cnf | awk '{print $4}')
-  CLS2=$(grep "p knf" $TMP/extracted.knf | awk '{print $4}')
-  grep -v "p cnf \|p knf" $TMP/full.knf > $TMP/full-nohead.knf
-  CLS=$(($CLS1+$CLS2))
-  printf 'p knf %s %s\n' "$VAR $CLS" > $TMP/temp1.txt
-  cat $TMP/temp1.txt $TMP/full-nohead.knf > $TMP/full.knf
-  rm $TMP/temp1.txt $TMP/full-nohead.knf
-
   echo "Start Cadical"
 
-  # Run cadical on the propagated CNF, with a 5000 second timeout
-  ./$CCDCL $TMP/full.knf -t $TIMEOUT $TMP/solve.drat --no-binary --ccdclMode=1   > $TMP/cadical.out
+  # Run cadical on the extracted KNF, with a 5000 second timeout.  The
+  # solver adds the clausal encoding of the constraints itself and streams
+  # its derivation as prefix of the proof.
+  ./$CCDCL $INPUTKNF -t $TIMEOUT $TMP/solve.drat --ccdclMode=1 --ccdclEncoding=3 > $TMP/cadical.out
 
   echo "End Cadical"
 
@@ -77,34 +62,21 @@ then # CNF input formula
 
       ./$CCDCL $INPUTFORMULA -c 0 --printUnits=1 > $TMP/prop.out
 
-      # get units from assignment
-      grep "^v " $TMP/cadical.out | tr " " "\n"  | grep -v -e "v" -e "^0" | awk '{print $1" 0"}' > $TMP/tmp-assignment-units.out
-      
-      # check if any variables were eliminated
-      head -n 30 $INPUTKNF | grep "c Eliminated variables IDs:" | tr " " "\n"  | grep -v -e "c" -e "Eliminated" -e "variables" -e "IDs:" > $TMP/eliminatedVars.txt
+      grep "^v " $TMP/cadical.out > $TMP/solve.sol
 
-      grep "Eliminated Variables " $TMP/prop.out | tr " " "\n" | grep -v -e "Eliminated" -e "Variables" > $TMP/EliminatedUnits.txt
+      # variables without value in the model: the encoding variables
+      # eliminated by the extractor (listed in its statistics) and the
+      # variables fixed by unit propagation
+      grep "^c .*variables IDs:" $INPUTKNF > $TMP/eliminatedVars.txt
+      grep "Eliminated Variables " $TMP/prop.out >> $TMP/eliminatedVars.txt
 
-      cat $TMP/EliminatedUnits.txt >> $TMP/eliminatedVars.txt
-      
-      p=$( wc $TMP/eliminatedVars.txt | awk '{print  $1}')
-      if [ $p -gt 0 ]
-      then # remove eliminated encoding variables from the assignment
-        python3 $PROCESSASS -i $TMP/tmp-assignment-units.out -e $TMP/eliminatedVars.txt -o $TMP/assignment-units.out
-      else # no encoding variables eliminated
-        mv $TMP/tmp-assignment-units.out $TMP/assignment-units.out
-      fi
-      
-      # add units to original CNF formula
-      cat $INPUTFORMULA $TMP/assignment-units.out > $TMP/cnf-with-units.cnf
-      # check by running cadical with units
-      ./$CADICAL -f $TMP/cnf-with-units.cnf > $TMP/sat-check.out
-      
-      # if cadical returns satisfiable, units satisfied formula
-      p=$(grep "s SATISFIABLE" $TMP/sat-check.out | wc | awk '{print  $1}')
+      # check-sat reconstructs their values and checks the original formula
+      ./$CHECK $INPUTFORMULA $TMP/solve.sol -eliminated $TMP/eliminatedVars.txt > $TMP/sat-check.out
+
+      p=$(grep "c VERIFIED SATISFIABLE" $TMP/sat-check.out | wc | awk '{print  $1}')
       if [ $p -gt 0 ]
       then
-        echo "Verified SAT by propagating assignment on reencoded formula"
+        echo "Verified SAT by reconstructing eliminated variables on original formula"
       fi
       echo "End SAT Checking"
         
@@ -114,11 +86,7 @@ then # CNF input formula
       then
         # UNSAT case
         echo "Start UNSAT Checking"
-        ./$DERIVATION $INPUTKNF > $TMP/deriv.drat
-
-        cat $TMP/deriv.drat $TMP/solve.drat > $TMP/proof.drat
-
-        ./$DRAT $INPUTFORMULA $TMP/proof.drat > $TMP/drat-check.out
+        ./$DRAT $INPUTFORMULA $TMP/solve.drat > $TMP/drat-check.out
         # cat $TMP/drat-check.out | grep -v "WARNING"
         
         p=$(grep "s VERIFIED" $TMP/drat-check.out | wc | awk '{print  $1}')
@@ -155,7 +123,7 @@ else # KNF input formula
   echo "Start Cadical"
 
   # Run cadical on the propagated CNF, with a 5000 second timeout
-  ./$CCDCL $TMP/full.knf -t $TIMEOUT $TMP/solve.drat --no-binary --ccdclMode=1  > $TMP/cadical.out
+  ./$CCDCL $TMP/full.knf -t $TIMEOUT $TMP/solve.drat --ccdclMode=1  > $TMP/cadical.out
 
   echo "End Cadical"
 
@@ -184,11 +152,8 @@ else # KNF input formula
         echo "Start UNSAT Checking"
 
         ./$KNF2CNF $INPUTFORMULA > $TMP/encoded.cnf
-        ./$DERIVATION $INPUTKNF > $TMP/deriv.drat
-
-        cat $TMP/deriv.drat $TMP/solve.drat > $TMP/proof.drat
 
-        ./$DRAT $TMP/encoded.cnf $TMP/proof.drat > $TMP/drat-check.out
+        ./$DRAT $TMP/encoded.cnf $TMP/solve.drat > $TMP/drat-check.out
         # cat $TMP/drat-check.out | grep -v "WARNING"
         
         p=$(grep "s VERIFIED" $TMP/drat-check.out | wc | awk '{print  $1}')
@@ -0,0 +1,34 @@
+#!/bin/bash
+
+# Compare the time to load a formula in text KNF and binary KNF.
+#
+#   sh Tools/bknf-bench.sh <KNF> [<runs>]
+#
+# Converts the formula to 'tmp/bench.bknf' and reports file sizes and the
+# parse time of the solver (as reported by itself) for both formats.
+
+CCDCL="cardinality-cadical/build/cadical"
+BKNF="Tools/bknf"
+
+TMP=tmp
+mkdir -p $TMP
+
+INPUTKNF=$1
+RUNS=${2:-3}
+
+start=$(date +%s.%N)
+./$BKNF $INPUTKNF $TMP/bench.bknf || exit 1
+end=$(date +%s.%N)
+echo "conversion seconds: $(echo "$start $end" | awk '{printf "%.2f", $2 - $1}')"
+
+echo "text KNF bytes:   $(wc -c < $INPUTKNF)"
+echo "binary KNF bytes: $(wc -c < $TMP/bench.bknf)"
+
+for FORMULA in $INPUTKNF $TMP/bench.bknf
+do
+  for i in $(seq $RUNS)
+  do
+    ./$CCDCL $FORMULA -c 0 --ccdclEncoding=0 | grep "^c parsed"
+  done | awk -v f=$FORMULA \
+    '{ t += $(NF-3); n++ } END { printf "%s: %.2f seconds parse time (average of %d)\n", f, t / n, n }'
+done
@@ -0,0 +1,243 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include "zfile.h"
+#include "bknf.h"
+
+// Converts text KNF (or CNF) to binary KNF and back, the direction is
+// determined by the 'BKNF' signature of the input.  Both may be compressed
+// ('.gz', '.bz2' or '.xz', see 'zfile.h').  See 'Binary KNF format'
+// in the top-level README for the specification of version 1.
+//
+//   bknf [<input> [<output>]]     (defaults to stdin and stdout)
+
+FILE *input, *output;
+const char *input_name = "<stdin>";
+
+void die (const char *msg) {
+  fprintf (stderr, "bknf: %s: %s\n", input_name, msg);
+  exit (1);
+}
+
+/*------------------------------------------------------------------------*/
+
+// Body of the binary formula, which is written after the header with the
+// number of constraints of each type.
+
+unsigned char *body;
+size_t size_body, capacity_body;
+
+void putbyte (unsigned char ch) {
+  if (size_body == capacity_body) {
+    capacity_body = capacity_body ? 2 * capacity_body : 1 << 16;
+    body = realloc (body, capacity_body);
+    if (!body) die ("out of memory");
+  }
+  body[size_body++] = ch;
+}
+
+void putvarint (uint64_t x) {
+  unsigned char buf[BKNF_MAX_VARINT];
+  unsigned n = bknf_put_varint (buf, x, 0);
+  for (unsigned i = 0; i < n; i++) putbyte (buf[i]);
+}
+
+char *line;     // comment text
+size_t capacity_line;
+
+/*------------------------------------------------------------------------*/
+
+int next (void) { return getc (input); }
+
+int parseint (int ch, int *res) {
+  int sign = 1;
+  if (ch == '-') { sign = -1; ch = next (); }
+  if (!isdigit (ch)) die ("expected number");
+  int64_t n = ch - '0';
+  while (isdigit (ch = next ()))
+    if ((n = 10 * n + (ch - '0')) > INT_MAX) die ("number too large");
+  *res = sign * n;
+  return ch;
+}
+
+int skipspace (int ch) {
+  while (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n') ch = next ();
+  return ch;
+}
+
+void text2binary (void) {
+  int ch = skipspace (next ());
+  int vars = 0, declared = 0, *lits = 0, capacity = 0;
+  int64_t counts[3] = { 0, 0, 0 };
+  int header = 0, type = BKNF_CLAUSE, encoding = 0;
+  for (;;) {
+    ch = skipspace (ch);
+    if (ch == EOF) break;
+    if (ch == 'c') {
+      size_t length = 0;
+      while ((ch = next ()) == ' ')
+        ;
+      while (ch != '\n' && ch != EOF) {
+        if (length == capacity_line) {
+          capacity_line = capacity_line ? 2 * capacity_line : 256;
+          line = realloc (line, capacity_line);
+          if (!line) die ("out of memory");
+        }
+        line[length++] = ch;
+        ch = next ();
+      }
+      putbyte (BKNF_COMMENT);
+      putvarint (length);
+      for (size_t i = 0; i < length; i++) putbyte (line[i]);
+      continue;
+    }
+    if (ch == 'p') {
+      if (header) die ("second header");
+      ch = skipspace (next ());
+      if (ch != 'c' && ch != 'k') die ("expected 'p cnf' or 'p knf'");
+      if (next () != 'n' || next () != 'f') die ("invalid header");
+      ch = parseint (skipspace (next ()), &vars);
+      ch = parseint (skipspace (ch), &declared);
+      header = 1;
+      continue;
+    }
+    if (!header) die ("expected header");
+    if (ch == 'e') { encoding = 1; ch = next (); continue; }
+    int bound = 1, guard = 0;
+    if (ch == 'k' || ch == 'g') {
+      type = ch == 'k' ? BKNF_CARDINALITY : BKNF_GUARDED;
+      ch = parseint (skipspace (next ()), &bound);
+      if (bound < 1) die ("expected positive bound");
+      if (type == BKNF_GUARDED) {
+        ch = parseint (skipspace (ch), &guard);
+        if (!guard) die ("expected guard literal");
+        if (abs (guard) > vars) vars = abs (guard);
+      }
+    }
+    int size = 0, lit;
+    for (;;) {
+      ch = parseint (skipspace (ch), &lit);
+      if (!lit) break;
+      if (abs (lit) > vars) vars = abs (lit);
+      if (size == capacity) {
+        capacity = capacity ? 2 * capacity : 64;
+        lits = realloc (lits, capacity * sizeof *lits);
+        if (!lits) die ("out of memory");
+      }
+      lits[size++] = lit;
+    }
+    putbyte (type | (encoding ? BKNF_ENCODING : 0));
+    if (type != BKNF_CLAUSE) putvarint (bound);
+    uint64_t prev = 0;
+    if (type == BKNF_GUARDED) putvarint (bknf_delta (&prev, guard));
+    putvarint (size);
+    prev = 0;
+    for (int i = 0; i < size; i++) putvarint (bknf_delta (&prev, lits[i]));
+    counts[type]++;
+    type = BKNF_CLAUSE, encoding = 0;
+  }
+  if (!header) die ("missing header");
+  if (counts[0] + counts[1] + counts[2] != declared)
+    fprintf (stderr, "bknf: warning: header declared %d constraints "
+      "but found %lld\n", declared,
+      (long long) (counts[0] + counts[1] + counts[2]));
+  // The header is appended to the body but written before it.
+  fputs ("BKNF", output);
+  putc (BKNF_VERSION, output);
+  size_t start = size_body;
+  putvarint (vars);
+  for (int i = 0; i < 3; i++) putvarint (counts[i]);
+  fwrite (body + start, 1, size_body - start, output);
+  fwrite (body, 1, start, output);
+  free (lits);
+  free (line);
+}
+
+/*------------------------------------------------------------------------*/
+
+uint64_t getvarint (void) {
+  uint64_t res = 0;
+  unsigned shift = 0;
+  int ch, more;
+  do {
+    if ((ch = next ()) == EOF) die ("unexpected end-of-file");
+    if ((more = bknf_get_varint (&res, &shift, ch)) < 0)
+      die ("number exceeds 64 bits");
+  } while (more);
+  return res;
+}
+
+int getdelta (uint64_t *prev) {
+  int lit = bknf_undelta (prev, getvarint ());
+  if (!lit) die ("invalid literal");
+  return lit;
+}
+
+void binary2text (void) {
+  if (next () != 'B' || next () != 'K' || next () != 'N' || next () != 'F')
+    die ("expected 'BKNF' signature");
+  if (next () != BKNF_VERSION) die ("unsupported version");
+  uint64_t vars = getvarint (), counts[3];
+  for (int i = 0; i < 3; i++) counts[i] = getvarint ();
+  fprintf (output, "p %s %llu %llu\n",
+    counts[BKNF_CARDINALITY] || counts[BKNF_GUARDED] ? "knf" : "cnf",
+    (unsigned long long) vars,
+    (unsigned long long) (counts[0] + counts[1] + counts[2]));
+  int ch;
+  while ((ch = next ()) != EOF) {
+    int type = ch & 3;
+    if (ch & ~7) die ("invalid record type");
+    if (type == BKNF_COMMENT) {
+      uint64_t length = getvarint ();
+      putc ('c', output);
+      if (length) putc (' ', output);
+      while (length--) {
+        if ((ch = next ()) == EOF) die ("unexpected end-of-file");
+        putc (ch, output);
+      }
+      putc ('\n', output);
+      continue;
+    }
+    if (ch & BKNF_ENCODING) fputs ("e ", output);
+    if (type == BKNF_CARDINALITY) fprintf (output, "k %llu ",
+      (unsigned long long) getvarint ());
+    if (type == BKNF_GUARDED) {
+      uint64_t bound = getvarint (), prev = 0;
+      fprintf (output, "g %llu %d ", (unsigned long long) bound,
+        getdelta (&prev));
+    }
+    uint64_t size = getvarint (), prev = 0;
+    while (size--) fprintf (output, "%d ", getdelta (&prev));
+    fputs ("0\n", output);
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+int main (int argc, char **argv) {
+  if (argc > 3 || (argc > 1 && !strcmp (argv[1], "-h"))) {
+    printf ("usage: bknf [<input> [<output>]]\n"
+            "converts text KNF to binary KNF and binary KNF to text\n");
+    return argc > 3;
+  }
+  input = stdin, output = stdout;
+  if (argc > 1 && strcmp (argv[1], "-")) {
+    input_name = argv[1];
+    if (!(input = zfopen (argv[1], "rb"))) die ("can not open input");
+  }
+  if (argc > 2 && !(output = zfopen (argv[2], "wb"))) {
+    input_name = argv[2];
+    die ("can not open output");
+  }
+  int ch = next ();
+  if (ch != EOF) ungetc (ch, input);
+  if (ch == 'B') binary2text ();
+  else text2binary ();
+  if (input != stdin) fclose (input);
+  if (output != stdout) fclose (output);
+  return 0;
+}
@@ -0,0 +1,80 @@
+#ifndef BKNF_H_INCLUDED
+#define BKNF_H_INCLUDED
+
+// Encoding of numbers and literals in binary KNF (see 'Binary KNF format'
+// in the top-level README).  Numbers are 7-bit varints (as in binary
+// DRAT), literals are mapped to 'u = 2*var + sign' and stored as zig-zag
+// encoded delta to the previous literal of the same constraint.
+//
+// Shared by the tools, the extractor and the solver, which read and write
+// bytes differently, thus varints are decoded byte by byte and encoded to
+// a small buffer.  Works in C and C++.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <limits.h>
+
+#define BKNF_VERSION     1
+
+#define BKNF_CLAUSE      0      // record types (lower two bits)
+#define BKNF_CARDINALITY 1
+#define BKNF_GUARDED     2
+#define BKNF_COMMENT     3
+#define BKNF_ENCODING    4      // flag marking encoding constraints ('e')
+
+#define BKNF_MAX_VARINT  10     // bytes of a 64-bit varint
+
+// Writes the varint 'x' to 'buf' with at least 'pad' bytes (redundant
+// continuation bytes reserve space for rewriting it) and returns the
+// number of bytes written.
+
+static inline unsigned bknf_put_varint (unsigned char *buf, uint64_t x,
+                                        unsigned pad) {
+  unsigned n = 0;
+  while ((x & ~(uint64_t) 0x7f) || n + 1 < pad) {
+    buf[n++] = (x & 0x7f) | 0x80;
+    x >>= 7;
+  }
+  buf[n++] = x;
+  return n;
+}
+
+// Adds the byte 'ch' of a varint to 'res' where 'shift' (both start with
+// zero) is the position of the byte.  Returns 1 if more bytes follow, 0
+// after the last byte and -1 if the number exceeds 64 bits.
+
+static inline int bknf_get_varint (uint64_t *res, unsigned *shift, int ch) {
+  if (*shift > 63 || (*shift == 63 && (ch & 0x7e))) return -1;
+  *res |= (uint64_t) (ch & 0x7f) << *shift;
+  *shift += 7;
+  return (ch & 0x80) != 0;
+}
+
+// Zig-zag encoded delta of 'lit' to the previous literal 'prev' (zero for
+// the first literal), which is updated.
+
+static inline uint64_t bknf_delta (uint64_t *prev, int lit) {
+  uint64_t u = 2 * (uint64_t) abs (lit) + (lit < 0), zigzag;
+  if (u >= *prev) zigzag = 2 * (u - *prev);
+  else zigzag = 2 * (*prev - u) - 1;
+  *prev = u;
+  return zigzag;
+}
+
+// Inverse of 'bknf_delta', which returns zero if 'zigzag' does not give
+// a literal, i.e., the delta is out of range or the variable is zero.
+
+static inline int bknf_undelta (uint64_t *prev, uint64_t zigzag) {
+  uint64_t delta = zigzag >> 1, u;
+  if (zigzag & 1) {
+    if (delta >= *prev) return 0;
+    u = *prev - delta - 1;
+  } else {
+    if (delta > 2 * (uint64_t) INT_MAX + 1 - *prev) return 0;
+    u = *prev + delta;
+  }
+  *prev = u;
+  return (u & 1) ? -(int) (u >> 1) : (int) (u >> 1);
+}
+
+#endif
@@ -4,3 +4,4 @@ make
 (cd drat-trim; make)
 (cd cadical; ./configure && make)
 (cd check-sat; sh build.sh)
+(cd ccdcl; sh build.sh)
@@ -0,0 +1,6 @@
+#!/bin/sh
+
+# build driver (after the solver and the extractor library)
+SOLVER=../../cardinality-cadical
+EXTRACTOR=../../Extractor/cnf2knf
+g++ --std=c++11 -O2 -pthread -I$SOLVER/src -I$EXTRACTOR/src -I$EXTRACTOR/tbuddy -I.. ccdcl.cpp $EXTRACTOR/src/libcnf2knf.a $EXTRACTOR/tbuddy/tbuddy.a $SOLVER/build/libcadical.a -lz -lbz2 -llzma -o ccdcl
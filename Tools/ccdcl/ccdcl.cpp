@@ -0,0 +1,506 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cinttypes>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "cadical.hpp"
+#include "cnf2knf.hpp"
+#include "../check-sat/knf-parse.hpp"
+#include "../check-sat/reconstruct.hpp"
+#include "portfolio.hpp"
+#include "cubes.hpp"
+
+/*
+
+Input : CNF or KNF formula (possibly compressed or binary KNF)
+
+Run: ./ccdcl [options] <FORMULA>
+
+Runs the stages of 'Scripts/ccdcl.sh', 'Scripts/ccdclPlus.sh' and
+'Scripts/ReEncode.sh' in one process without intermediate files:
+
+  1. unit propagation on a CNF (as 'cadical -c 0' in the scripts)
+  2. extraction of cardinality constraints from the CNF ('libcnf2knf.a')
+  3. solving the KNF with the cardinality solver ('libcadical.a'), where
+     '-mode plus' adds the clausal encoding and keeps the constraints
+     ('--ccdclMode=1 --ccdclEncoding=3') and '-mode reencode' replaces the
+     constraints by their encoding ('--ccdclEncoding=1'), with
+     '-portfolio <n>' by diversified solvers on 'n' threads sharing short
+     learned clauses (see 'portfolio.hpp'), and with '-cubes <n>' by
+     cube-and-conquer over 'n' counters of the cardinality constraints
+     (see 'cubes.hpp')
+  4. the values of the encoding variables eliminated by the extraction
+     are reconstructed (see '../check-sat/reconstruct.hpp'), such that the
+     model satisfies the input formula
+  5. with '-check' the result is verified, a model against the extracted
+     and the input formula and a proof by 'drat-trim' (CNF, the proof is written against
+     the original formula) or 'veripb' (KNF) on '-proof <file>'
+
+A KNF input (with cardinality constraints) is solved directly.  Each stage
+reports its time.
+
+*/
+
+using namespace std;
+
+// The input formula, clauses and cardinality constraints kept separately.
+
+class Formula : public KnfParserObserver {
+public:
+
+  struct Constraint {
+    int bound;
+    int guard;
+    vector<int> lits;
+  };
+
+  int max_var = 0;
+  cnf2knf::Clause_store clauses;
+  vector<Constraint> constraints;
+
+  void Header (int max_var, int max_cls, int max_weight) override {
+    this->max_var = max_var;
+    clauses.reserve (max_cls);
+  }
+
+  void Clause (vector<int>& clause, double weight, string s_weight) override {
+    clauses.add (clause);
+  }
+
+  void CardinalityConstraint (vector<int>& lits, int bound, double weight, string s_weight, int guard) override {
+    if (bound == 1 && !guard) clauses.add (lits);
+    else constraints.push_back (Constraint {bound, guard, lits});
+  }
+
+  bool satisfied (const vector<int> & values) const {
+    auto is_true = [&] (int lit) { return values[abs (lit)] == (lit < 0 ? -1 : 1); };
+    for (int i = 0; i < clauses.size (); i++) {
+      bool sat = false;
+      for (auto lit : clauses.literals_of (i)) if (is_true (lit)) { sat = true; break; }
+      if (!sat) return false;
+    }
+    for (const auto & constraint : constraints) {
+      if (constraint.guard && is_true (constraint.guard)) continue;
+      int count = 0;
+      for (auto lit : constraint.lits) count += is_true (lit);
+      if (count < constraint.bound) return false;
+    }
+    return true;
+  }
+};
+
+class Stage_timer {
+public:
+  chrono::steady_clock::time_point start, last;
+  Stage_timer () { start = last = chrono::steady_clock::now (); }
+  void report (const char * stage) {
+    auto now = chrono::steady_clock::now ();
+    printf ("c %s seconds: %.3f\n", stage, chrono::duration<double> (now - last).count ());
+    fflush (stdout);
+    last = now;
+  }
+  void total () {
+    printf ("c Total seconds: %.3f\n", chrono::duration<double> (chrono::steady_clock::now () - start).count ());
+  }
+};
+
+/*
+
+  Unit propagation on the clauses of 'formula'.  Returns false on a
+  conflict, otherwise adds the reduced formula to 'extractor': the clauses
+  not satisfied without their false literals followed by the units.
+
+*/
+bool propagate (Formula & formula, cnf2knf::Cnf_extractor & extractor, int & nunits) {
+  cnf2knf::Clause_store & clauses = formula.clauses;
+  vector<int> values (formula.max_var + 1, 0);
+  vector<int> trail;
+  auto value = [&] (int lit) { return lit < 0 ? -values[-lit] : values[lit]; };
+  auto assign = [&] (int lit) { values[abs (lit)] = lit < 0 ? -1 : 1; trail.push_back (lit); };
+
+  clauses.build_occurrences ();
+  for (int i = 0; i < clauses.size (); i++) {
+    if (clauses.get_size (i) == 0) return false;
+    if (clauses.get_size (i) > 1) continue;
+    int lit = clauses.literals_of (i)[0];
+    if (value (lit) < 0) return false;
+    if (!value (lit)) assign (lit);
+  }
+  for (size_t next = 0; next < trail.size (); next++) {
+    for (auto cls_idx : clauses.occurrences_of (-trail[next])) {
+      int unassigned = 0, last = 0;
+      bool sat = false;
+      for (auto lit : clauses.literals_of (cls_idx)) {
+        int v = value (lit);
+        if (v > 0) { sat = true; break; }
+        if (!v) { unassigned++; last = lit; }
+      }
+      if (sat) continue;
+      if (!unassigned) return false;
+      if (unassigned == 1) assign (last);
+    }
+  }
+
+  vector<int> reduced;
+  for (int i = 0; i < clauses.size (); i++) {
+    reduced.clear ();
+    bool sat = false;
+    for (auto lit : clauses.literals_of (i)) {
+      int v = value (lit);
+      if (v > 0) { sat = true; break; }
+      if (!v) reduced.push_back (lit);
+    }
+    if (!sat) extractor.add_clause (reduced);
+  }
+  for (auto lit : trail) extractor.add_clause (vector<int> {lit});
+  nunits = trail.size ();
+  return true;
+}
+
+// The model of the solver satisfies the klauses and the kept clauses.
+bool satisfies_extracted (const cnf2knf::Cnf_extractor & extractor,
+                          const cnf2knf::Extraction_result & extracted, const vector<int> & values) {
+  auto is_true = [&] (int lit) { return values[abs (lit)] == (lit < 0 ? -1 : 1); };
+  for (const auto & klause : extracted.klauses) {
+    int count = 0;
+    for (auto lit : klause.literals) count += is_true (lit);
+    if (count < klause.cardinality_bound) return false;
+  }
+  for (int i = 0; i < extractor.clauses.size (); i++) {
+    if (extractor.clauses.is_deleted (i)) continue;
+    bool sat = false;
+    for (auto lit : extractor.clauses.literals_of (i)) if (is_true (lit)) { sat = true; break; }
+    if (!sat) return false;
+  }
+  return true;
+}
+
+void add_constraint (CaDiCaL::Solver & solver, int bound, int guard, const vector<int> & lits) {
+  if (bound == 1 && !guard) {
+    for (auto lit : lits) solver.add (lit);
+    solver.add (0);
+    return;
+  }
+  solver.CARadd (bound);
+  if (guard) solver.CARaddGuard (guard);
+  for (auto lit : lits) solver.CARadd (lit);
+  solver.CARadd (0);
+}
+
+// Runs an external proof checker on 'args' (without a shell), which
+// succeeds if it exits with status '0' and prints a line containing
+// 'success' (if not empty).
+bool run_checker (const vector<string> & args, const char * success) {
+  int fds[2];
+  if (pipe (fds)) return false;
+  pid_t pid = fork ();
+  if (pid < 0) { close (fds[0]); close (fds[1]); return false; }
+  if (!pid) {
+    dup2 (fds[1], 1);
+    close (fds[0]);
+    close (fds[1]);
+    vector<char *> argv;
+    for (const auto & arg : args) argv.push_back ((char *) arg.c_str ());
+    argv.push_back (0);
+    execvp (argv[0], argv.data ());
+    _exit (127);
+  }
+  close (fds[1]);
+  FILE * output = fdopen (fds[0], "r");
+  bool printed = !*success;
+  char line[4096];
+  while (output && fgets (line, sizeof line, output))
+    if (*success && strstr (line, success)) printed = true;
+  if (output) fclose (output); else close (fds[0]);
+  int status;
+  if (waitpid (pid, &status, 0) != pid) return false;
+  if (WIFEXITED (status) && WEXITSTATUS (status) == 127)
+    cout << "c could not run '" << args[0] << "'" << endl;
+  return printed && WIFEXITED (status) && !WEXITSTATUS (status);
+}
+
+char * commandLineParseOption (char ** start, char ** end, const string & marker, bool &found) {
+  char ** position = find (start, end, marker);
+  found = (position != end);
+  if (!found || ++position == end) return 0;
+  return *position;
+}
+
+void printHelp () {
+  cout << "ccdcl: propagate, extract, solve and check in one process." << endl;
+  cout << "Run: ./ccdcl [options] <CNF or KNF>" << endl;
+  cout << "-mode <ccdcl|plus|reencode>  (default ccdcl, see 'Scripts/<mode>.sh')" << endl;
+  cout << "-t <float>                   (solver time limit in seconds, default none)" << endl;
+  cout << "-extract_timeout <float>     (extraction time limit in seconds, default none)" << endl;
+  cout << "-threads <int>               (extraction and cube threads, default all cores)" << endl;
+  cout << "-portfolio <int>             (solver threads with diversified options, default 1)" << endl;
+  cout << "-share_size <int>            (share learned clauses up to this size in the portfolio, default 8, 0 disables)" << endl;
+  cout << "-cubes <int>                 (split on this many constraint counters, solving 2^n cubes, default 0)" << endl;
+  cout << "-proof <file>                (write proof, DRAT for CNF and VeriPB for KNF with -check)" << endl;
+  cout << "-check                       (verify the model or the proof)" << endl;
+  cout << "-drat_trim <path>            (default Tools/drat-trim/drat-trim)" << endl;
+  cout << "-veripb <path>               (default veripb)" << endl;
+  cout << "-n                           (do not print the model)" << endl;
+  exit (0);
+}
+
+int main (int argc, char * argv[]) {
+
+  if (argc < 2 || !strcmp (argv[1], "-h")) printHelp ();
+
+  bool found, check, no_witness;
+  char * opt;
+  string mode = "ccdcl", proof_path, drat_trim = "Tools/drat-trim/drat-trim", veripb = "veripb";
+  double time_limit = 0;
+  int nworkers = 1, share_size = 8, nsplits = 0;
+  string extract_timeout = "0", threads = "0";
+
+  if ((opt = commandLineParseOption (argv, argv + argc, "-mode", found))) mode = opt;
+  if ((opt = commandLineParseOption (argv, argv + argc, "-t", found))) time_limit = atof (opt);
+  if ((opt = commandLineParseOption (argv, argv + argc, "-extract_timeout", found))) extract_timeout = opt;
+  if ((opt = commandLineParseOption (argv, argv + argc, "-threads", found))) threads = opt;
+  if ((opt = commandLineParseOption (argv, argv + argc, "-portfolio", found))) nworkers = atoi (opt);
+  if ((opt = commandLineParseOption (argv, argv + argc, "-share_size", found))) share_size = atoi (opt);
+  if ((opt = commandLineParseOption (argv, argv + argc, "-cubes", found))) nsplits = atoi (opt);
+  if ((opt = commandLineParseOption (argv, argv + argc, "-proof", found))) proof_path = opt;
+  if ((opt = commandLineParseOption (argv, argv + argc, "-drat_trim", found))) drat_trim = opt;
+  if ((opt = commandLineParseOption (argv, argv + argc, "-veripb", found))) veripb = opt;
+  commandLineParseOption (argv, argv + argc, "-check", check);
+  commandLineParseOption (argv, argv + argc, "-n", no_witness);
+
+  if (mode != "ccdcl" && mode != "plus" && mode != "reencode") {
+    cout << "ERROR unknown mode " << mode << endl;
+    return 1;
+  }
+  if ((nworkers > 1 || nsplits > 0) && !proof_path.empty ()) {
+    cout << "ERROR proofs are not supported with -portfolio or -cubes (shared clauses are not derived)" << endl;
+    return 1;
+  }
+  if (nworkers > 1 && nsplits > 0) {
+    cout << "ERROR -portfolio and -cubes can not be combined" << endl;
+    return 1;
+  }
+  if (nsplits > 20) {
+    cout << "ERROR at most 20 splitting variables (2^20 cubes)" << endl;
+    return 1;
+  }
+  if (!proof_path.empty ()) {
+    FILE * proof_file = fopen (proof_path.c_str (), "w");
+    if (!proof_file) {
+      cout << "ERROR could not open " << proof_path << " for writing" << endl;
+      return 1;
+    }
+    fclose (proof_file);
+  }
+
+  // The input is the only argument which is neither an option nor its value.
+  const vector<string> valued = { "-mode", "-t", "-extract_timeout", "-threads", "-portfolio",
+                                  "-share_size", "-cubes", "-proof", "-drat_trim", "-veripb" };
+  string input_path;
+  for (int i = 1; i < argc; i++) {
+    const string arg = argv[i];
+    if (find (valued.begin (), valued.end (), arg) != valued.end ()) {
+      if (++i == argc) {
+        cout << "ERROR missing value of " << arg << endl;
+        return 1;
+      }
+    } else if (arg == "-check" || arg == "-n") continue;
+    else if (arg[0] == '-' && arg.size () > 1) {
+      cout << "ERROR unknown option " << arg << " (see -h)" << endl;
+      return 1;
+    } else if (!input_path.empty ()) {
+      cout << "ERROR more than one input formula (" << input_path << " and " << arg << ")" << endl;
+      return 1;
+    } else input_path = arg;
+  }
+  if (input_path.empty ()) {
+    cout << "ERROR no input formula (see -h)" << endl;
+    return 1;
+  }
+
+  Stage_timer timer;
+
+  // Parse
+
+  Formula formula;
+  PlainTextKnfParser text_parser;
+  BinaryKnfParser binary_parser;
+  KnfParser & knf_parser = BinaryKnfParser::IsBinary (input_path) ?
+    (KnfParser &) binary_parser : (KnfParser &) text_parser;
+  knf_parser.AddObserver (&formula);
+  try {
+    knf_parser.Parse (input_path, UNKNOWN);
+  } catch (const string & error) {
+    cout << "ERROR " << error << endl;
+    return 1;
+  }
+  bool cnf_input = formula.constraints.empty ();
+  timer.report ("Parse");
+
+  // Propagate and extract (CNF input only)
+
+  cnf2knf::Cnf_extractor extractor;
+  cnf2knf::Extraction_result extracted;
+  bool conflict = false;
+  if (cnf_input) {
+    int nunits = 0;
+    conflict = !propagate (formula, extractor, nunits);
+    printf ("c Propagated units: %d%s\n", nunits, conflict ? " (conflict)" : "");
+    timer.report ("Propagate");
+    if (!conflict) {
+      extractor.extractor_options["Timeout"] = extract_timeout;
+      extractor.extractor_options["Threads"] = threads;
+      extracted = extractor.extract ();
+      printf ("c Extracted constraints: %zu\n", extracted.klauses.size ());
+      printf ("c Replaced clauses: %zu\n", extracted.replaced_clauses.size ());
+      printf ("c Eliminated variables: %zu\n", extracted.eliminated_variables.size ());
+      timer.report ("Extract");
+    }
+  }
+
+  // Solve
+
+  Portfolio portfolio (nworkers, formula.max_var, share_size);
+  auto setup = [&] (CaDiCaL::Solver & solver) {
+    if (mode == "plus") { solver.set ("ccdclMode", 1); solver.set ("ccdclEncoding", 3); }
+    else if (mode == "reencode") solver.set ("ccdclEncoding", 1);
+    if (!proof_path.empty ()) {
+      if (!cnf_input && check) solver.set ("veripb", 1);
+      solver.trace_proof (proof_path.c_str ());
+    }
+  };
+  auto load = [&] (CaDiCaL::Solver & solver) {
+    solver.reserve (formula.max_var);
+    if (cnf_input && !conflict) {
+      for (const auto & klause : extracted.klauses)
+        add_constraint (solver, klause.cardinality_bound, 0, klause.literals);
+      for (int i = 0; i < extractor.clauses.size (); i++) {
+        if (extractor.clauses.is_deleted (i)) continue;
+        for (auto lit : extractor.clauses.literals_of (i)) solver.add (lit);
+        solver.add (0);
+      }
+    } else {
+      for (int i = 0; i < formula.clauses.size (); i++) {
+        for (auto lit : formula.clauses.literals_of (i)) solver.add (lit);
+        solver.add (0);
+      }
+      for (const auto & constraint : formula.constraints)
+        add_constraint (solver, constraint.bound, constraint.guard, constraint.lits);
+    }
+  };
+
+  Cube_and_conquer cubes (atoi (threads.c_str ()), formula.max_var, share_size);
+  if (nsplits > 0 && !conflict) {
+    vector<pair<int, vector<int>>> constraints;
+    if (cnf_input)
+      for (const auto & klause : extracted.klauses)
+        constraints.push_back ({klause.cardinality_bound, klause.literals});
+    else
+      for (const auto & constraint : formula.constraints)
+        if (!constraint.guard) constraints.push_back ({constraint.bound, constraint.lits});
+    cubes.choose_splits (constraints, nsplits);
+    printf ("c Splitting variables: %zu\n", cubes.splits.size ());
+    if (cubes.cubes ()) printf ("c Cubes: %d on %d threads\n", cubes.cubes (), cubes.threads ());
+    else printf ("c No counters to split on (constraints 'k of n' with 2 < k < n-1)\n");
+  }
+
+  int res;
+  if (cubes.cubes ()) res = cubes.solve (setup, load, add_constraint, time_limit);
+  else res = portfolio.solve (setup, load, time_limit);
+  CaDiCaL::Solver & solver = cubes.started () ? cubes.solver () : portfolio.solver ();
+  if (!proof_path.empty ()) solver.close_proof_trace ();
+  if (nworkers > 1) {
+    if (portfolio.winner >= 0)
+      printf ("c Portfolio winner: %d (%s)\n", portfolio.winner, Portfolio::config_name (portfolio.winner).c_str ());
+    printf ("c Portfolio exported clauses: %" PRId64 "\n", portfolio.exported);
+    printf ("c Portfolio imported clauses: %" PRId64 "\n", portfolio.imported);
+  }
+  if (cubes.cubes ()) {
+    printf ("c Cubes refuted: %" PRId64 "\n", cubes.refuted);
+    printf ("c Cubes pruned by failed assumptions: %" PRId64 "\n", cubes.pruned);
+    printf ("c Cubes unknown: %" PRId64 "\n", cubes.unknown);
+    printf ("c Cubes exported clauses: %" PRId64 "\n", cubes.exported);
+    printf ("c Cubes imported clauses: %" PRId64 "\n", cubes.imported);
+  }
+  timer.report ("Solve");
+
+  // Check and print the result
+
+  vector<int> values (formula.max_var + 1, 0);
+  bool refuted = false;   // by a failed check
+  if (res == 10) {
+    for (int v = 1; v <= formula.max_var; v++) values[v] = solver.val (v) > 0 ? 1 : -1;
+    bool verified = true;
+    if (check && cnf_input && !conflict) {
+      verified = satisfies_extracted (extractor, extracted, values);
+      if (!verified) cout << "c NOT satisfying the extracted formula" << endl;
+    }
+    if (cnf_input && !conflict) {
+      // Eliminated encoding variables do not occur in the extracted formula.
+      vector<vector<int>> eliminated_clauses;
+      vector<char> eliminated (formula.max_var + 1, 0);
+      for (auto v : extracted.eliminated_variables) eliminated[v] = 1;
+      for (int i = 0; i < formula.clauses.size (); i++)
+        for (auto lit : formula.clauses.literals_of (i))
+          if (eliminated[abs (lit)]) {
+            auto lits = formula.clauses.literals_of (i);
+            eliminated_clauses.push_back (vector<int> (lits.begin (), lits.end ()));
+            break;
+          }
+      Reconstruction reconstruction (eliminated_clauses, values);
+      if (!reconstruction.run (extracted.eliminated_variables))
+        cout << "c NOT reconstructed eliminated variables" << endl;
+      timer.report ("Reconstruct");
+    }
+    if (check) {
+      verified = verified && formula.satisfied (values);
+      if (verified) cout << "c Verified SAT on the input formula" << endl;
+      else cout << "c NOT VERIFIED SAT" << endl, refuted = true;
+    }
+  } else if (res == 20 && check) {
+    bool verified = false;
+    if (proof_path.empty ()) cout << "c UNSAT check needs -proof <file>" << endl;
+    else if (cnf_input) {
+      verified = run_checker ({drat_trim, input_path, proof_path}, "s VERIFIED");
+      if (verified) cout << "c Verified UNSAT with drat-trim on the input formula" << endl;
+    } else {
+      verified = run_checker ({veripb, proof_path + ".opb", proof_path}, "");
+      if (verified) cout << "c Verified UNSAT with VeriPB on the input formula" << endl;
+    }
+    if (!verified && !proof_path.empty ()) cout << "c NOT VERIFIED UNSAT" << endl, refuted = true;
+  }
+  if (check) timer.report ("Check");
+
+  solver.statistics ();
+  timer.total ();
+
+  // A result which failed its check is not reported as an answer.
+  if (refuted) {
+    cout << "c ERROR the result failed its check" << endl;
+    cout << "s UNKNOWN" << endl;
+    return 1;
+  }
+
+  if (res == 10) {
+    cout << "s SATISFIABLE" << endl;
+    if (!no_witness) {
+      string line = "v";
+      for (int v = 1; v <= formula.max_var; v++) {
+        string lit = " " + to_string (values[v] * v);
+        if (line.size () + lit.size () > 78) { cout << line << endl; line = "v"; }
+        line += lit;
+      }
+      cout << line << " 0" << endl;
+    }
+  } else if (res == 20) cout << "s UNSATISFIABLE" << endl;
+  else cout << "s UNKNOWN" << endl;
+
+  return res;
+}
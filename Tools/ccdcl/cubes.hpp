@@ -0,0 +1,207 @@
+#ifndef CUBES_HPP
+#define CUBES_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "cadical.hpp"
+#include "thread_pool.hpp"
+#include "portfolio.hpp"
+
+/*
+
+Cube-and-conquer over the counters of cardinality constraints, replacing
+'cardinality-splitting/totalizer_splitting.py' (splitting variables) and
+'solve-icnf.sh' (one solver per cube).
+
+Splitting variables are chosen as in 'totalizer_splitting.py' from the
+nodes of a totalizer tree over the literals of a constraint 'k of n',
+starting at depth two, with the counter of a node with 's' literals near
+the proportion 'k/n' of the constraint.  Instead of encoding the tree, the
+splitting variable 'y' of a node 'S' with counter 'j' is defined as the
+partial sum 'y <-> at least j of S' by two guarded cardinality constraints,
+'at least j of S' guarded by '-y' and 'at least s-j+1 of -S' guarded by 'y'.
+
+The '2^n' cubes over 'n' splitting variables are solved under assumptions
+on a thread pool.  Every thread loads the formula once into its own solver,
+which is reused incrementally for all its cubes, and short learned clauses
+are shared between the threads as in the portfolio.  The failed assumptions
+of a refuted cube refute all cubes containing them, which are skipped.  A
+satisfiable cube stops all threads.
+
+*/
+
+class Cube_and_conquer {
+public:
+
+  struct Split {
+    int var, bound;
+    vector<int> lits;
+  };
+
+  vector<Split> splits;
+  int winner = -1;
+  int64_t refuted = 0, pruned = 0, unknown = 0;
+  int64_t exported = 0, imported = 0;
+
+  Cube_and_conquer (int nthreads, int max_var, int share_size) :
+    pool (nthreads), max_var (max_var), share_size (share_size),
+    exchange (pool.size (), 1 << 20), solvers (pool.size ()) { }
+
+  int threads () const { return pool.size (); }
+
+  // Chooses up to 'nsplits' splitting variables from the (unguarded)
+  // constraints 'bound' of 'lits', numbered after 'max_var'.
+  void choose_splits (const vector<pair<int, vector<int>>> & constraints, int nsplits) {
+    vector<const pair<int, vector<int>> *> candidates;
+    for (const auto & constraint : constraints) {
+      int n = constraint.second.size (), k = constraint.first;
+      if (k > 2 && k < n - 1) candidates.push_back (&constraint);  // not AL2 or AMO
+    }
+    if (candidates.empty () || nsplits <= 0) return;
+    int per_constraint = max (1, nsplits / (int) candidates.size ());
+    for (auto constraint : candidates) {
+      const vector<int> & lits = constraint->second;
+      double percent = (double) constraint->first / lits.size ();
+      // nodes of the tree as ranges of 'lits' (halves of their parents)
+      vector<pair<int, int>> layer = { {0, (int) lits.size ()} }, next;
+      int chosen = 0;
+      bool round_up = true;
+      for (int depth = 0; chosen < per_constraint && (int) splits.size () < nsplits; depth++) {
+        if (depth >= 2) {
+          vector<pair<int, int>> nodes = layer;
+          stable_sort (nodes.begin (), nodes.end (), [] (const pair<int, int> & a, const pair<int, int> & b) {
+            return a.second - a.first > b.second - b.first;
+          });
+          for (const auto & node : nodes) {
+            int size = node.second - node.first;
+            if (size < 2) continue;
+            int bound = min (size, (int) (size * percent) + 1 + round_up);
+            round_up = !round_up;
+            splits.push_back (Split {max_var + (int) splits.size () + 1, bound,
+                                     vector<int> (lits.begin () + node.first, lits.begin () + node.second)});
+            if (++chosen == per_constraint || (int) splits.size () == nsplits) break;
+          }
+        }
+        next.clear ();
+        for (const auto & node : layer) {
+          int mid = (node.first + node.second) / 2;
+          if (node.second - node.first < 2) continue;
+          next.push_back ({node.first, mid});
+          next.push_back ({mid, node.second});
+        }
+        if (next.empty ()) break;
+        layer.swap (next);
+      }
+      if ((int) splits.size () == nsplits) break;
+    }
+  }
+
+  int cubes () const { return splits.empty () ? 0 : 1 << splits.size (); }
+
+  // 'setup' sets the options of the mode, 'load' adds the formula and
+  // 'add_constraint' the definitions of the splitting variables.
+  int solve (const function<void (CaDiCaL::Solver &)> & setup,
+             const function<void (CaDiCaL::Solver &)> & load,
+             const function<void (CaDiCaL::Solver &, int, int, const vector<int> &)> & add_constraint,
+             double time_limit) {
+    atomic<bool> done (false), unsat (false);
+    atomic<int> first (-1);
+    atomic<int64_t> nrefuted (0), npruned (0), nunknown (0);
+    vector<unique_ptr<Portfolio_terminator>> terminators;
+    vector<unique_ptr<Clause_sharing>> sharing;
+    for (int w = 0; w < pool.size (); w++) {
+      terminators.emplace_back (new Portfolio_terminator (done, time_limit));
+      sharing.emplace_back (new Clause_sharing (exchange, w, max_var, share_size));
+    }
+    mutex failed_lock;
+    vector<vector<int>> failed;   // refuting subsets of cubes
+
+    pool.run (cubes (), [&] (size_t cube_idx, int w) {
+      if (done) { nunknown++; return; }
+      if (!solvers[w]) {
+        solvers[w].reset (new CaDiCaL::Solver);
+        CaDiCaL::Solver & solver = *solvers[w];
+        solver.connect_terminator (terminators[w].get ());
+        setup (solver);
+        if (pool.size () > 1 && share_size > 0) {
+          solver.connect_learner (sharing[w].get ());
+          solver.connect_importer (sharing[w].get ());
+        }
+        solver.reserve (max_var + splits.size ());
+        load (solver);
+        for (const auto & split : splits) {
+          add_constraint (solver, split.bound, -split.var, split.lits);
+          vector<int> negated;
+          for (auto lit : split.lits) negated.push_back (-lit);
+          add_constraint (solver, split.lits.size () - split.bound + 1, split.var, negated);
+        }
+      }
+      CaDiCaL::Solver & solver = *solvers[w];
+      vector<int> cube;
+      for (size_t i = 0; i < splits.size (); i++)
+        cube.push_back ((cube_idx >> i) & 1 ? -splits[i].var : splits[i].var);
+      {
+        lock_guard<mutex> guard (failed_lock);
+        for (const auto & subset : failed) {
+          bool contained = true;
+          for (auto lit : subset)
+            if (find (cube.begin (), cube.end (), lit) == cube.end ()) { contained = false; break; }
+          if (contained) { npruned++; return; }
+        }
+      }
+      for (auto lit : cube) solver.assume (lit);
+      int res = solver.solve ();
+      if (res == 10) {
+        int none = -1;
+        first.compare_exchange_strong (none, w);
+        done = true;
+      } else if (res == 20) {
+        nrefuted++;
+        vector<int> subset;
+        for (auto lit : cube) if (solver.failed (lit)) subset.push_back (lit);
+        if (subset.empty ()) { unsat = true; done = true; }
+        else {
+          lock_guard<mutex> guard (failed_lock);
+          failed.push_back (subset);
+        }
+      } else nunknown++;
+    });
+
+    for (int w = 0; w < pool.size (); w++) {
+      if (solvers[w]) solvers[w]->disconnect_terminator ();
+      exported += sharing[w]->exported;
+      imported += sharing[w]->imported;
+    }
+    refuted = nrefuted, pruned = npruned, unknown = nunknown;
+    winner = first;
+    if (winner >= 0) return 10;
+    if (unsat || refuted + pruned == cubes ()) return 20;
+    return 0;
+  }
+
+  // The solver of the satisfiable cube, otherwise the first one.
+  CaDiCaL::Solver & solver () {
+    if (winner >= 0) return *solvers[winner];
+    for (auto & solver : solvers) if (solver) return *solver;
+    return *solvers[0];
+  }
+
+  bool started () const {
+    for (auto & solver : solvers) if (solver) return true;
+    return false;
+  }
+
+private:
+
+  cnf2knf::Thread_pool pool;
+  int max_var, share_size;
+  Clause_exchange exchange;
+  vector<unique_ptr<CaDiCaL::Solver>> solvers;
+};
+
+#endif
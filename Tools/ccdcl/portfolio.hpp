@@ -0,0 +1,251 @@
+#ifndef PORTFOLIO_HPP
+#define PORTFOLIO_HPP
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdlib.h>
+
+#include "cadical.hpp"
+
+/*
+
+Runs diversified instances of the cardinality solver on threads.  The
+formula is given by the caller, which configures and loads each solver
+(from a formula parsed once), and all solvers stop as soon as one of them
+finishes.
+
+Learned clauses up to 'share_size' literals (including units) over the
+variables of the input formula are shared.  Every worker appends its
+clauses to its own ring buffer, which the others read without locks at
+their restarts (see 'CaDiCaL::Importer').  The writer reserves the range
+it overwrites before writing, thus a reader detects clauses overwritten
+while it read them (as in a sequence lock) and skips them, i.e., a slow
+reader only loses clauses.  Clauses over fresh variables of an encoding
+('-mode plus' and 'reencode') are not shared, since these differ between
+the workers.
+
+*/
+
+using namespace std;
+
+class Clause_exchange {
+public:
+
+  Clause_exchange (int nworkers, size_t capacity) : capacity (capacity), rings (nworkers) {
+    for (auto & ring : rings) {
+      ring.lits.reset (new atomic<int>[capacity]);
+      ring.reserved = ring.end = 0;
+    }
+  }
+
+  int size () const { return rings.size (); }
+
+  // Only called by the worker owning the ring.
+  void publish (int worker, const vector<int> & clause) {
+    Ring & ring = rings[worker];
+    uint64_t end = ring.end.load (memory_order_relaxed);
+    ring.reserved.store (end + clause.size () + 1, memory_order_relaxed);
+    atomic_thread_fence (memory_order_release);
+    for (auto lit : clause) ring.lits[end++ % capacity].store (lit, memory_order_relaxed);
+    ring.lits[end++ % capacity].store (0, memory_order_relaxed);
+    ring.end.store (end, memory_order_release);
+  }
+
+  // Reads the next clause of 'worker' at 'position' (of the reader).
+  bool read (int worker, uint64_t & position, vector<int> & clause) {
+    Ring & ring = rings[worker];
+    for (;;) {
+      uint64_t end = ring.end.load (memory_order_acquire);
+      if (position >= end) return false;
+      bool lost = false;
+      if (end - position > capacity) position = end - capacity, lost = true;
+      uint64_t start = position;
+      clause.clear ();
+      while (position < end) {
+        int lit = ring.lits[position++ % capacity].load (memory_order_relaxed);
+        if (!lit) break;
+        clause.push_back (lit);
+      }
+      atomic_thread_fence (memory_order_acquire);
+      // The first clause after losing some might be a suffix.
+      if (!lost && ring.reserved.load (memory_order_relaxed) - start <= capacity) return true;
+    }
+  }
+
+private:
+
+  struct Ring {
+    unique_ptr<atomic<int>[]> lits;
+    atomic<uint64_t> reserved, end;
+  };
+
+  size_t capacity;
+  vector<Ring> rings;
+};
+
+// Exports the learned clauses of a worker and imports those of the others.
+
+class Clause_sharing : public CaDiCaL::Learner, public CaDiCaL::Importer {
+public:
+
+  int64_t exported = 0, imported = 0;
+
+  Clause_sharing (Clause_exchange & exchange, int worker, int max_var, int share_size) :
+    exchange (exchange), worker (worker), max_var (max_var), share_size (share_size),
+    positions (exchange.size (), 0) { }
+
+  bool learning (int size) override { return size > 0 && size <= share_size; }
+
+  void learn (int lit) override {
+    if (lit) {
+      if (abs (lit) > max_var) skip = true;
+      else learned.push_back (lit);
+      return;
+    }
+    if (!skip) { exchange.publish (worker, learned); exported++; }
+    learned.clear ();
+    skip = false;
+  }
+
+  bool import (vector<int> & clause) override {
+    for (int from = 0; from < exchange.size (); from++) {
+      if (from == worker) continue;
+      if (exchange.read (from, positions[from], clause)) { imported++; return true; }
+    }
+    return false;
+  }
+
+private:
+
+  Clause_exchange & exchange;
+  int worker, max_var, share_size;
+  vector<int> learned;
+  bool skip = false;
+  vector<uint64_t> positions;
+};
+
+// Stops a worker after the time limit or when another one finished.
+
+class Portfolio_terminator : public CaDiCaL::Terminator {
+public:
+  atomic<bool> & done;
+  chrono::steady_clock::time_point deadline;
+  bool limited;
+  Portfolio_terminator (atomic<bool> & done, double seconds) : done (done), limited (seconds > 0) {
+    deadline = chrono::steady_clock::now () +
+      chrono::duration_cast<chrono::steady_clock::duration> (chrono::duration<double> (seconds));
+  }
+  bool terminate () override {
+    return done.load (memory_order_relaxed) || (limited && chrono::steady_clock::now () > deadline);
+  }
+};
+
+// Option variants of the workers on top of the selected mode, where every
+// worker gets its own seed.  Workers beyond these repeat them with the
+// initial phase flipped.  The "hybrid" worker relies on guarded constraints
+// being encoded with their guard, since it does not propagate constraints
+// in the unstable phase and the first worker to finish wins.
+
+struct Portfolio_config {
+  const char * name;
+  vector<pair<const char *, int>> options;
+};
+
+static const vector<Portfolio_config> portfolio_configs = {
+  { "default", { } },
+  { "watch", { {"ccdclWatch", 1} } },
+  { "bump", { {"ccdclBump", 1}, {"ccdclBumpGuard", 1} } },
+  { "hybrid", { {"ccdclMode", 1}, {"ccdclEncoding", 3} } },
+  { "walk-card", { {"ccdclWalkSelect", 1} } },
+  { "walk-clauses", { {"ccdclWalkSelect", 2} } },
+  { "stable", { {"stabilizeonly", 1} } },
+  { "focused", { {"stabilize", 0} } },
+};
+
+class Portfolio {
+public:
+
+  int winner = -1;
+  vector<unique_ptr<CaDiCaL::Solver>> solvers;
+
+  Portfolio (int nworkers, int max_var, int share_size) :
+    nworkers (nworkers > 0 ? nworkers : 1), max_var (max_var), share_size (share_size),
+    exchange (this->nworkers, 1 << 20) {
+    for (int w = 0; w < this->nworkers; w++) solvers.emplace_back (new CaDiCaL::Solver);
+  }
+
+  static string config_name (int worker) {
+    string name = portfolio_configs[worker % portfolio_configs.size ()].name;
+    if (worker >= (int) portfolio_configs.size ()) name += "-" + to_string (worker);
+    return name;
+  }
+
+  static void configure (CaDiCaL::Solver & solver, int worker) {
+    for (const auto & option : portfolio_configs[worker % portfolio_configs.size ()].options)
+      solver.set (option.first, option.second);
+    if (worker) solver.set ("seed", worker);
+    if (worker >= (int) portfolio_configs.size ()) solver.set ("phase", 0);
+  }
+
+  // 'setup' sets the options of the mode, which the variant of the worker
+  // refines, then 'load' adds the formula and all workers solve until the
+  // first one finishes.
+  int solve (const function<void (CaDiCaL::Solver &)> & setup,
+             const function<void (CaDiCaL::Solver &)> & load, double time_limit) {
+    atomic<bool> done (false);
+    atomic<int> first (-1);
+    vector<int> results (nworkers, 0);
+    vector<unique_ptr<Clause_sharing>> sharing;
+    auto work = [&] (int w) {
+      CaDiCaL::Solver & solver = *solvers[w];
+      Portfolio_terminator terminator (done, time_limit);
+      solver.connect_terminator (&terminator);
+      setup (solver);
+      if (nworkers > 1) {
+        configure (solver, w);
+        if (share_size > 0) {
+          solver.connect_learner (sharing[w].get ());
+          solver.connect_importer (sharing[w].get ());
+        }
+      }
+      load (solver);
+      results[w] = solver.solve ();
+      if (results[w]) {
+        int none = -1;
+        first.compare_exchange_strong (none, w);
+        done = true;
+      }
+      solver.disconnect_terminator ();
+    };
+    for (int w = 0; w < nworkers; w++)
+      sharing.emplace_back (new Clause_sharing (exchange, w, max_var, share_size));
+    if (nworkers == 1) work (0);
+    else {
+      vector<thread> threads;
+      for (int w = 0; w < nworkers; w++) threads.push_back (thread (work, w));
+      for (auto & t : threads) t.join ();
+    }
+    for (int w = 0; w < nworkers; w++) {
+      exported += sharing[w]->exported;
+      imported += sharing[w]->imported;
+    }
+    winner = first;
+    return winner < 0 ? 0 : results[winner];
+  }
+
+  CaDiCaL::Solver & solver () { return *solvers[winner < 0 ? 0 : winner]; }
+
+  int64_t exported = 0, imported = 0;
+
+private:
+
+  int nworkers, max_var, share_size;
+  Clause_exchange exchange;
+};
+
+#endif
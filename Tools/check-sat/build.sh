@@ -1,4 +1,4 @@
 #!/bin/sh
 
 # build checker
-g++ --std=c++11 check-sat.cpp -o check-sat
+g++ --std=c++11 check-sat.cpp -lz -lbz2 -llzma -o check-sat
@@ -34,7 +34,9 @@ void printHelp(char ** start, char ** end) {
   if ( position == end ) return;
   
   cout << "check-sat: check if an assignment satisfies a KNF formula." << endl;
-  cout << "Run: ./check-sat <KNF> [<Assignment>] [-convert <File>] [-input_type <UNKNOWN,CNF,KNF,WCNF,WKNF,WCARD,CAI>] [-output_type <UNKNOWN,CNF,KNF,WCNF,WKNF,WCARD,CAI>]" << endl;
+  cout << "Run: ./check-sat <KNF> [<Assignment>] [-convert <File>] [-input_type <UNKNOWN,CNF,KNF,WCNF,WKNF,WCARD,CAI>] [-output_type <UNKNOWN,CNF,KNF,WCNF,WKNF,WCARD,CAI,LSECNF,BKNF>]" << endl;
+  cout << "Binary KNF input (signature 'BKNF') is detected automatically." << endl;
+  cout << "With -eliminated <File> the values of the variables listed in <File> (e.g., encoding variables eliminated by the extractor) are reconstructed first." << endl;
   
   exit (0);
 }
@@ -62,6 +64,9 @@ int main(int argc, char* argv[]) {
 
   commandLineParseOption (argv, argv+argc, "-write_partitions", write_partitions);
 
+  bool reconstruct;
+  char * eliminated_file = commandLineParseOption (argv, argv+argc, "-eliminated", reconstruct);
+
   if (argc < 3 && !convert && !partition) {
     cout << "Error too few arguments: usage is ./check-sat <KNF> [<Assignment>] [options]" << endl;
     exit (1);
@@ -81,7 +86,10 @@ int main(int argc, char* argv[]) {
 
   KnfCheck knfcheck;
 
-  PlainTextKnfParser knf_parser;
+  PlainTextKnfParser text_parser;
+  BinaryKnfParser binary_parser;
+  KnfParser & knf_parser = BinaryKnfParser::IsBinary(knf_path) ?
+    (KnfParser &) binary_parser : (KnfParser &) text_parser;
   knf_parser.AddObserver(&knfcheck);
   knf_parser.Parse(knf_path, input_type);
 
@@ -98,6 +106,9 @@ int main(int argc, char* argv[]) {
 
   cout << "Note, casting all weights to integers\n";
 
+  if (parsed_ass && reconstruct && !knfcheck.reconstructEliminated (eliminated_file))
+    cout << "c NOT reconstructed eliminated variables" << endl;
+
   if (parsed_ass) {
     if (knfcheck.has_weight ()) 
       knfcheck.checkMaxSat();
@@ -110,6 +121,8 @@ int main(int argc, char* argv[]) {
   if (convert) {
     if (output_type == CAI)
       knfcheck.writeCai (convert_file);
+    else if (output_type == BKNF)
+      knfcheck.writeBinaryKnf (convert_file);
     else
       knfcheck.writeKnf (convert_file);
   }
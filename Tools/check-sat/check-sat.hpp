@@ -6,8 +6,10 @@
 #include <vector>
 #include <fstream>
 #include <tuple>
+#include <sstream>
 #include "assert.h"
 #include "knf-parse.hpp"
+#include "reconstruct.hpp"
 
 
 using namespace std;
@@ -340,40 +342,120 @@ public:
  
   }
 
+  /*
+
+    Reconstruct the values of eliminated variables (see 'reconstruct.hpp')
+    listed in 'eliminated_path', either as variable indices or in the
+    extractor statistics ('c Eliminated variables IDs: ...') and the units
+    printed by the solver ('Eliminated Variables ...').
+
+  */
+  bool reconstructEliminated (string eliminated_path) {
+
+    fstream eliminated_file(eliminated_path, ios_base::in);
+
+    if (!eliminated_file) return false;
+
+    vector<int> eliminated;
+    string line, token;
+    while (getline (eliminated_file, line)) {
+      bool listed = isdigit (line[0]) || line.find ("IDs:") != string::npos ||
+                    line.find ("Eliminated Variables") != string::npos;
+      if (!listed) continue;
+      istringstream tokens (line);
+      while (tokens >> token)
+        if (isdigit (token[0])) eliminated.push_back (stoi (token));
+    }
+
+    cout << "c Reconstructing " << eliminated.size () << " eliminated variables" << endl;
+
+    Reconstruction reconstruction (clauses, assignment);
+    return reconstruction.run (eliminated);
+  }
+
   void writeKnf (string out_path) {
 
-    ofstream out_file(out_path);
+    FILE* out_file = zfopen(out_path.c_str(), "w");
+    if (!out_file) {
+      cout << "ERROR can not write to " << out_path << endl;
+      return;
+    }
 
     cout << "writing to " << out_path << endl;
 
-    out_file << "c converted file format" << endl;
+    fputs ("c converted file format\n", out_file);
 
     int new_cls = cardinality_constraints.size() + clauses.size();
 
     cout << "Old header with " << max_cls << " constraints, new header with " << new_cls << " constraints\n";
 
     // write header
-    if (has_weight()) out_file << "p wknf " << max_var << " " << new_cls << " " << max_weight << endl;
-    else out_file << "p knf " << max_var << " " << new_cls << endl;
+    if (has_weight()) fprintf (out_file, "p wknf %d %d %d\n", max_var, new_cls, max_weight);
+    else fprintf (out_file, "p knf %d %d\n", max_var, new_cls);
 
     // write clauses
     for (int i = 0; i < clauses.size(); i++) {
-      if (has_weight()) out_file << clause_s_weights[i] << " ";
-      for (auto lit : clauses[i]) out_file << lit << " ";
-      out_file << "0" << endl;
+      if (has_weight()) fprintf (out_file, "%s ", clause_s_weights[i].c_str());
+      for (auto lit : clauses[i]) fprintf (out_file, "%d ", lit);
+      fputs ("0\n", out_file);
     }
 
     // write cardinality constraints
     for (int i = 0; i < cardinality_constraints.size(); i++) {
-      if (has_weight()) out_file << card_s_weights[i] << " ";
-      auto tpl = cardinality_constraints[i];
-      out_file << "k " << get<1>(tpl) << " ";
-      for (auto lit : get<0>(tpl)) out_file << lit << " ";
-      out_file << "0" << endl;
+      if (has_weight()) fprintf (out_file, "%s ", card_s_weights[i].c_str());
+      auto & tpl = cardinality_constraints[i];
+      fprintf (out_file, "k %d ", get<1>(tpl));
+      for (auto lit : get<0>(tpl)) fprintf (out_file, "%d ", lit);
+      fputs ("0\n", out_file);
     }
 
-    out_file.close ();
+    fclose (out_file);
+
+  }
+
+  // Binary KNF (see 'Binary KNF format' in the top-level README).
+  void writeBinaryKnf (string out_path) {
+
+    if (has_weight()) {
+      cout << "ERROR binary KNF does not support weights" << endl;
+      return;
+    }
+
+    FILE* out_file = zfopen(out_path.c_str(), "wb");
+    if (!out_file) {
+      cout << "ERROR can not write to " << out_path << endl;
+      return;
+    }
+
+    cout << "writing to " << out_path << endl;
+
+    int guarded = 0;
+    for (auto guard : card_guards) if (guard) guarded++;
 
+    vector<unsigned char> buffer = { 'B', 'K', 'N', 'F', BKNF_VERSION };
+    putVarint (buffer, max_var);
+    putVarint (buffer, clauses.size());
+    putVarint (buffer, cardinality_constraints.size() - guarded);
+    putVarint (buffer, guarded);
+
+    for (auto & clause : clauses) {
+      buffer.push_back (BKNF_CLAUSE);
+      putLiterals (buffer, clause);
+    }
+
+    for (int i = 0; i < cardinality_constraints.size(); i++) {
+      auto & tpl = cardinality_constraints[i];
+      buffer.push_back (card_guards[i] ? BKNF_GUARDED : BKNF_CARDINALITY);
+      putVarint (buffer, get<1>(tpl));
+      if (card_guards[i]) {
+        uint64_t prev = 0;
+        putVarint (buffer, bknf_delta (&prev, card_guards[i]));
+      }
+      putLiterals (buffer, get<0>(tpl));
+    }
+
+    fwrite (buffer.data(), 1, buffer.size(), out_file);
+    fclose (out_file);
   }
 
   void writeCai (string out_path) {
@@ -456,6 +538,17 @@ public:
 
 private:
 
+  static void putVarint (vector<unsigned char> & buffer, uint64_t x) {
+    unsigned char bytes[BKNF_MAX_VARINT];
+    buffer.insert (buffer.end (), bytes, bytes + bknf_put_varint (bytes, x, 0));
+  }
+
+  static void putLiterals (vector<unsigned char> & buffer, const vector<int> & lits) {
+    uint64_t prev = 0;
+    putVarint (buffer, lits.size());
+    for (auto lit : lits) putVarint (buffer, bknf_delta (&prev, lit));
+  }
+
   int get_value (int var) {
     if (var > max_var) {
       cout << "ERROR index " << var << " greater than max_var" << endl;
@@ -8,9 +8,13 @@
 #include <unordered_set>
 #include <fstream>
 #include <math.h>
+#include <string.h>
+#include <stdint.h>
+#include "../zfile.h"
+#include "../bknf.h"
 /*
 
-Parses a KNF formula
+Parses a KNF formula (possibly compressed, see '../zfile.h')
 
 TODO: extend to a general pseudo-Boolean formula
 
@@ -21,7 +25,7 @@ TODO: extend to a general pseudo-Boolean formula
 using namespace std;
 
 // type 
-enum Input_Type {UNKNOWN,CNF,KNF,WCNF,WKNF,WCARD,CAI,LSECNF} ;
+enum Input_Type {UNKNOWN,CNF,KNF,WCNF,WKNF,WCARD,CAI,LSECNF,BKNF} ;
 
 
 class KnfParserObserver {
@@ -49,7 +53,7 @@ protected:
 class PlainTextKnfParser : public KnfParser {
 public:
   void Parse(string knf_path, Input_Type input_type) override {
-    FILE* file = fopen(knf_path.c_str(), "r");
+    FILE* file = zfopen(knf_path.c_str(), "r");
     if (!file) throw "File " + knf_path + " cannot be opened.";
     int c = getc_unlocked(file);
     SkipWhitespace(file, c);
@@ -326,6 +330,119 @@ void PlainTextKnfParser::ParseDouble(
   weight *= sign;
 }
 
+/*
+
+Parses a binary KNF formula (see 'Binary KNF format' in the top-level
+README), which has no weights.
+
+*/
+
+class BinaryKnfParser : public KnfParser {
+public:
+
+  // Check for the 'BKNF' signature.
+  static bool IsBinary(string knf_path) {
+    FILE* file = zfopen(knf_path.c_str(), "rb");
+    if (!file) return false;
+    char signature[4];
+    bool res = fread(signature, 1, 4, file) == 4 && !memcmp(signature, "BKNF", 4);
+    fclose(file);
+    return res;
+  }
+
+  void Parse(string knf_path, Input_Type input_type) override {
+    FILE* file = zfopen(knf_path.c_str(), "rb");
+    if (!file) throw "File " + knf_path + " cannot be opened.";
+    char signature[4];
+    if (fread(signature, 1, 4, file) != 4 || memcmp(signature, "BKNF", 4) ||
+        getc_unlocked(file) != BKNF_VERSION) {
+      cout << "ERROR no binary KNF version 1 header" << endl;
+      exit(1);
+    }
+    if (input_type != UNKNOWN && input_type != KNF && input_type != CNF &&
+        input_type != BKNF) {
+      cout << "ERROR binary KNF can not have input type " << input_type << endl;
+      exit(1);
+    }
+
+    uint64_t counts[4];
+    for (int i = 0; i < 4; i++) counts[i] = ParseVarint(file);
+    int max_var = counts[0];
+    int max_cls = counts[1] + counts[2] + counts[3];
+
+    cout << "c Binary header parsed with " << max_var << " variables " << max_cls << " clauses" << endl;
+
+    for(auto observer : observers_) {
+      observer->Header(max_var, max_cls, -1);
+    }
+
+    vector<int> clause;
+    string s_weight;
+    int ncls = 0;
+    int type;
+    while ((type = getc_unlocked(file)) != EOF) {
+      if ((type & 3) == BKNF_COMMENT) {
+        string comment = "c ";
+        for (uint64_t n = ParseVarint(file); n; n--) comment.push_back(getc_unlocked(file));
+        for(auto observer : observers_) {
+          observer->Comment(comment);
+        }
+        continue;
+      }
+      int bound = 1, guard = 0;
+      if (type & 3) bound = ParseVarint(file);
+      if ((type & 3) == BKNF_GUARDED) {
+        uint64_t prev = 0;
+        guard = ParseDelta(file, prev);
+      }
+      uint64_t size = ParseVarint(file), prev = 0;
+      clause.clear();
+      while (size--) clause.emplace_back(ParseDelta(file, prev));
+      ncls++;
+      if (type & 3) {
+        for(auto observer : observers_) {
+          observer->CardinalityConstraint(clause, bound, 0, s_weight, guard);
+        }
+      } else {
+        for(auto observer : observers_) {
+          observer->Clause(clause, 0, s_weight);
+        }
+      }
+    }
+    fclose(file);
+
+    if (ncls != max_cls) {
+      cout << "ERROR incorrect number of clasues parsed" << endl;
+      cout << "parsed " << ncls << " expected " << max_cls << endl;
+      exit (1);
+    }
+  }
+
+private:
+  static uint64_t ParseVarint(FILE *file) {
+    uint64_t res = 0;
+    unsigned shift = 0;
+    int ch, more;
+    do {
+      ch = getc_unlocked(file);
+      if (ch == EOF || (more = bknf_get_varint(&res, &shift, ch)) < 0) {
+        cout << "ERROR unexpected end of binary KNF" << endl;
+        exit(1);
+      }
+    } while (more);
+    return res;
+  }
+
+  static int ParseDelta(FILE *file, uint64_t &prev) {
+    int lit = bknf_undelta(&prev, ParseVarint(file));
+    if (!lit) {
+      cout << "ERROR invalid literal in binary KNF" << endl;
+      exit(1);
+    }
+    return lit;
+  }
+};
+
 /*
   receive c pointing to first character of header following p
 
@@ -0,0 +1,159 @@
+#ifndef RECONSTRUCT_H
+#define RECONSTRUCT_H
+
+#include <vector>
+#include <stdlib.h>
+
+/*
+
+Reconstructs the values of eliminated variables in a model of the extracted
+formula, such that it satisfies the original formula.  These are the
+encoding variables the extractor removed together with the clauses of
+their constraint (and variables fixed by unit propagation before the
+extraction), thus they can take any value in the model of the extracted
+formula.
+
+Only the clauses containing eliminated variables are visited.  They are
+split into components connected by eliminated variables, and each
+component is solved by unit propagation under the values of the other
+variables, deciding 'false' on variables left unassigned and backtracking
+chronologically on a conflict.  For the encodings recognized by the
+extractor propagation determines the encoding variables from the problem
+variables, thus this is a linear pass in practice.
+
+'values' is indexed by variable with '1' for true and '-1' for false, and
+the values of eliminated variables are overwritten.  Returns false if a
+component has no solution, i.e., the model does not satisfy the constraint
+of the eliminated variables.
+
+*/
+
+using namespace std;
+
+class Reconstruction {
+public:
+
+  Reconstruction (const vector<vector<int>> & clauses, vector<int> & values) :
+    clauses (clauses), values (values) { }
+
+  bool run (const vector<int> & eliminated) {
+    int max_var = values.size () - 1;
+    vector<char> is_eliminated (max_var + 1, 0);
+    for (auto var : eliminated)
+      if (var > 0 && var <= max_var) { is_eliminated[var] = 1; values[var] = 0; }
+
+    // components by union-find over the eliminated variables of each clause
+    parent.resize (max_var + 1);
+    for (int var = 0; var <= max_var; var++) parent[var] = var;
+    occurrences.assign (2 * (max_var + 1), vector<int> ());
+    vector<int> relevant;
+    for (size_t i = 0; i < clauses.size (); i++) {
+      int first = 0;
+      for (auto lit : clauses[i]) {
+        if (abs (lit) > max_var || !is_eliminated[abs (lit)]) continue;
+        occurrences[index (lit)].push_back (i);
+        if (!first) first = abs (lit);
+        else parent[find (abs (lit))] = find (first);
+      }
+      if (first) relevant.push_back (i);
+    }
+
+    vector<vector<int>> component_clauses (max_var + 1), component_variables (max_var + 1);
+    for (auto i : relevant)
+      for (auto lit : clauses[i])
+        if (abs (lit) <= max_var && is_eliminated[abs (lit)]) {
+          component_clauses[find (abs (lit))].push_back (i);
+          break;
+        }
+    for (int var = 1; var <= max_var; var++)
+      if (is_eliminated[var]) component_variables[find (var)].push_back (var);
+
+    for (int root = 1; root <= max_var; root++) {
+      if (component_variables[root].empty ()) continue;
+      if (!solve (component_clauses[root], component_variables[root])) return false;
+    }
+    return true;
+  }
+
+private:
+
+  const vector<vector<int>> & clauses;
+  vector<int> & values;
+
+  vector<int> parent;
+  vector<vector<int>> occurrences; // clauses of eliminated literals
+  vector<int> trail;
+
+  static size_t index (int lit) { return 2 * (size_t) abs (lit) + (lit < 0); }
+
+  int find (int var) {
+    while (parent[var] != var) var = parent[var] = parent[parent[var]];
+    return var;
+  }
+
+  int value (int lit) const {
+    if (abs (lit) >= (int) values.size ()) return 0;
+    return lit < 0 ? -values[-lit] : values[lit];
+  }
+
+  void assign (int lit) {
+    values[abs (lit)] = lit < 0 ? -1 : 1;
+    trail.push_back (lit);
+  }
+
+  // Returns false on a falsified clause, assigns the literal of unit clauses.
+  bool propagate_clause (int i) {
+    int unassigned = 0, last = 0;
+    for (auto lit : clauses[i]) {
+      int v = value (lit);
+      if (v > 0) return true;
+      if (!v) { unassigned++; last = lit; }
+    }
+    if (!unassigned) return false;
+    if (unassigned == 1) assign (last);
+    return true;
+  }
+
+  bool propagate (size_t & next) {
+    for (; next < trail.size (); next++)
+      for (auto i : occurrences[index (-trail[next])])
+        if (!propagate_clause (i)) return false;
+    return true;
+  }
+
+  bool solve (const vector<int> & component, const vector<int> & variables) {
+    struct Decision { size_t level; int lit; bool flipped; };
+    vector<Decision> decisions;
+    trail.clear ();
+    size_t next = 0, var_idx = 0;
+    bool ok = true;
+    for (auto i : component)
+      if (!(ok = propagate_clause (i))) break;
+    if (ok) ok = propagate (next);
+    for (;;) {
+      if (!ok) {
+        // flip the last decision not flipped yet
+        while (!decisions.empty () && decisions.back ().flipped) decisions.pop_back ();
+        if (decisions.empty ()) return false;
+        Decision & decision = decisions.back ();
+        while (trail.size () > decision.level) {
+          values[abs (trail.back ())] = 0;
+          trail.pop_back ();
+        }
+        decision.flipped = true;
+        assign (-decision.lit);
+        next = decision.level;
+        var_idx = 0;
+        ok = propagate (next);
+        continue;
+      }
+      while (var_idx < variables.size () && values[variables[var_idx]]) var_idx++;
+      if (var_idx == variables.size ()) return true;
+      decisions.push_back (Decision {trail.size (), -variables[var_idx], false});
+      assign (-variables[var_idx]);
+      ok = propagate (next);
+    }
+  }
+};
+
+#endif
@@ -1,6 +1,9 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <string.h>
+#include "zfile.h"
 
 //#define PAIRWISE
 //#define CNFPLUS
@@ -8,55 +11,80 @@
 //#define KONLY
 //#define LINEAR
 
+// binary DRAT output (derivation only)
+int binary = 0;
+
+void putlit (int lit) {
+  if (!binary) { printf ("%i ", lit); return; }
+  unsigned x = 2 * abs (lit) + (lit < 0);
+  while (x & ~0x7f) { putchar ((x & 0x7f) | 0x80); x >>= 7; }
+  putchar (x);
+}
+
+void putzero () {
+  if (binary) putchar (0);
+  else printf ("0\n");
+}
+
+void putbinary (int a, int b) {
+  if (binary) putchar ('a');
+  putlit (a); putlit (b); putzero ();
+}
+
 // just a clause
 void atleastone (int *array, int size) {
+  if (binary) putchar ('a');
   for (int i = 0; i < size; i++)
-    printf ("%i ", array[i]);
-  printf ("0\n");
+    putlit (array[i]);
+  putzero ();
 }
 
 // no auxiliary variables for at least two
 void atleasttwo (int *array, int size) {
   for (int i = size-1; i >= 0; i--) {
+    if (binary) putchar ('a');
     for (int j = 0; j < size; j++)
-      if (j != i) printf ("%i ", array[j]);
-    printf ("0\n"); }
+      if (j != i) putlit (array[j]);
+    putzero (); }
 }
 
 // all unit clasues
 void atleastall (int* array, int size) {
-  for (int i = 0; i < size; i++)
-    printf ("%i 0\n", array[i]);
+  for (int i = 0; i < size; i++) {
+    if (binary) putchar ('a');
+    putlit (array[i]); putzero (); }
 }
 
 int atleastallbutone (int* array, int size, int aux) {
 #ifdef PAIRWISE
   for (int i = 0; i < size; i++)
     for (int j = i+1; j < size; j++)
-      printf ("%i %i 0\n", array[i], array[j]);
+      putbinary (array[i], array[j]);
 
   return aux;
 #else
   if (size > 1) {
-    printf ("%i %i 0\n", array[0], array[1]); }
+    putbinary (array[0], array[1]); }
 
   if (size > 2) {
-    printf ("%i %i 0\n", array[0], array[2]);
-    printf ("%i %i 0\n", array[1], array[2]); }
+    putbinary (array[0], array[2]);
+    putbinary (array[1], array[2]); }
 
   if (size <= 3) return aux;
 
   if (size == 4) {
-    printf ("%i %i 0\n", array[0], array[3]);
-    printf ("%i %i 0\n", array[1], array[3]);
-    printf ("%i %i 0\n", array[2], array[3]);
+    putbinary (array[0], array[3]);
+    putbinary (array[1], array[3]);
+    putbinary (array[2], array[3]);
     return aux; }
 
-  printf ("%i %i 0\n", aux, array[0]);
-  printf ("%i %i 0\n", aux, array[1]);
-  printf ("%i %i 0\n", aux, array[2]);
+  putbinary (aux, array[0]);
+  putbinary (aux, array[1]);
+  putbinary (aux, array[2]);
 #ifdef DERIVATION
-  printf ("%i %i %i %i 0\n", -aux, -array[0], -array[1], -array[2]);
+  if (binary) putchar ('a');
+  putlit (-aux); putlit (-array[0]); putlit (-array[1]); putlit (-array[2]);
+  putzero ();
 #endif
 
 #ifdef LINEAR
@@ -81,7 +109,10 @@ int derivation (int* array, int size, int aux) {
 #endif
   if (size <= 4) return aux;
 
-  printf ("d %i %i %i %i 0\n", -aux, -array[0], -array[1], -array[2]);
+  if (binary) putchar ('d');
+  else printf ("d ");
+  putlit (-aux); putlit (-array[0]); putlit (-array[1]); putlit (-array[2]);
+  putzero ();
 
 #ifdef LINEAR
   array[0] = -aux;
@@ -102,28 +133,38 @@ int atleastk (int *array, int size, int bound, int start) {
   // horizontal implications and increment implications
   for (int i = 0; i < bound; i++)
     for (int j = i; j <= size - bound + i; j++) {
-      printf ("%i ", array[j]);
-      if (j > i) printf ("%i ", start + (size-bound-1) * i + j - 1);
-      if (j + 1 <= size - bound + i) printf ("-%i ", start + (size-bound-1) * i + j);
-      printf ("0\n"); }
+      if (binary) putchar ('a');
+      putlit (array[j]);
+      if (j > i) putlit (start + (size-bound-1) * i + j - 1);
+      if (j + 1 <= size - bound + i) putlit (-(start + (size-bound-1) * i + j));
+      putzero (); }
 
   // diagonal implications
   for (int i = 0; i < bound - 1; i++)
     for (int j = i; j < size - bound + i; j++)
-      printf("%i -%i 0\n", start + (size-bound-1) * i + j, start + (size-bound-1) * (i+1) + j + 1);
+      putbinary (start + (size-bound-1) * i + j, -(start + (size-bound-1) * (i+1) + j + 1));
 
   return start + (size-bound) * bound;
 }
 
 int main (int argc, char** argv) {
   if (argc <= 1) {
+#ifdef DERIVATION
+    printf ("c run using %s FILE.knf [--binary]\n", argv[0]);
+#else
     printf ("c run using %s FILE.knf\n", argv[0]);
+#endif
     exit (0); }
 
+#ifdef DERIVATION
+  // binary DRAT allows to concatenate with binary solver proofs
+  if (argc > 2 && !strcmp (argv[2], "--binary")) binary = 1;
+#endif
+
   char ch;
   int word_count = 0, in_word = 0, line_count = 0;
 
-  FILE* fp = fopen (argv[1], "r");
+  FILE* fp = zfopen (argv[1], "r");
   if (fp == NULL) {
     printf("Could not open the file %s\n", argv[1]);
     return 1; }
@@ -138,7 +179,7 @@ int main (int argc, char** argv) {
 //  printf ("word count %i\n", word_count);
 //  exit (0);
 
-  FILE* input = fopen (argv[1], "r");
+  FILE* input = zfopen (argv[1], "r");
 
   int tmp;
   char c = 0;
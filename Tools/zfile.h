@@ -0,0 +1,203 @@
+#ifndef ZFILE_H_INCLUDED
+#define ZFILE_H_INCLUDED
+
+// In-process compression and decompression of files with suffix '.gz'
+// (zlib), '.bz2' (libbz2) and '.xz' (liblzma) instead of piping them
+// through external 'gzip', 'bzip2' or 'xz' processes.  The 'FILE' returned
+// by 'zfopen' is a custom stream ('fopencookie' with glibc and 'funopen' on
+// BSD and macOS), which is read and written as any other file and closed
+// with 'fclose'.  Other files, as well as compressed input files which do
+// not match the signature of their suffix, are opened with plain 'fopen'.
+//
+// Shared by the tools and the extractor.  In C '_GNU_SOURCE' has to be
+// defined before the first system header (g++ always defines it).  Link
+// with '-lz -lbz2 -llzma'.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <sys/types.h>
+
+#include <zlib.h>
+#include <bzlib.h>
+#include <lzma.h>
+
+#define ZFILE_GZ  1
+#define ZFILE_BZ2 2
+#define ZFILE_XZ  3
+
+#define ZFILE_BLOCK (1 << 16)
+
+struct zfile {
+  int type, writing, eof;
+  FILE *file;                        // compressed file (bz2 and xz)
+  gzFile gz;
+  BZFILE *bz;
+  lzma_stream xz;
+  unsigned char block[ZFILE_BLOCK];  // compressed data (xz)
+};
+
+static int zfile_type (const char *path) {
+  size_t n = strlen (path);
+  if (n > 3 && !strcmp (path + n - 3, ".gz")) return ZFILE_GZ;
+  if (n > 4 && !strcmp (path + n - 4, ".bz2")) return ZFILE_BZ2;
+  if (n > 3 && !strcmp (path + n - 3, ".xz")) return ZFILE_XZ;
+  return 0;
+}
+
+static ssize_t zfile_read (void *cookie, char *buf, size_t size) {
+  struct zfile *z = (struct zfile *) cookie;
+  if (size > INT_MAX) size = INT_MAX;
+  if (z->type == ZFILE_GZ) return gzread (z->gz, buf, (unsigned) size);
+  if (z->type == ZFILE_BZ2) {
+    int err, n;
+    if (z->eof) return 0;
+    n = BZ2_bzRead (&err, z->bz, buf, (int) size);
+    if (err == BZ_STREAM_END) z->eof = 1;
+    else if (err != BZ_OK) return -1;
+    return n;
+  }
+  lzma_stream *s = &z->xz;
+  s->next_out = (uint8_t *) buf;
+  s->avail_out = size;
+  while (s->avail_out) {
+    if (!s->avail_in && !z->eof) {
+      s->next_in = z->block;
+      s->avail_in = fread (z->block, 1, ZFILE_BLOCK, z->file);
+      if (!s->avail_in) {
+        if (ferror (z->file)) return -1;
+        z->eof = 1;
+      }
+    }
+    lzma_ret ret = lzma_code (s, z->eof ? LZMA_FINISH : LZMA_RUN);
+    if (ret == LZMA_STREAM_END) break;
+    if (ret != LZMA_OK) return -1;
+  }
+  return size - s->avail_out;
+}
+
+// Compressed output of the xz encoder in 'block' is written when full.
+static int zfile_code (struct zfile *z, lzma_action action) {
+  lzma_stream *s = &z->xz;
+  for (;;) {
+    s->next_out = z->block;
+    s->avail_out = ZFILE_BLOCK;
+    lzma_ret ret = lzma_code (s, action);
+    size_t n = ZFILE_BLOCK - s->avail_out;
+    if (n && fwrite (z->block, 1, n, z->file) != n) return 0;
+    if (ret == LZMA_STREAM_END) return 1;
+    if (ret != LZMA_OK) return 0;
+    if (action == LZMA_RUN && !s->avail_in && s->avail_out) return 1;
+  }
+}
+
+static ssize_t zfile_write (void *cookie, const char *buf, size_t size) {
+  struct zfile *z = (struct zfile *) cookie;
+  if (size > INT_MAX) size = INT_MAX;
+  if (z->type == ZFILE_GZ) return gzwrite (z->gz, buf, (unsigned) size);
+  if (z->type == ZFILE_BZ2) {
+    int err;
+    BZ2_bzWrite (&err, z->bz, (void *) buf, (int) size);
+    return err == BZ_OK ? (ssize_t) size : 0;
+  }
+  z->xz.next_in = (const uint8_t *) buf;
+  z->xz.avail_in = size;
+  return zfile_code (z, LZMA_RUN) ? (ssize_t) size : 0;
+}
+
+static int zfile_close (void *cookie) {
+  struct zfile *z = (struct zfile *) cookie;
+  int res = 0, err;
+  if (z->type == ZFILE_GZ) res = (gzclose (z->gz) == Z_OK) ? 0 : EOF;
+  else {
+    if (z->type == ZFILE_BZ2) {
+      if (z->writing) BZ2_bzWriteClose (&err, z->bz, 0, 0, 0);
+      else BZ2_bzReadClose (&err, z->bz);
+      if (err != BZ_OK) res = EOF;
+    } else {
+      if (z->writing && !zfile_code (z, LZMA_FINISH)) res = EOF;
+      lzma_end (&z->xz);
+    }
+    if (fclose (z->file)) res = EOF;
+  }
+  free (z);
+  return res;
+}
+
+#if defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || \
+    defined(__NetBSD__)
+static int zfile_read_bsd (void *c, char *buf, int size) {
+  return (int) zfile_read (c, buf, size);
+}
+static int zfile_write_bsd (void *c, const char *buf, int size) {
+  return (int) zfile_write (c, buf, size);
+}
+#endif
+
+// Returns 'NULL' if the file can not be opened.
+
+static FILE *zfopen (const char *path, const char *mode) {
+  static const unsigned char bz2sig[] = { 'B', 'Z', 'h' };
+  static const unsigned char xzsig[] = { 0xFD, '7', 'z', 'X', 'Z', 0x00 };
+  int type = zfile_type (path), writing = (mode[0] != 'r'), err;
+  if (!type) return fopen (path, mode);
+  struct zfile *z = (struct zfile *) calloc (1, sizeof *z);
+  if (!z) return 0;
+  z->type = type;
+  z->writing = writing;
+  if (type == ZFILE_GZ) {
+    // zlib also reads uncompressed files transparently
+    if (!(z->gz = gzopen (path, writing ? "wb" : "rb"))) goto FAILED;
+    gzbuffer (z->gz, 1 << 17);
+  } else {
+    if (!(z->file = fopen (path, writing ? "wb" : "rb"))) goto FAILED;
+    if (!writing) {
+      const unsigned char *sig = (type == ZFILE_BZ2) ? bz2sig : xzsig;
+      size_t n = (type == ZFILE_BZ2) ? sizeof bz2sig : sizeof xzsig;
+      unsigned char buf[sizeof xzsig];
+      int match = (fread (buf, 1, n, z->file) == n && !memcmp (buf, sig, n));
+      rewind (z->file);
+      if (!match) {
+        FILE *file = z->file;
+        free (z);
+        return file;
+      }
+    }
+    if (type == ZFILE_BZ2) {
+      if (writing) z->bz = BZ2_bzWriteOpen (&err, z->file, 9, 0, 0);
+      else z->bz = BZ2_bzReadOpen (&err, z->file, 0, 0, 0, 0);
+      if (err != BZ_OK) { fclose (z->file); goto FAILED; }
+    } else {
+      lzma_stream init = LZMA_STREAM_INIT;
+      lzma_ret ret;
+      z->xz = init;
+      if (writing) ret = lzma_easy_encoder (&z->xz, 6, LZMA_CHECK_CRC64);
+      else ret = lzma_stream_decoder (&z->xz, UINT64_MAX, LZMA_CONCATENATED);
+      if (ret != LZMA_OK) { fclose (z->file); goto FAILED; }
+    }
+  }
+  {
+#if defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || \
+    defined(__NetBSD__)
+    FILE *res = funopen (z, writing ? 0 : zfile_read_bsd,
+                         writing ? zfile_write_bsd : 0, 0, zfile_close);
+#else
+    cookie_io_functions_t functions;
+    memset (&functions, 0, sizeof functions);
+    if (writing) functions.write = zfile_write;
+    else functions.read = zfile_read;
+    functions.close = zfile_close;
+    FILE *res = fopencookie (z, writing ? "w" : "r", functions);
+#endif
+    if (!res) { zfile_close (z); return 0; }
+    setvbuf (res, 0, _IOFBF, 1 << 16);
+    return res;
+  }
+FAILED:
+  free (z);
+  return 0;
+}
+
+#endif
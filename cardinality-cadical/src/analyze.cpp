@@ -16,14 +16,20 @@ void Internal::learn_empty_clause () {
   assert (!unsat);
   LOG ("learned empty clause");
   external->check_learned_empty_clause ();
-  if (proof) proof->add_derived_empty_clause ();
+  if (lrat && lrat_chain.empty () && conflict)
+    lrat_chain_for_root (0, conflict);
+  if (proof) proof->add_derived_empty_clause (++clause_id, lrat_chain);
+  lrat_chain.clear ();
   unsat = true;
 }
 
 void Internal::learn_unit_clause (int lit) {
   LOG ("learned unit clause %d", lit);
   external->check_learned_unit_clause (lit);
-  if (proof) proof->add_derived_unit_clause (lit);
+  const int64_t id = ++clause_id;
+  unit_clauses[vidx (lit)] = id;
+  if (proof) proof->add_derived_unit_clause (id, lit, lrat_chain);
+  lrat_chain.clear ();
   mark_fixed (lit);
 }
 
@@ -247,7 +253,7 @@ Internal::analyze_literal (int lit, int & open) {
 inline void
 Internal::CARanalyze_reason (int lit, Clause * reason, int & open) {
   assert (reason);
-  if (reason->unwatched == 2) { // normal clause
+  if (reason->unwatched == 2 && !reason->guard_literal) { // normal clause
     bump_clause (reason);
     for (const auto & other : *reason)
       if (other != lit)
@@ -305,7 +311,7 @@ Internal::CARanalyze_reason (int lit, Clause * reason, int & open) {
         assert (lit == reason->guard_literal);
         assert (val (reason->guard_reason_literal) < 0 && reason->guard_reason_literal != lit);
         analyze_literal (reason->guard_reason_literal, open);
-        reason->guard_reason_literal = 0;
+        if (!lrat) reason->guard_reason_literal = 0;
       } else {
         //guard literal becomes a reason for propagation
         LOG ("Analyzing %d", reason->guard_literal);
@@ -685,6 +691,10 @@ void Internal::CARanalyze () {
   UPDATE_AVERAGE (averages.current.trail.fast, trail.size ());
   UPDATE_AVERAGE (averages.current.trail.slow, trail.size ());
 
+  // Analyzing the conflict resets this literal but hints need it later.
+  //
+  lrat_conflict_literal = cardinality_conflict_literal;
+
   // no chronological backtracking... for now
 
   // Actual conflict on root level, thus formula unsatisfiable.
@@ -768,6 +778,8 @@ void Internal::CARanalyze () {
   } else if (external->learner)
     external->export_learned_unit_clause(-uip);
 
+  if (lrat) lrat_chain_for_learned_clause ();
+
   // Update actual size statistics.
   //
   stats.units    += (size == 1);
@@ -788,6 +800,8 @@ void Internal::CARanalyze () {
   if (uip) search_assign_driving (-uip, driving_clause);
   else learn_empty_clause ();
 
+  if (lrat) lrat_delete_lemmas ();
+
   if (stable) reluctant.tick (); // Reluctant has its own 'conflict' counter.
 
   // Clean up.
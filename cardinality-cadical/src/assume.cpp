@@ -172,16 +172,16 @@ void Internal::failing () {
     if (!unsat_constraint) {
       external->check_learned_clause ();
       if (proof) {
-        proof->add_derived_clause(clause);
-        proof->delete_clause(clause);
+        proof->add_derived_clause(0, clause, lrat_chain);
+        proof->delete_clause(0, clause);
       }
     } else {
       for (auto lit : constraint) {
         clause.push_back(-lit);
         external->check_learned_clause ();
         if (proof) {
-          proof->add_derived_clause(clause);
-          proof->delete_clause(clause);
+          proof->add_derived_clause(0, clause, lrat_chain);
+          proof->delete_clause(0, clause);
         }
         clause.pop_back();
       }
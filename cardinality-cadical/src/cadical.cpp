@@ -232,6 +232,11 @@ void App::print_usage (bool all) {
 "By default the proof is stored in the binary DRAT format unless\n"
 "the option '--no-binary' is specified or the proof is written\n"
 "to  '<stdout>' and '<stdout>' is connected to a terminal.\n"
+"With '--veripb' a VeriPB proof is written instead, for which the\n"
+"original constraints are also written to '<proof>.opb'.\n"
+"With '--lrat' an LRAT proof with hints is written instead, for which\n"
+"the original clauses and a clausal encoding of the cardinality\n"
+"constraints are also written to '<proof>.cnf'.\n"
 "\n"
 "The input is assumed to be compressed if it is given explicitly\n"
 "and has a '.gz', '.bz2', '.xz' or '.7z' suffix.  The same applies\n"
@@ -613,7 +618,11 @@ int App::main (int argc, char ** argv) {
   }
   if (verbose () || proof_specified) solver->section ("proof tracing");
   if (proof_specified) {
-    if (!proof_path) {
+    if (!proof_path && get ("veripb")) {
+      APPERR ("VeriPB proof can not be written to '<stdout>'");
+    } else if (!proof_path && get ("lrat")) {
+      APPERR ("LRAT proof can not be written to '<stdout>'");
+    } else if (!proof_path) {
       const bool force_binary = (isatty (1) && get ("binary"));
       if (force_binary) set ("--no-binary");
       solver->message ("writing %s proof trace to %s'<stdout>'%s",
@@ -625,6 +634,15 @@ int App::main (int argc, char ** argv) {
       solver->trace_proof (stdout, "<stdout>");
     } else if (!solver->trace_proof (proof_path))
       APPERR ("can not open and write DRAT proof to '%s'", proof_path);
+    else if (get ("veripb"))
+      solver->message (
+        "writing VeriPB proof trace to %s'%s'%s and formula to '%s.opb'",
+        tout.green_code (), proof_path, tout.normal_code (), proof_path);
+    else if (get ("lrat"))
+      solver->message (
+        "writing %s LRAT proof trace to %s'%s'%s and formula to '%s.cnf'",
+        (get ("binary") ? "binary" : "non-binary"),
+        tout.green_code (), proof_path, tout.normal_code (), proof_path);
     else
       solver->message (
         "writing %s proof trace to %s'%s'%s",
@@ -193,6 +193,7 @@ struct External;
 // Forward declaration of call-back classes. See bottom of this file.
 
 class Learner;
+class Importer;
 class Terminator;
 class ClauseIterator;
 class WitnessIterator;
@@ -217,9 +218,25 @@ public:
   // Further note that 'lit' is required to be different from 'INT_MIN' and
   // different from '0' except for 'add'.
 
+ // Cardinality constraints 'at least bound of lits' are added literal by
+ // literal as 'CARadd (bound)', optionally 'CARaddGuard (guard)' (the
+ // constraint only has to hold if 'guard' is false), then 'CARadd (lit)'
+ // for all literals and 'CARadd (0)'.
+ //
  void CARadd (int lit, bool encoding = false);
  void CARaddGuard (int lit);
 
+ // Add a whole cardinality constraint or clause from an array of 'size'
+ // literals (without terminating zero) in one call, as the parser does,
+ // avoiding the per literal state changes of 'CARadd' and 'add'.  A zero
+ // 'guard' means unguarded.
+ //
+ //   require (READY)
+ //   ensure (UNKNOWN)
+ //
+ void CARadd_constraint (const int * lits, size_t size, int bound, int guard = 0);
+ void add_clause (const int * lits, size_t size);
+
   // Add valid literal to clause or zero to terminate clause.
   //
   //   require (VALID)                  // recall 'VALID = READY | ADDING'
@@ -287,6 +304,17 @@ public:
   void connect_learner (Learner * learner);
   void disconnect_learner ();
 
+  // Add call-back which provides clauses learned by other solvers on the
+  // same formula (e.g., the other threads of a portfolio).  They are
+  // imported at restarts.  Importing is disabled while tracing a proof,
+  // since these clauses can in general not be checked.
+  //
+  //   require (VALID)
+  //   ensure (VALID)
+  //
+  void connect_importer (Importer * importer);
+  void disconnect_importer ();
+
   // ====== END IPASIR =====================================================
 
   //------------------------------------------------------------------------
@@ -893,6 +921,17 @@ public:
   virtual void learn (int lit) = 0;
 };
 
+// Connected importers are asked for clauses at restarts.  As long as
+// 'import' returns true it has filled 'clause' with the (external) literals
+// of a clause implied by the formula, which is added as redundant clause at
+// the root level.  Clauses with eliminated or unknown variables are skipped.
+
+class Importer {
+public:
+  virtual ~Importer () { }
+  virtual bool import (std::vector<int> & clause) = 0;
+};
+
 /*------------------------------------------------------------------------*/
 
 // Allows to traverse all remaining irredundant clauses.  Satisfied and
@@ -253,7 +253,10 @@ int Internal::sort_by_phase (vector<int> & lits) {
   
 }
 
-void Internal::encode_cardinality_constraint (int cidx, bool by_score, bool add_derivation, bool only_derivation) {
+// In 'hybrid' mode the encoding clauses are added as encoding clauses
+// (see 'ccdclMode') and the cardinality constraint itself is kept.
+
+void Internal::encode_cardinality_constraint (int cidx, bool by_score, bool add_derivation, bool only_derivation, bool hybrid) {
 
   if (!only_derivation) backtrack (); // make sure we are not reusing trail (and reasons)
   
@@ -266,16 +269,24 @@ void Internal::encode_cardinality_constraint (int cidx, bool by_score, bool add_
   int encoding_type = 0;
   int AMO_encoding_type = 0;
 
+  // A guarded constraint is satisfied by its guard, thus the guard is
+  // added to every clause of its encoding.
+  const int guard = c->guard_literal;
+
   if (c->CARbound () == 1 && !only_derivation) {
-    // actually a clause, let's promote it
+    // actually a clause, let's promote it (in hybrid mode it is added as
+    // encoding clause and the constraint is kept)
     original.clear ();
     for (unsigned i = 0; i < c->size; i++)
       original.push_back (c->literals [i]);
-    add_new_original_cardinality_clause ();
+    if (guard) original.push_back (guard);
+    if (hybrid)
+      for (const auto & lit : original) freeze (lit);
+    add_new_original_cardinality_clause (hybrid);
     original.clear ();
 
     // remove it from cardinality constraint list
-    CARmark_garbage (c);
+    if (!hybrid) CARmark_garbage (c);
     return;
   }
 
@@ -285,7 +296,7 @@ void Internal::encode_cardinality_constraint (int cidx, bool by_score, bool add_
 
 
   bool is_AMO = c->CARbound() == c->size - 1;
-  int old_max_var  = max_var; // assume 1-1 between external and internal
+  int old_max_var  = max_var; // fresh internal variables follow 'max_var'
   int fresh_var = old_max_var + 1;
 
   VERBOSE (0, "Encoding Cardinality Constraint %d into clauses, fresh %d",cidx, fresh_var);
@@ -344,32 +355,44 @@ void Internal::encode_cardinality_constraint (int cidx, bool by_score, bool add_
 
   VERBOSE (3, "Finished Generating Encoding, AMO %d", is_AMO);
 
-  // update max variables (external/internal namings important)
+  if (guard) {
+    for (auto & lits : encoding_clauses) lits.push_back (guard);
+    for (auto & lits : encoding_derivation) lits.push_back (guard);
+  }
+
+  // Import fresh variables as new external variables.  After compacting
+  // external and internal indices differ, thus 'init' is passed the new
+  // external maximum which maps them to internal 'old_max_var+1...'.
   if (fresh_var-1 > old_max_var && !only_derivation)
-    external->init (fresh_var-1);
+    external->init (external->max_var + (fresh_var-1 - old_max_var));
 
   VERBOSE (3, "Finished increasing maxvar from %d to %d", old_max_var, fresh_var-1);
 
+  // add derivation to proof (before the encoding clauses are used)
+  if (add_derivation)
+    add_encoding_derivation (!only_derivation);
+
   // add encoding clauses to formula
-  if (!only_derivation) add_encoding_clauses ();
+  if (!only_derivation) add_encoding_clauses (hybrid);
+  else encoding_clauses.clear ();
 
   // remove cardinality constraint from formula
-  if (!only_derivation) CARmark_garbage (c);
-
-  // add derivation to proof
-  if (add_derivation)
-    add_encoding_derivation ();
+  if (!only_derivation && !hybrid) CARmark_garbage (c);
 
   VERBOSE (3, "Finished Encoding, old max var %d, new max var %d, AMO %d", old_max_var, fresh_var-1, is_AMO);
 
 }
 
-void Internal::add_encoding_clauses () {
+void Internal::add_encoding_clauses (bool hybrid) {
 
   for (auto & lits : encoding_clauses) {
     original = lits;
     // log_lits (original);
-    add_new_original_cardinality_clause ();
+    if (hybrid) {
+      // not in 'clauses' and thus invisible to elimination
+      for (const auto & lit : original) freeze (lit);
+    }
+    add_new_original_cardinality_clause (hybrid);
     original.clear ();
   }
 
@@ -382,16 +405,55 @@ void Internal::log_lits (vector<int> lits) {
   printf("0\n");
 }
 
-void Internal::add_derivation_clause (vector<int> lits) {
+// The derivation is written in terms of external variables.  Fresh
+// variables of a derivation only encoding are not imported and thus are
+// numbered after the current external maximum.
+
+int Internal::externalize_encoding_lit (int lit) {
+  const int idx = abs (lit);
+  int res;
+  if (idx <= max_var) res = i2e[idx];
+  else res = external->max_var + (idx - max_var);
+  return lit < 0 ? -res : res;
+}
+
+// If the fresh variables are imported and a proof is traced, the
+// derivation becomes part of that proof (streamed as proof prefix for the
+// encoding clauses), otherwise it is written to the derivation file.
+
+void Internal::add_derivation_clause (vector<int> lits, bool to_proof) {
+  if (to_proof && proof) {
+    proof->add_derived_clause (0, lits, lrat_chain);
+    return;
+  }
+  if (!encoding_derivation_file.is_open ()) return;
+  if (opts.binary) {
+    // same format as the binary DRAT tracer, thus the derivation can be
+    // concatenated with a binary solver proof
+    encoding_derivation_file.put ('a');
+    for (auto lit : lits) {
+      const int elit = externalize_encoding_lit (lit);
+      unsigned x = 2u * abs (elit) + (elit < 0);
+      unsigned char ch;
+      while (x & ~0x7f) {
+        ch = (x & 0x7f) | 0x80;
+        encoding_derivation_file.put (ch);
+        x >>= 7;
+      }
+      encoding_derivation_file.put ((unsigned char) x);
+    }
+    encoding_derivation_file.put (0);
+    return;
+  }
   for (auto lit : lits) 
-    encoding_derivation_file << lit << " ";
+    encoding_derivation_file << externalize_encoding_lit (lit) << " ";
   encoding_derivation_file << "0\n"; 
 }
 
-void Internal::add_encoding_derivation () {
+void Internal::add_encoding_derivation (bool to_proof) {
 
   for (auto & lits : encoding_derivation) {
-    add_derivation_clause (lits);
+    add_derivation_clause (lits, to_proof);
   }
 
   encoding_derivation.clear ();
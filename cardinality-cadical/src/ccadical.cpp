@@ -113,6 +113,23 @@ int ccadical_solve (CCaDiCaL * wrapper) {
   return ((Wrapper*) wrapper)->solver->solve ();
 }
 
+void ccadical_add_card (CCaDiCaL * wrapper, int lit) {
+  ((Wrapper*) wrapper)->solver->CARadd (lit);
+}
+
+void ccadical_add_card_guard (CCaDiCaL * wrapper, int lit) {
+  ((Wrapper*) wrapper)->solver->CARaddGuard (lit);
+}
+
+void ccadical_add_cardinality (CCaDiCaL * wrapper, int bound, int guard,
+                               const int * lits, int size) {
+  ((Wrapper*) wrapper)->solver->CARadd_constraint (lits, size, bound, guard);
+}
+
+void ccadical_add_clause (CCaDiCaL * wrapper, const int * lits, int size) {
+  ((Wrapper*) wrapper)->solver->add_clause (lits, size);
+}
+
 int ccadical_simplify (CCaDiCaL * wrapper) {
   return ((Wrapper*) wrapper)->solver->simplify ();
 }
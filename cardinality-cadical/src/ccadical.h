@@ -48,6 +48,18 @@ int ccadical_frozen (CCaDiCaL *, int lit);
 void ccadical_melt (CCaDiCaL *, int lit);
 int ccadical_simplify (CCaDiCaL *);
 
+// Cardinality constraints 'at least bound of lits', added as the bound,
+// an optional guard (the constraint only has to hold if the guard is
+// false), the literals and a terminating zero through 'ccadical_add_card'
+// and 'ccadical_add_card_guard', or at once from an array of 'size'
+// literals (without zero), where 'guard' zero means unguarded.
+
+void ccadical_add_card (CCaDiCaL *, int lit);
+void ccadical_add_card_guard (CCaDiCaL *, int lit);
+void ccadical_add_cardinality (CCaDiCaL *, int bound, int guard,
+                               const int * lits, int size);
+void ccadical_add_clause (CCaDiCaL *, const int * lits, int size);
+
 /*------------------------------------------------------------------------*/
 
 // Support legacy names used before moving to more IPASIR conforming names.
@@ -456,7 +456,7 @@ void Checker::add_clause (const char * type) {
   } else insert ();
 }
 
-void Checker::add_original_clause (const vector<int> & c) {
+void Checker::add_original_clause (int64_t, const vector<int> & c) {
   if (inconsistent) return;
   START (checking);
   LOG (c, "CHECKER addition of original clause");
@@ -471,7 +471,8 @@ void Checker::add_original_clause (const vector<int> & c) {
   STOP (checking);
 }
 
-void Checker::add_derived_clause (const vector<int> & c) {
+void Checker::add_derived_clause (int64_t, const vector<int> & c,
+                                  const vector<int64_t> &) {
   if (inconsistent) return;
   START (checking);
   LOG (c, "CHECKER addition of derived clause");
@@ -495,7 +496,7 @@ void Checker::add_derived_clause (const vector<int> & c) {
 
 /*------------------------------------------------------------------------*/
 
-void Checker::delete_clause (const vector<int> & c) {
+void Checker::delete_clause (int64_t, const vector<int> & c) {
   if (inconsistent) return;
   START (checking);
   LOG (c, "CHECKER checking deletion of clause");
@@ -152,9 +152,10 @@ public:
 
   // The following three implement the 'Observer' interface.
   //
-  void add_original_clause (const vector<int> &);
-  void add_derived_clause (const vector<int> &);
-  void delete_clause (const vector<int> &);
+  void add_original_clause (int64_t, const vector<int> &);
+  void add_derived_clause (int64_t, const vector<int> &,
+                           const vector<int64_t> &);
+  void delete_clause (int64_t, const vector<int> &);
 
   void print_stats ();
   void dump ();                 // for debugging purposes only
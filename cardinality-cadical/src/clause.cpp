@@ -89,9 +89,7 @@ Clause * Internal::CARnew_clause (bool red, int glue, int guard) {
   Clause * c = (Clause *) new char[bytes];
 
   stats.added.total++;
-#ifdef LOGGING
-  c->id = stats.added.total;
-#endif
+  c->id = ++clause_id;
 
   c->conditioned = false;
   c->covered = false;
@@ -118,15 +116,11 @@ Clause * Internal::CARnew_clause (bool red, int glue, int guard) {
   c->pos = original_cardinality + 1;
 
   c->unwatched = original_cardinality + 1;
-
-  // special case for guarded cardinality constraints
-  if (c->size == original_cardinality) {
-    assert (guard);
-    c->unwatched = c->size;
-  }
+  assert (c->size > original_cardinality);
 
   c->activity = 0;
   c->guard_literal = guard;
+  c->reason_literal = c->guard_reason_literal = 0;
 
   for (int i = 0; i < size; i++) c->literals[i] = clause[i];
 
@@ -174,9 +168,7 @@ Clause * Internal::new_clause (bool red, int glue, bool encoding) {
   Clause * c = (Clause *) new char[bytes];
 
   stats.added.total++;
-#ifdef LOGGING
-  c->id = stats.added.total;
-#endif
+  c->id = ++clause_id;
 
   c->conditioned = false;
   c->covered = false;
@@ -436,11 +428,12 @@ void Internal::CARmark_garbage (Clause * c) {
 // Almost the same function as 'search_assign' except that we do not pretend
 // to learn a new unit clause (which was confusing in log files).
 
-void Internal::assign_original_unit (int lit) {
+void Internal::assign_original_unit (int64_t id, int lit) {
   assert (!level);
   const int idx = vidx (lit);
   assert (!vals[idx]);
   assert (!flags (idx).eliminated ());
+  unit_clauses[idx] = id;
   Var & v = var (idx);
   v.level = level;
   v.trail = (int) trail.size ();
@@ -525,10 +518,22 @@ void Internal::CARadd_new_original_clause (bool encoding) {
     } else if (!size || size < (unsigned long) original_cardinality) {
       if (!unsat) {
         if (guarded && ! (val (original_guard))) {
-          assign_original_unit (original_guard);
+          int64_t id = 0;
+          if (lrat) {
+            lrat_chain_for_root (original_guard, lrat_encodings[original_id]);
+            id = ++clause_id;
+            proof->add_derived_unit_clause (id, original_guard, lrat_chain);
+            lrat_chain.clear ();
+          }
+          assign_original_unit (id, original_guard);
         } else {
           if (!original.size ()) VERBOSE (1, "found empty original clause");
           else MSG ("found falsified original clause");
+          if (lrat) {
+            lrat_chain_for_root (0, lrat_encodings[original_id]);
+            proof->add_derived_empty_clause (++clause_id, lrat_chain);
+            lrat_chain.clear ();
+          }
           unsat = true;
         }
       }
@@ -537,7 +542,14 @@ void Internal::CARadd_new_original_clause (bool encoding) {
       for (const auto & lit : clause)
       {
         if (!vals[lit]) {
-          assign_original_unit (lit);
+          int64_t id = 0;
+          if (lrat) {
+            lrat_chain_for_root (lit, lrat_encodings[original_id]);
+            id = ++clause_id;
+            proof->add_derived_unit_clause (id, lit, lrat_chain);
+            lrat_chain.clear ();
+          }
+          assign_original_unit (id, lit);
           if (unsat) {
             clause.clear ();
             return;
@@ -545,15 +557,40 @@ void Internal::CARadd_new_original_clause (bool encoding) {
         }
         else if (vals[lit] == -1) { // literal may propagate from previous literals...
           LOG ("Cardinality constraint from formula is conflicting during parsing");
+          if (lrat) lrat_chain_for_root (0, lrat_encodings[original_id]);
           learn_empty_clause ();
+          clause.clear ();
+          return;
         }
       }
     } else {
       if (original_cardinality == 1 && (!guarded || val (original_guard) < 0) ) {
         Clause * c = new_clause (false, 0, encoding);
+        if (lrat) {
+          lrat_chain_for_root (0, lrat_encodings[original_id], &clause);
+          proof->add_derived_clause (c, lrat_chain);
+          lrat_chain.clear ();
+        }
         watch_clause (c);
+      } else if (size == (unsigned long) original_cardinality) {
+        // All literals are needed unless the guard is true, which is
+        // simply the set of binary clauses '{guard, lit}' (watching all
+        // literals of a cardinality constraint is ambiguous for guards).
+        assert (guarded && !val (original_guard));
+        const vector<int> lits = clause;
+        for (const auto & lit : lits) {
+          clause = { original_guard, lit };
+          Clause * c = new_clause (false, 0, encoding);
+          if (lrat) {
+            lrat_chain_for_root (0, lrat_encodings[original_id], &clause);
+            proof->add_derived_clause (c, lrat_chain);
+            lrat_chain.clear ();
+          }
+          watch_clause (c);
+        }
       } else {
         Clause * c = CARnew_clause (false, 0, original_guard);
+        c->id = original_id;
         CARwatch_clause (c, original_cardinality);
         if (original_guard) {// && !val (original_guard)) { this will get sorted in first call to collect
           CARwatch_guard (original_guard, c);
@@ -578,7 +615,7 @@ void Internal::CARadd_new_original_clause (bool encoding) {
 
 // New clause added through the API, e.g., while parsing a DIMACS file.
 //
-void Internal::add_new_original_cardinality_clause () {
+void Internal::add_new_original_cardinality_clause (bool encoding) {
   LOG (original, "original encoded clause");
   bool skip = false;
   if (unsat) {
@@ -623,9 +660,9 @@ void Internal::add_new_original_cardinality_clause () {
         unsat = true;
       }
     } else if (size == 1) {
-      assign_original_unit (clause[0]);
+      assign_original_unit (0, clause[0]);
     } else {
-      Clause * c = new_clause (false);
+      Clause * c = new_clause (false, 0, encoding);
       watch_clause (c);
     }
   }
@@ -675,9 +712,26 @@ void Internal::add_new_original_clause () {
       unmark (lit);
   }
   if (skip) {
-    if (proof) proof->delete_clause (original);
+    if (proof) proof->delete_clause (original_id, original);
   } else {
+    int64_t id = original_id;
     size_t size = clause.size ();
+    if (original.size () > size) {
+      external->check_learned_clause ();
+      id = ++clause_id;
+      if (proof) {
+        if (lrat) {
+          for (const auto & lit : original)
+            if (val (lit) < 0)
+              lrat_chain.push_back (unit_clauses[vidx (lit)]);
+          lrat_chain.push_back (original_id);
+        }
+        if (size) proof->add_derived_clause (id, clause, lrat_chain);
+        else proof->add_derived_empty_clause (id, lrat_chain);
+        proof->delete_clause (original_id, original);
+        lrat_chain.clear ();
+      }
+    }
     if (!size) {
       if (!unsat) {
         if (!original.size ()) VERBOSE (1, "found empty original clause");
@@ -685,18 +739,12 @@ void Internal::add_new_original_clause () {
         unsat = true;
       }
     } else if (size == 1) {
-      assign_original_unit (clause[0]);
+      assign_original_unit (id, clause[0]);
     } else {
       Clause * c = new_clause (false);
+      c->id = id;
       watch_clause (c);
     }
-    if (original.size () > size) {
-      external->check_learned_clause ();
-      if (proof) {
-        proof->add_derived_clause (clause);
-        proof->delete_clause (original);
-      }
-    }
   }
   clause.clear ();
 }
@@ -714,7 +762,8 @@ Clause * Internal::new_learned_redundant_clause (int glue) {
 #endif
   external->check_learned_clause ();
   Clause * res = new_clause (true, glue);
-  if (proof) proof->add_derived_clause (res);
+  if (proof) proof->add_derived_clause (res, lrat_chain);
+  lrat_chain.clear ();
   assert (watching ());
   watch_clause (res);
   return res;
@@ -725,7 +774,8 @@ Clause * Internal::new_learned_redundant_clause (int glue) {
 Clause * Internal::new_hyper_binary_resolved_clause (bool red, int glue) {
   external->check_learned_clause ();
   Clause * res = new_clause (red, glue);
-  if (proof) proof->add_derived_clause (res);
+  if (proof) proof->add_derived_clause (res, lrat_chain);
+  lrat_chain.clear ();
   assert (watching ());
   watch_clause (res);
   return res;
@@ -737,7 +787,8 @@ Clause * Internal::new_hyper_ternary_resolved_clause (bool red) {
   external->check_learned_clause ();
   size_t size = clause.size ();
   Clause * res = new_clause (red, size);
-  if (proof) proof->add_derived_clause (res);
+  if (proof) proof->add_derived_clause (res, lrat_chain);
+  lrat_chain.clear ();
   assert (!watching ());
   return res;
 }
@@ -750,7 +801,8 @@ Clause * Internal::new_clause_as (const Clause * orig) {
   const int new_glue = orig->glue;
   Clause * res = new_clause (orig->redundant, new_glue);
   assert (!orig->redundant || !orig->keep || res->keep);
-  if (proof) proof->add_derived_clause (res);
+  if (proof) proof->add_derived_clause (res, lrat_chain);
+  lrat_chain.clear ();
   assert (watching ());
   watch_clause (res);
   return res;
@@ -762,7 +814,8 @@ Clause * Internal::new_clause_as (const Clause * orig) {
 Clause * Internal::new_resolved_irredundant_clause () {
   external->check_learned_clause ();
   Clause * res = new_clause (false);
-  if (proof) proof->add_derived_clause (res);
+  if (proof) proof->add_derived_clause (res, lrat_chain);
+  lrat_chain.clear ();
   assert (!watching ());
   return res;
 }
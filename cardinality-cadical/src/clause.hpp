@@ -23,9 +23,8 @@ typedef const int * const_literal_iterator;
 // is very costly.
 
 struct Clause {
-#ifdef LOGGING
-  int64_t id;         // Only useful for debugging.
-#endif
+
+  int64_t id;         // Identifier in proofs (and for debugging).
 
   bool conditioned:1; // Tried for globally blocked clause elimination.
   bool covered:1;     // Already considered for covered clause elimination.
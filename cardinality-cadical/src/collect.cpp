@@ -68,7 +68,17 @@ void Internal::remove_falsified_literals (Clause * c) {
   for (i = c->begin (); num_non_false < 2 && i != end; i++)
     if (fixed (*i) >= 0) num_non_false++;
   if (num_non_false < 2) return;
-  if (proof) proof->flush_clause (c);
+  if (proof) {
+    if (lrat) {
+      for (const auto & lit : *c)
+        if (fixed (lit) < 0) lrat_chain.push_back (unit_clauses[vidx (lit)]);
+      lrat_chain.push_back (c->id);
+    }
+    const int64_t id = ++clause_id;
+    proof->flush_clause (c, id, lrat_chain);
+    lrat_chain.clear ();
+    c->id = id;
+  }
   literal_iterator j = c->begin ();
   for (i = j; i != end; i++) {
     const int lit = *j++ = *i, tmp = fixed (lit);
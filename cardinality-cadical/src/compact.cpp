@@ -222,12 +222,30 @@ void Internal::compact () {
     }
   }
 
-  // Map the blocking literals in all watches.
+  // Map the literals in cardinality constraints and encoding clauses,
+  // which are kept outside of 'clauses'.  All their variables are frozen
+  // and thus still active or fixed (then mapped to the first fixed one).
+  // Reason literals are only meaningful for reasons above the root level,
+  // which do not exist here, so we simply reset them.
+  //
+  for (const auto & c : CARclauses) {
+    for (auto & src : *c) src = mapper.map_lit (src);
+    if (c->guard_literal)
+      c->guard_literal = mapper.map_lit (c->guard_literal);
+    c->reason_literal = c->guard_reason_literal = 0;
+  }
+  for (const auto & c : CARencodingClauses)
+    for (auto & src : *c) src = mapper.map_lit (src);
+  cardinality_conflict_literal = 0;
+
+  // Map the blocking literals in all watches.  Cardinality watches store
+  // the watched position instead of a literal and are left untouched.
   //
   if (!wtab.empty ())
     for (auto lit : lits)
       for (auto & w : watches (lit))
-        w.blit = mapper.map_lit (w.blit);
+        if (!w.cardinality_clause ())
+          w.set_blit (mapper.map_lit (w.get_blit ()));
 
   // We first flush inactive variables and map the links in the queue.  This
   // has to be done before we map the actual links data structure 'links'.
@@ -272,12 +290,27 @@ void Internal::compact () {
   mapper.map_vector (ftab);
   mapper.map_vector (parents);
   mapper.map_vector (marks);
+  mapper.map_vector (lrat_marks);
+  mapper.map_vector (lrat_locals);
   mapper.map_vector (phases.saved);
   mapper.map_vector (phases.forced);
   mapper.map_vector (phases.target);
   mapper.map_vector (phases.best);
   mapper.map_vector (phases.prev);
   mapper.map_vector (phases.min);
+  mapper.map_vector (mptab);
+
+  // The guard flags are only allocated in 'solve' and thus might not
+  // cover variables added afterwards (and 'vector<bool>' is not shrunken).
+  //
+  if (!guard_literals.empty ()) {
+    guard_literals.resize (vsize, false);
+    for (auto src : vars) {
+      const int dst = mapper.map_idx (src);
+      if (dst) guard_literals[dst] = guard_literals[src];
+    }
+    guard_literals.resize (mapper.new_vsize);
+  }
 
   // Special code for 'frozentab'.
   //
@@ -351,6 +384,7 @@ void Internal::compact () {
   mapper.map2_vector (ptab);
   mapper.map_vector (btab);
   mapper.map_vector (gtab);
+  mapper.map_vector (unit_clauses);
   mapper.map_vector (links);
   mapper.map_vector (vtab);
   if (!ntab.empty ()) mapper.map2_vector (ntab);
@@ -274,8 +274,11 @@ bool Internal::decompose_round () {
       assert (c->size > 2);
       if (!c->redundant) mark_removed (c);
       if (proof) {
-        proof->add_derived_clause (clause);
+        const int64_t id = ++clause_id;
+        proof->add_derived_clause (id, clause, lrat_chain);
         proof->delete_clause (c);
+        lrat_chain.clear ();
+        c->id = id;
       }
       size_t l;
       for (l = 2; l < clause.size (); l++)
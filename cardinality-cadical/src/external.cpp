@@ -10,6 +10,7 @@ External::External (Internal * i)
   extended (false),
   terminator (0),
   learner (0),
+  importer (0),
   solution (0),
   vars (max_var)
 {
@@ -153,7 +154,44 @@ void External::CARaddGuard (int elit) {
   assert (elit != INT_MIN);
   reset_extended ();
   const int ilit = internalize (elit);
-  internal->CARadd_original_guard (elit);
+  internal->CARadd_original_guard (ilit);
+}
+
+void External::CARadd_constraint (const vector<int> & elits,
+                                  int bound, int guard, bool encoding) {
+  assert (bound > 0);
+  reset_extended ();
+  if (internal->opts.check &&
+      (internal->opts.checkwitness || internal->opts.checkfailed)) {
+    original.push_back (bound);
+    original.insert (original.end (), elits.begin (), elits.end ());
+    original.push_back (0);
+  }
+  LOG ("adding cardinality %d for next clause", bound);
+  assert (!internal->original_cardinality);
+  internal->CARadd_original_lit (bound);
+  if (guard) internal->CARadd_original_guard (internalize (guard));
+  assert (internal->original.empty ());
+  for (const auto & elit : elits) {
+    assert (elit && elit != INT_MIN);
+    internal->original.push_back (internalize (elit));
+  }
+  internal->CARadd_original_lit (0, encoding);
+}
+
+void External::add_clause (const vector<int> & elits) {
+  reset_extended ();
+  if (internal->opts.check &&
+      (internal->opts.checkwitness || internal->opts.checkfailed)) {
+    original.insert (original.end (), elits.begin (), elits.end ());
+    original.push_back (0);
+  }
+  assert (internal->original.empty ());
+  for (const auto & elit : elits) {
+    assert (elit && elit != INT_MIN);
+    internal->original.push_back (internalize (elit));
+  }
+  internal->add_original_lit (0);
 }
 
 void External::add (int elit) {
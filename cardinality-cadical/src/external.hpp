@@ -91,6 +91,10 @@ struct External {
   void export_learned_unit_clause (int ilit);
   void export_learned_large_clause (const vector<int> &);
 
+  // If there is an importer import clauses of other solvers at restarts.
+
+  Importer * importer;
+
   //----------------------------------------------------------------------//
 
   signed char * solution;     // Given solution checking for debugging.
@@ -254,6 +258,13 @@ struct External {
   void CARadd (int elit, bool encoding);
   void CARaddGuard (int elit);
   void add (int elit);
+
+  // Bulk versions of the above used by the parser, which add a complete
+  // constraint respectively clause (without terminating zero) at once.
+  //
+  void CARadd_constraint (const vector<int> & elits,
+                          int bound, int guard, bool encoding);
+  void add_clause (const vector<int> & elits);
   void assume (int elit);
   int solve (bool preprocess_only);
 
@@ -7,12 +7,23 @@
 extern "C" {
 #include <string.h>
 #include <errno.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 #include <stdlib.h>
 }
 
+#ifndef NZLIB
+#include <zlib.h>
+#endif
+#ifndef NBZIP2
+#include <bzlib.h>
+#endif
+#ifndef NLZMA
+#include <lzma.h>
+#endif
+
 /*------------------------------------------------------------------------*/
 
 namespace CaDiCaL {
@@ -30,10 +41,53 @@ File::File (Internal *i, bool w, int c, FILE * f, const char * n)
   writing (w),
 #endif
   close_file (c), file (f),
-  _name (n), _lineno (1), _bytes (0)
+  _name (n), _lineno (1), _bytes (0),
+  buffer (0), begin (0), end (0), mapped (0)
 {
   (void) i, (void) w;
   assert (f), assert (n);
+  if (!w && c == 1) map ();
+}
+
+/*------------------------------------------------------------------------*/
+
+// Regular files opened by us are read through a memory mapping of the
+// whole file.  If that fails, e.g., for empty files or special files, we
+// silently fall back to reading blocks with 'fread' as for pipes.
+
+void File::map () {
+  assert (!buffer);
+  struct stat buf;
+  const int fd = fileno (file);
+  if (fd < 0 || fstat (fd, &buf) || !S_ISREG (buf.st_mode)) return;
+  const size_t bytes = buf.st_size;
+  if (!bytes || (off_t) bytes != buf.st_size) return;
+  void * res = mmap (0, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (res == MAP_FAILED) return;
+  (void) madvise (res, bytes, MADV_SEQUENTIAL);
+  MSG ("memory mapped %zd bytes of '%s'", bytes, name ());
+  buffer = (char *) res;
+  begin = 0;
+  end = mapped = bytes;
+}
+
+static const size_t block_size = 1u << 20;
+
+bool File::fill () {
+  assert (begin == end);
+  if (mapped || !file) return false;
+  if (!buffer) buffer = new char [block_size];
+  begin = 0;
+  end = fread (buffer, 1, block_size, file);
+  return end > 0;
+}
+
+void File::release () {
+  if (!buffer) return;
+  if (mapped) munmap (buffer, mapped);
+  else delete [] buffer;
+  buffer = 0;
+  begin = end = mapped = 0;
 }
 
 /*------------------------------------------------------------------------*/
@@ -158,6 +212,235 @@ FILE * File::write_file (Internal * internal, const char * path) {
 
 /*------------------------------------------------------------------------*/
 
+// Compressed files are read and written in-process through 'zlib',
+// 'libbz2' and 'liblzma' unless disabled during configuration (which then
+// defines 'NZLIB', 'NBZIP2' or 'NLZMA' and we fall back to pipes).  The
+// compressed file is wrapped into a custom 'FILE' stream ('fopencookie'
+// with glibc, 'funopen' on BSD and macOS) and thus is read through 'fread'
+// and written through 'putc' as any other file.
+
+enum { GZ = 1, BZ2 = 2, XZ = 3, LZMA = 4 };
+
+#if !defined(NZLIB) || !defined(NBZIP2) || !defined(NLZMA)
+
+struct Codec {
+  int type;
+  bool writing, eof;
+  FILE * file;                  // compressed file (not for 'gzip')
+#ifndef NZLIB
+  gzFile gz;
+#endif
+#ifndef NBZIP2
+  BZFILE * bz;
+#endif
+#ifndef NLZMA
+  lzma_stream xz;
+  unsigned char block[1 << 16];
+#endif
+};
+
+static ssize_t read_codec (void * cookie, char * buf, size_t size) {
+  Codec * c = (Codec *) cookie;
+  if (size > INT_MAX) size = INT_MAX;
+#ifndef NZLIB
+  if (c->type == GZ) return gzread (c->gz, buf, (unsigned) size);
+#endif
+#ifndef NBZIP2
+  if (c->type == BZ2) {
+    if (c->eof) return 0;
+    int err, res = BZ2_bzRead (&err, c->bz, buf, (int) size);
+    if (err == BZ_STREAM_END) c->eof = true;
+    else if (err != BZ_OK) return -1;
+    return res;
+  }
+#endif
+#ifndef NLZMA
+  lzma_stream & s = c->xz;
+  s.next_out = (uint8_t *) buf;
+  s.avail_out = size;
+  while (s.avail_out) {
+    if (!s.avail_in && !c->eof) {
+      s.next_in = c->block;
+      s.avail_in = fread (c->block, 1, sizeof c->block, c->file);
+      if (!s.avail_in) {
+        if (ferror (c->file)) return -1;
+        c->eof = true;
+      }
+    }
+    lzma_ret ret = lzma_code (&s, c->eof ? LZMA_FINISH : LZMA_RUN);
+    if (ret == LZMA_STREAM_END) break;
+    if (ret != LZMA_OK) return -1;
+  }
+  return size - s.avail_out;
+#else
+  return -1;
+#endif
+}
+
+#ifndef NLZMA
+
+// Run the encoder and write its output until all input is consumed.
+
+static bool encode (Codec * c, lzma_action action) {
+  lzma_stream & s = c->xz;
+  for (;;) {
+    s.next_out = c->block;
+    s.avail_out = sizeof c->block;
+    lzma_ret ret = lzma_code (&s, action);
+    size_t bytes = sizeof c->block - s.avail_out;
+    if (bytes && fwrite (c->block, 1, bytes, c->file) != bytes)
+      return false;
+    if (ret == LZMA_STREAM_END) return true;
+    if (ret != LZMA_OK) return false;
+    if (action == LZMA_RUN && !s.avail_in && s.avail_out) return true;
+  }
+}
+
+#endif
+
+static ssize_t write_codec (void * cookie, const char * buf, size_t size) {
+  Codec * c = (Codec *) cookie;
+  if (size > INT_MAX) size = INT_MAX;
+#ifndef NZLIB
+  if (c->type == GZ) return gzwrite (c->gz, buf, (unsigned) size);
+#endif
+#ifndef NBZIP2
+  if (c->type == BZ2) {
+    int err;
+    BZ2_bzWrite (&err, c->bz, (void *) buf, (int) size);
+    return err == BZ_OK ? (ssize_t) size : 0;
+  }
+#endif
+#ifndef NLZMA
+  c->xz.next_in = (const uint8_t *) buf;
+  c->xz.avail_in = size;
+  return encode (c, LZMA_RUN) ? (ssize_t) size : 0;
+#else
+  return 0;
+#endif
+}
+
+static int close_codec (void * cookie) {
+  Codec * c = (Codec *) cookie;
+  int res = 0;
+#ifndef NZLIB
+  if (c->type == GZ) res = (gzclose (c->gz) == Z_OK) ? 0 : EOF;
+#endif
+#ifndef NBZIP2
+  if (c->type == BZ2) {
+    int err;
+    if (c->writing) BZ2_bzWriteClose (&err, c->bz, 0, 0, 0);
+    else BZ2_bzReadClose (&err, c->bz);
+    if (err != BZ_OK) res = EOF;
+  }
+#endif
+#ifndef NLZMA
+  if (c->type == XZ || c->type == LZMA) {
+    if (c->writing && !encode (c, LZMA_FINISH)) res = EOF;
+    lzma_end (&c->xz);
+  }
+#endif
+  if (c->file && fclose (c->file)) res = EOF;
+  delete c;
+  return res;
+}
+
+#if defined(__APPLE__) || defined(__FreeBSD__) || \
+    defined(__OpenBSD__) || defined(__NetBSD__)
+static int read_codec_bsd (void * c, char * buf, int size) {
+  return (int) read_codec (c, buf, size);
+}
+static int write_codec_bsd (void * c, const char * buf, int size) {
+  return (int) write_codec (c, buf, size);
+}
+#endif
+
+#endif
+
+// Returns zero if the library for this type is not available or the file
+// could not be opened, in which case the caller falls back to pipes.
+
+FILE * File::open_codec (Internal * internal, int type,
+                         const char * path, bool writing) {
+  (void) internal, (void) path, (void) writing;
+  switch (type) {
+#ifndef NZLIB
+    case GZ:
+#endif
+#ifndef NBZIP2
+    case BZ2:
+#endif
+#ifndef NLZMA
+    case XZ: case LZMA:
+#endif
+      break;
+    default: return 0;
+  }
+#if !defined(NZLIB) || !defined(NBZIP2) || !defined(NLZMA)
+  if (writing) MSG ("opening compressed file to write '%s'", path);
+  else MSG ("opening compressed file to read '%s'", path);
+  Codec * c = new Codec ();
+  c->type = type;
+  c->writing = writing;
+  c->eof = false;
+  c->file = 0;
+  bool ok = true;
+#ifndef NZLIB
+  if (type == GZ) {
+    ok = (c->gz = gzopen (path, writing ? "wb" : "rb"));
+    if (ok) gzbuffer (c->gz, 1 << 17);
+  }
+#endif
+  if (type != GZ) {
+    c->file = fopen (path, writing ? "wb" : "rb");
+    ok = c->file;
+  }
+#ifndef NBZIP2
+  if (ok && type == BZ2) {
+    int err;
+    if (writing) c->bz = BZ2_bzWriteOpen (&err, c->file, 9, 0, 0);
+    else c->bz = BZ2_bzReadOpen (&err, c->file, 0, 0, 0, 0);
+    ok = (err == BZ_OK);
+  }
+#endif
+#ifndef NLZMA
+  if (ok && (type == XZ || type == LZMA)) {
+    c->xz = LZMA_STREAM_INIT;
+    lzma_ret ret;
+    if (writing) ret = lzma_easy_encoder (&c->xz, 6, LZMA_CHECK_CRC64);
+    else if (type == XZ)
+      ret = lzma_stream_decoder (&c->xz, UINT64_MAX, LZMA_CONCATENATED);
+    else ret = lzma_alone_decoder (&c->xz, UINT64_MAX);
+    ok = (ret == LZMA_OK);
+  }
+#endif
+  if (!ok) {
+    if (c->file) fclose (c->file);
+    delete c;
+    return 0;
+  }
+#if defined(__APPLE__) || defined(__FreeBSD__) || \
+    defined(__OpenBSD__) || defined(__NetBSD__)
+  FILE * res = funopen (c, writing ? 0 : read_codec_bsd,
+                        writing ? write_codec_bsd : 0, 0, close_codec);
+#else
+  cookie_io_functions_t functions;
+  memset (&functions, 0, sizeof functions);
+  if (writing) functions.write = write_codec;
+  else functions.read = read_codec;
+  functions.close = close_codec;
+  FILE * res = fopencookie (c, writing ? "w" : "r", functions);
+#endif
+  if (!res) close_codec (c);
+  else setvbuf (res, 0, _IOFBF, 1 << 16);
+  return res;
+#else
+  return 0;
+#endif
+}
+
+/*------------------------------------------------------------------------*/
+
 FILE * File::open_pipe (Internal * internal,
                         const char * fmt, const char * path,
                         const char * mode) {
@@ -182,10 +465,15 @@ FILE * File::open_pipe (Internal * internal,
   return res;
 }
 
+// Compressed files are read in-process if possible ('close' is set to 3)
+// and otherwise through a pipe to an external tool ('close' set to 2).
+
 FILE * File::read_pipe (Internal * internal,
+                        int type,
                         const char * fmt,
                         const int * sig,
-                        const char * path) {
+                        const char * path,
+                        int & close) {
   if (!File::exists (path)) {
     LOG ("file '%s' does not exist", path);
     return 0;
@@ -193,13 +481,20 @@ FILE * File::read_pipe (Internal * internal,
   LOG ("file '%s' exists", path);
   if (sig && !File::match (internal, path, sig)) return 0;
   LOG ("file '%s' matches signature for '%s'", path, fmt);
+  FILE * res = open_codec (internal, type, path, false);
+  if (res) { close = 3; return res; }
   MSG ("opening pipe to read '%s'", path);
+  close = 2;
   return open_pipe (internal, fmt, path, "r");
 }
 
-FILE * File::write_pipe (Internal * internal,
-                         const char * fmt, const char * path) {
+FILE * File::write_pipe (Internal * internal, int type,
+                         const char * fmt, const char * path,
+                         int & close) {
+  FILE * res = open_codec (internal, type, path, true);
+  if (res) { close = 3; return res; }
   MSG ("opening pipe to write '%s'", path);
+  close = 2;
   return open_pipe (internal, fmt, path, "w");
 }
 
@@ -215,21 +510,26 @@ File * File::write (Internal * internal, FILE * f, const char * n) {
 
 File * File::read (Internal * internal, const char * path) {
   FILE * file;
-  int close_input = 2;
+  int close_input = 1;
   if (has_suffix (path, ".xz")) {
-    file = read_pipe (internal, "xz -c -d %s", xzsig, path);
+    file = read_pipe (internal, XZ, "xz -c -d %s", xzsig, path,
+                      close_input);
     if (!file) goto READ_FILE;
   } else if (has_suffix (path, ".lzma")) {
-    file = read_pipe (internal, "lzma -c -d %s", lzmasig, path);
+    file = read_pipe (internal, LZMA, "lzma -c -d %s", lzmasig, path,
+                      close_input);
     if (!file) goto READ_FILE;
   } else if (has_suffix (path, ".bz2")) {
-    file = read_pipe (internal, "bzip2 -c -d %s", bz2sig, path);
+    file = read_pipe (internal, BZ2, "bzip2 -c -d %s", bz2sig, path,
+                      close_input);
     if (!file) goto READ_FILE;
   } else if (has_suffix (path, ".gz")) {
-    file = read_pipe (internal, "gzip -c -d %s", gzsig, path);
+    file = read_pipe (internal, GZ, "gzip -c -d %s", gzsig, path,
+                      close_input);
     if (!file) goto READ_FILE;
   } else if (has_suffix (path, ".7z")) {
-    file = read_pipe (internal, "7z x -so %s 2>/dev/null", sig7z, path);
+    file = read_pipe (internal, 0, "7z x -so %s 2>/dev/null", sig7z, path,
+                      close_input);
     if (!file) goto READ_FILE;
   } else {
 READ_FILE:
@@ -242,20 +542,21 @@ READ_FILE:
 
 File * File::write (Internal * internal, const char * path) {
   FILE * file;
-  int close_input = 2;
+  int close_output = 1;
   if (has_suffix (path, ".xz"))
-    file = write_pipe (internal, "xz -c > %s", path);
+    file = write_pipe (internal, XZ, "xz -c > %s", path, close_output);
   else if (has_suffix (path, ".bz2"))
-    file = write_pipe (internal, "bzip2 -c > %s", path);
+    file = write_pipe (internal, BZ2, "bzip2 -c > %s", path, close_output);
   else if (has_suffix (path, ".gz"))
-    file = write_pipe (internal, "gzip -c > %s", path);
+    file = write_pipe (internal, GZ, "gzip -c > %s", path, close_output);
   else if (has_suffix (path, ".7z"))
-    file = write_pipe (internal,
-                       "7z a -an -txz -si -so > %s 2>/dev/null", path);
+    file = write_pipe (internal, 0,
+                       "7z a -an -txz -si -so > %s 2>/dev/null", path,
+                       close_output);
   else
-    file = write_file (internal, path), close_input = 1;
+    file = write_file (internal, path), close_output = 1;
 
-  return file ? new File (internal, true, close_input, file, path) : 0;
+  return file ? new File (internal, true, close_output, file, path) : 0;
 }
 
 void File::close () {
@@ -271,8 +572,13 @@ void File::close () {
     MSG ("closing pipe command on '%s'", name ());
     pclose (file);
   }
+  if (close_file == 3) {
+    MSG ("closing compressed file '%s'", name ());
+    fclose (file);
+  }
 
   file = 0;     // mark as closed
+  release ();
 
 #ifndef QUIET
   if (internal->opts.verbose > 1) return;
@@ -281,7 +587,7 @@ void File::close () {
     MSG ("after writing %" PRIu64 " bytes %.1f MB", bytes (), mb);
   else
     MSG ("after reading %" PRIu64 " bytes %.1f MB", bytes (), mb);
-  if (close_file == 2) {
+  if (close_file >= 2) {
     int64_t s = size (name ());
     double mb = s / (double) (1<<20);
     if (writing)
@@ -301,6 +607,6 @@ void File::flush () {
   fflush (file);
 }
 
-File::~File () { if (file) close (); }
+File::~File () { if (file) close (); release (); }
 
 }
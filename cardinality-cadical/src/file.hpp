@@ -21,10 +21,16 @@
 
 namespace CaDiCaL {
 
-// Wraps a 'C' file 'FILE' with name and supports zipped reading and writing
-// through 'popen' using external helper tools.  Reading has line numbers.
-// Compression and decompression relies on external utilities, e.g., 'gzip',
-// 'bzip2', 'xz', and '7z', which should be in the 'PATH'.
+// Wraps a 'C' file 'FILE' with name and supports zipped reading and writing.
+// Reading has line numbers.  Files compressed with 'gzip', 'bzip2' and 'xz'
+// (or 'lzma' for reading) are handled in-process by the corresponding
+// libraries if they were found during configuration.  Otherwise, and for
+// '7z', compression and decompression relies on external utilities, which
+// should be in the 'PATH', through 'popen'.
+//
+// Reading does not go through 'getc' but through a buffer.  Regular files
+// are memory mapped as a whole, while pipes and other streams are read in
+// large blocks, which makes loading huge (reencoded) KNF files much faster.
 
 struct Internal;
 
@@ -37,14 +43,26 @@ class File {
   bool writing;
 #endif
 
-  int close_file;       // need to close file (1=fclose, 2=pclose)
+  int close_file;       // need to close file (1=fclose, 2=pclose,
+                        // 3=fclose of in-process compressed file)
   FILE * file;
   const char * _name;
   uint64_t _lineno;
   uint64_t _bytes;
 
+  // Read buffer with 'buffer[begin..end)' not consumed yet.  If 'mapped'
+  // is non-zero the buffer is the memory mapped file of that size.
+  //
+  char * buffer;
+  size_t begin, end;
+  size_t mapped;
+
   File (Internal *, bool, int, FILE *, const char *);
 
+  void map ();          // try to memory map a regular file
+  bool fill ();         // read next block, return 'false' on end-of-file
+  void release ();      // unmap or delete buffer
+
   static FILE * open_file (Internal *,
                            const char * path, const char * mode);
   static FILE * read_file (Internal *, const char * path);
@@ -54,12 +72,17 @@ class File {
                            const char * fmt,
                            const char * path,
                            const char * mode);
+  static FILE * open_codec (Internal *, int type,
+                            const char * path, bool writing);
   static FILE * read_pipe (Internal *,
+                           int type,
                            const char * fmt,
                            const int * sig,
-                           const char * path);
-  static FILE * write_pipe (Internal *,
-                            const char * fmt, const char * path);
+                           const char * path,
+                           int & close);
+  static FILE * write_pipe (Internal *, int type,
+                            const char * fmt, const char * path,
+                            int & close);
 public:
 
   static char* find (const char * prg);    // search in 'PATH'
@@ -87,15 +110,17 @@ public:
 
   ~File ();
 
-  // Using the 'unlocked' versions here is way faster but
-  // not thread safe if the same file is used by different
-  // threads, which on the other hand currently is impossible.
+  // Reading goes through our own buffer, while for writing using the
+  // 'unlocked' versions here is way faster but not thread safe if the same
+  // file is used by different threads, which on the other hand currently is
+  // impossible.
 
   int get () {
     assert (!writing);
-    int res = cadical_getc_unlocked (file);
+    if (begin == end && !fill ()) return EOF;
+    int res = (unsigned char) buffer[begin++];
     if (res == '\n') _lineno++;
-    if (res != EOF) _bytes++;
+    _bytes++;
     return res;
   }
 
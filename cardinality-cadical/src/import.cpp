@@ -0,0 +1,77 @@
+#include "internal.hpp"
+
+namespace CaDiCaL {
+
+/*------------------------------------------------------------------------*/
+
+// Clauses learned by other solvers on the same formula (the threads of a
+// portfolio) are imported at restarts through the connected 'Importer'.
+// They are implied by the formula and thus can be added as redundant
+// clauses, as long as all their variables are still active here.  Clauses
+// with variables which are eliminated or substituted in this solver are
+// skipped, as well as those with variables unknown to this solver (e.g.,
+// the fresh variables of another encoding).  Literals false at the root
+// level are removed and satisfied clauses are skipped.
+//
+// Without a proof such a clause can in general not be derived, thus
+// importing is disabled while tracing or checking proofs.
+
+/*------------------------------------------------------------------------*/
+
+bool Internal::import_clause (const vector<int> & eclause) {
+  assert (!level);
+  assert (clause.empty ());
+  for (const auto & elit : eclause) {
+    const int eidx = abs (elit);
+    int ilit = eidx <= external->max_var ? external->e2i[eidx] : 0;
+    if (!ilit) {
+      LOG ("skipping imported clause with unknown variable %d", eidx);
+      clause.clear ();
+      return false;
+    }
+    if (elit < 0) ilit = -ilit;
+    const int tmp = val (ilit);
+    if (tmp > 0) {
+      LOG ("skipping imported clause satisfied by %d", ilit);
+      clause.clear ();
+      return false;
+    }
+    if (tmp < 0) continue;
+    if (!flags (ilit).active ()) {
+      LOG ("skipping imported clause with inactive variable %d", ilit);
+      clause.clear ();
+      return false;
+    }
+    clause.push_back (ilit);
+  }
+  const size_t size = clause.size ();
+  if (!size) {
+    LOG ("imported clause falsified at the root level");
+    learn_empty_clause ();
+  } else if (size == 1) {
+    LOG ("imported unit clause %d", clause[0]);
+    stats.imported.units++;
+    assign_unit (clause[0]);
+  } else {
+    Clause * c = new_clause (true, (int) size);
+    LOG (c, "imported");
+    watch_clause (c);
+  }
+  clause.clear ();
+  return true;
+}
+
+void Internal::import_clauses () {
+  assert (external->importer);
+  if (proof) return;
+  vector<int> eclause;
+  while (!unsat) {
+    eclause.clear ();
+    if (!external->importer->import (eclause)) break;
+    if (level) backtrack ();
+    stats.imported.clauses++;
+    if (!import_clause (eclause)) stats.imported.skipped++;
+  }
+}
+
+}
@@ -37,6 +37,8 @@ Internal::Internal ()
   proof (0),
   checker (0),
   tracer (0),
+  pbtracer (0),
+  lrattracer (0),
   opts (this),
 #ifndef QUIET
   profiles (this),
@@ -50,9 +52,17 @@ Internal::Internal ()
   vars (this->max_var),
   lits (this->max_var),
   skip_auxvars (false),
+  ccdclHybridMode (0),
+  ccdclEncoded (false),
   original_cardinality (0),
   original_guard (0),
-  cardinality_conflict_literal(0)
+  cardinality_conflict_literal(0),
+  clause_id (0),
+  original_id (0),
+  lrat (false),
+  lrat_conflict_literal (0),
+  lrat_aux_first (0),
+  lrat_aux_max (0)
 {
   control.push_back (Level (0, 0));
 }
@@ -62,10 +72,10 @@ Internal::~Internal () {
     delete_clause (c);
   if (proof) delete proof;
   if (tracer) delete tracer;
+  if (pbtracer) delete pbtracer;
+  if (lrattracer) delete lrattracer;
   if (checker) delete checker;
   if (vals) { vals -= vsize; delete [] vals; }
-  if (opts.ccdclMode) ccdclHybridMode = 1;
-  else ccdclHybridMode = 0;
 }
 
 /*------------------------------------------------------------------------*/
@@ -135,6 +145,7 @@ void Internal::enlarge (int new_max_var) {
   enlarge_only (links, new_vsize);
   enlarge_zero (btab, new_vsize);
   enlarge_zero (gtab, new_vsize);
+  enlarge_zero (unit_clauses, new_vsize);
   enlarge_zero (stab, new_vsize);
   enlarge_init (ptab, 2*new_vsize, -1);
   enlarge_only (ftab, new_vsize);
@@ -148,6 +159,8 @@ void Internal::enlarge (int new_max_var) {
   enlarge_zero (phases.prev, new_vsize);
   enlarge_zero (phases.min, new_vsize);
   enlarge_zero (marks, new_vsize);
+  enlarge_zero (lrat_marks, new_vsize);
+  enlarge_zero (lrat_locals, new_vsize);
 
   enlarge_zero (mptab, new_vsize);
   vsize = new_vsize;
@@ -190,12 +203,18 @@ void Internal::CARadd_original_lit (int lit, bool encoding) {
   else if (lit) {
     original.push_back (lit);
   } else {
+    original_id = ++clause_id;
+    if (proof)
+      proof->add_original_cardinality_constraint (original_id, original,
+        original_cardinality, original_guard);
     // Note: we do not support opposing literals in a cardinality constraint
     if (original_cardinality == 1 && original_guard == 0)
       add_new_original_clause ();
-    else 
+    else {
     // if (proof) proof->add_original_clause (original);
+      if (lrat) lrat_add_original_cardinality_constraint ();
       CARadd_new_original_clause (encoding);
+    }
     original.clear ();
     original_cardinality = 0;
     original_guard = 0;
@@ -214,7 +233,8 @@ void Internal::add_original_lit (int lit) {
   if (lit) {
     original.push_back (lit);
   } else {
-    if (proof) proof->add_original_clause (original);
+    original_id = ++clause_id;
+    if (proof) proof->add_original_clause (original_id, original);
     add_new_original_clause ();
     original.clear ();
   }
@@ -244,13 +264,23 @@ int Internal::cdcl_loop_with_inprocessing () {
       if (err) {printf("Error parsing auxiliary variables file %s: %s\n",auxvars_file, err); exit(1);}
   }
 
-  if (opts.ccdclEncoding)
-    encoding_derivation_file.open("encoding_derivation.drat");
+  // the initial encoding is done only once, i.e., not again when solving
+  // incrementally (e.g., cubes under assumptions)
+  if (!ccdclEncoded) {
+    ccdclEncoded = true;
 
-  if (opts.ccdclEncoding == 1) { 
-    // encode everything at the start
-    for (unsigned i = 0; i < CARclauses.size(); i++) {
-      encode_cardinality_constraint (i, 0, 1, 0);
+    // the derivation is streamed into the proof if there is one, except for
+    // the derivation only encoding at the end of mode '2'
+    if (opts.ccdclEncoding == 2 || (opts.ccdclEncoding && !proof))
+      encoding_derivation_file.open("encoding_derivation.drat",
+                                    ios::out | ios::binary);
+
+    if (opts.ccdclEncoding == 1 || opts.ccdclEncoding == 3) { 
+      // encode everything at the start (mode '3' keeps the constraints)
+      const bool hybrid = (opts.ccdclEncoding == 3);
+      for (unsigned i = 0; i < CARclauses.size(); i++) {
+        encode_cardinality_constraint (i, 0, 1, 0, hybrid);
+      }
     }
   }
 
@@ -270,6 +300,10 @@ int Internal::cdcl_loop_with_inprocessing () {
   if (stable) { START (stable);   report ('['); }
   else        { START (unstable); report ('{'); }
 
+  // options can be set after construction, thus hybrid mode starts here
+  if (!opts.ccdclMode) ccdclHybridMode = 0;
+  else if (!ccdclHybridMode) ccdclHybridMode = 1;
+
   if (ccdclHybridMode) {
     if (stable) ccdclHybridMode = 1;
     else ccdclHybridMode = 2;
@@ -303,7 +337,7 @@ int Internal::cdcl_loop_with_inprocessing () {
     // else if (probing ()) probe ();           // failed literal probing
     else if (subsuming ()) subsume ();      // subsumption algorithm
     else if (eliminating ()) elim ();        // variable elimination
-    // else if (compacting ()) compact ();      // collect variables
+    else if (compacting ()) compact ();      // collect variables
     // else if (conditioning ()) condition ();  // globally blocked clauses
     else res = decide ();                    // next decision
   }
@@ -322,7 +356,7 @@ int Internal::cdcl_loop_with_inprocessing () {
 
   // printf("c New Max Var %d\n",max_var);
 
-  if (opts.ccdclEncoding)
+  if (encoding_derivation_file.is_open ())
     encoding_derivation_file.close ();
 
 
@@ -720,6 +754,42 @@ int Internal::solve (bool preprocess_only) {
 
   CARwatch_in_garbage = 1;
 
+  if (pbtracer) {
+    // Encoding clauses over fresh variables are not justified in VeriPB
+    // proofs (and not needed since cardinality constraints are native).
+    // Without them hybrid mode would miss propagations (see 'ccdclMode').
+    if (opts.ccdclEncoding) {
+      VERBOSE (1, "disabling cardinality encoding for VeriPB proof");
+      opts.ccdclEncoding = 0;
+    }
+    if (opts.ccdclMode) {
+      VERBOSE (1, "disabling hybrid mode for VeriPB proof");
+      opts.ccdclMode = 0;
+    }
+    pbtracer->begin_proof ();
+  }
+
+  if (lrattracer) {
+    // Only steps which come with hints are traced to LRAT proofs, thus all
+    // inprocessing techniques deriving clauses without them are disabled,
+    // as well as the cardinality encoding over fresh variables and thus
+    // hybrid mode.
+    if (opts.ccdclEncoding) {
+      VERBOSE (1, "disabling cardinality encoding for LRAT proof");
+      opts.ccdclEncoding = 0;
+    }
+    if (opts.ccdclMode) {
+      VERBOSE (1, "disabling hybrid mode for LRAT proof");
+      opts.ccdclMode = 0;
+    }
+    opts.elim = opts.subsume = opts.vivify = opts.probe = 0;
+    opts.compact = opts.chrono = opts.ternary = opts.transred = 0;
+    opts.decompose = opts.block = opts.cover = opts.condition = 0;
+    if (lrat_aux_first && external->max_var >= lrat_aux_first)
+      WARNING ("LRAT encoding variables clash with external variables");
+    lrattracer->begin_proof ();
+  }
+
   if (opts.printUnits) {
     printf("Eliminated Variables ");
     for (auto lit: printUnitVector)
@@ -727,7 +797,7 @@ int Internal::solve (bool preprocess_only) {
     printf("\n");
     }
 
-  for (int i = 0; i <= max_var; i++) guard_literals.push_back (false);
+  if (guard_literals.size () < vsize) guard_literals.resize (vsize, false);
 
   // freeze all variables in cardinality constraints
   for (auto c: CARclauses) {
@@ -33,6 +33,7 @@ extern "C" {
 #include <algorithm>
 #include <queue>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <fstream>
 
@@ -68,6 +69,7 @@ extern "C" {
 #include "level.hpp"
 #include "limit.hpp"
 #include "logging.hpp"
+#include "lrat.hpp"
 #include "message.hpp"
 #include "observer.hpp"
 #include "occs.hpp"
@@ -89,6 +91,7 @@ extern "C" {
 #include "tracer.hpp"
 #include "util.hpp"
 #include "var.hpp"
+#include "veripb.hpp"
 #include "version.hpp"
 #include "vivify.hpp"
 #include "watch.hpp"
@@ -208,6 +211,8 @@ struct Internal {
   Proof * proof;                // clausal proof observers if non zero
   Checker * checker;            // online proof checker observing proof
   Tracer * tracer;              // proof to file tracer observing proof
+  VeripbTracer * pbtracer;      // VeriPB proof tracer observing proof
+  LratTracer * lrattracer;      // LRAT proof tracer observing proof
   Options opts;                 // run-time options
   Stats stats;                  // statistics
 #ifndef QUIET
@@ -264,6 +269,7 @@ struct Internal {
   /*----------------------------------------------------------------------*/
   // CCDCL 
   int ccdclHybridMode; // 1 propagate verything (stable mode) 2 = no propagation on cardinality constraints (unstable mode)
+  bool ccdclEncoded; // initial encoding done (once when solving incrementally)
   vector<int> printUnitVector;
   int CARwatch_in_garbage;
   int original_cardinality;
@@ -287,13 +293,14 @@ struct Internal {
   vector<int> totalizer_mid_variables (int left, int right, int bound, int &fresh_var);
   int totalizer_full_encoding (vector<int> lits, int bound, int fresh_var, bool add_derivation);
   int sort_by_phase (vector<int> & lits);
-  void encode_cardinality_constraint (int cidx, bool by_score, bool add_derivation, bool only_derivation) ;
-  void add_encoding_clauses () ;
+  void encode_cardinality_constraint (int cidx, bool by_score, bool add_derivation, bool only_derivation, bool hybrid = false) ;
+  void add_encoding_clauses (bool hybrid = false) ;
   void log_lits (vector<int> lits);
-  void add_derivation_clause (vector<int> lits) ;
-  void add_encoding_derivation ();
+  int externalize_encoding_lit (int lit);
+  void add_derivation_clause (vector<int> lits, bool to_proof) ;
+  void add_encoding_derivation (bool to_proof);
 
-  void add_new_original_cardinality_clause ();
+  void add_new_original_cardinality_clause (bool encoding = false);
 
   bool clause_contains_aux (Clause * c) {
     for (auto lit : c->literals) {
@@ -320,6 +327,48 @@ struct Internal {
 
   bool are_guarded_constraints;
 
+  /*----------------------------------------------------------------------*/
+  // LRAT proofs with hints ('lratchain.cpp').
+
+  int64_t clause_id;            // last clause (or constraint) identifier
+  int64_t original_id;          // identifier of 'original'
+  bool lrat;                    // compute hints for derived clauses
+  vector<int64_t> lrat_chain;   // hints of next derived clause
+  vector<int64_t> unit_clauses; // identifiers of root-level units [1,max_var]
+  int lrat_conflict_literal;    // 'cardinality_conflict_literal' of conflict
+  int lrat_aux_first;           // first external auxiliary variable
+  int lrat_aux_max;             // maximum external auxiliary variable
+
+  unordered_map<int64_t, LratEncoding> lrat_encodings;  // by constraint
+
+  vector<signed char> lrat_marks;     // justified, assumed or unit hint
+  vector<int> lrat_locals;            // internal to local constraint lits
+  vector<int> lrat_touched;           // variables with 'lrat_marks'
+  vector<int> lrat_justify;           // literals to justify in chain
+  vector<int> lrat_ants;              // antecedents of a literal
+  vector<int64_t> lrat_units;         // unit hints of current chain
+  vector<LratEncoding *> lrat_committed; // encodings with committed values
+  vector<pair<int64_t, vector<int>>> lrat_lemmas; // for guard propagations
+
+  vector<signed char> lrat_vals;      // local unit propagation
+  vector<int> lrat_reasons, lrat_trail;
+  vector<char> lrat_needed;
+
+  void lrat_add_original_cardinality_constraint ();
+  LratEncoding & lrat_encoding (Clause *);
+  void lrat_add_unit (int lit);
+  void lrat_antecedents (int lit, Clause *, vector<int> &);
+  bool lrat_encoding_chain (LratEncoding &, const vector<int> & seeds,
+                            int target, bool commit, vector<int> & roots,
+                            vector<int64_t> & chain);
+  bool lrat_justify_literal (int lit, Clause * reason);
+  void lrat_finish_chain ();
+  void lrat_chain_for_root (int lit, Clause * reason);
+  void lrat_chain_for_root (int lit, LratEncoding &,
+                            const vector<int> * assumed = 0);
+  void lrat_chain_for_learned_clause ();
+  void lrat_delete_lemmas ();
+
 
 
   /*----------------------------------------------------------------------*/
@@ -669,7 +718,7 @@ void CARswap_watched_literal (Clause *c, const int lit, int lit_pos) ;
   void CARdelete_clause (Clause *);
   void mark_garbage (Clause *);
   void CARmark_garbage (Clause *);
-  void assign_original_unit (int);
+  void assign_original_unit (int64_t id, int);
   void CARadd_new_original_clause (bool encoding = false);
   void add_new_original_clause ();
   Clause * new_learned_redundant_clause (int glue);
@@ -733,6 +782,11 @@ void CARswap_watched_literal (Clause *c, const int lit, int lit_pos) ;
   int reuse_trail ();
   void restart ();
 
+  // Importing clauses of other solvers at restarts in 'import.cpp'.
+  //
+  bool import_clause (const vector<int> &);
+  void import_clauses ();
+
   // Functions to set and reset certain 'phases'.
   //
   void clear_phases (vector<signed char> &);  // reset argument to zero
@@ -1289,8 +1343,11 @@ void CARswap_watched_literal (Clause *c, const int lit, int lit_pos) ;
   //
   void new_proof_on_demand ();
   void close_trace ();          // Stop proof tracing.
+  bool trace_closed ();         // Proof tracing stopped.
   void flush_trace ();          // Flush proof trace file.
   void trace (File *);          // Start write proof file.
+  void trace_veripb (File *, File * formula);   // Same for VeriPB.
+  void trace_lrat (File *, File * formula);     // Same for LRAT.
   void check ();                // Enable online proof checking.
 
   // Dump to '<stdout>' as DIMACS for debugging.
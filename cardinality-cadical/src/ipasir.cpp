@@ -18,6 +18,23 @@ void ipasir_add (void * solver, int lit) {
   ccadical_add ((CCaDiCaL *) solver, lit);
 }
 
+void ipasir_add_card (void * solver, int lit) {
+  ccadical_add_card ((CCaDiCaL *) solver, lit);
+}
+
+void ipasir_add_card_guard (void * solver, int lit) {
+  ccadical_add_card_guard ((CCaDiCaL *) solver, lit);
+}
+
+void ipasir_add_cardinality (void * solver, int bound, int guard,
+                             const int * lits, int size) {
+  ccadical_add_cardinality ((CCaDiCaL *) solver, bound, guard, lits, size);
+}
+
+void ipasir_add_clause (void * solver, const int * lits, int size) {
+  ccadical_add_clause ((CCaDiCaL *) solver, lits, size);
+}
+
 void ipasir_assume (void * solver, int lit) {
   ccadical_assume ((CCaDiCaL *) solver, lit);
 }
@@ -29,6 +29,15 @@ void ipasir_set_learn (void * solver,
                        void * state, int max_length,
 		       void (*learn)(void * state, int * clause));
 
+// Extension for cardinality constraints (not part of IPASIR), see
+// 'ccadical_add_card' and 'ccadical_add_cardinality' in 'ccadical.h'.
+
+void ipasir_add_card (void * solver, int lit);
+void ipasir_add_card_guard (void * solver, int lit);
+void ipasir_add_cardinality (void * solver, int bound, int guard,
+                             const int * lits, int size);
+void ipasir_add_clause (void * solver, const int * lits, int size);
+
 /*------------------------------------------------------------------------*/
 #ifdef __cplusplus
 }
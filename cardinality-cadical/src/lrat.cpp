@@ -0,0 +1,179 @@
+#include "internal.hpp"
+
+namespace CaDiCaL {
+
+/*------------------------------------------------------------------------*/
+
+LratTracer::LratTracer (Internal * i, File * f, File * g, bool b) :
+  internal (i),
+  file (f), formula (g), binary (b), begun (false),
+  originals (0), added (0), deleted (0), late (0), skipped (0),
+  last (0), latest (0), max_var (0)
+{
+  (void) internal;
+  LOG ("LRAT new");
+}
+
+LratTracer::~LratTracer () {
+  LOG ("LRAT delete");
+  delete file;
+  delete formula;
+}
+
+/*------------------------------------------------------------------------*/
+
+// Identifiers up to 'last' were given out before the formula was written
+// and are mapped to their position in the formula or the proof.
+
+inline int64_t LratTracer::map_id (int64_t id) {
+  if (id > last) return id;
+  assert ((size_t) id < map.size ());
+  assert (map[id]);
+  return map[id];
+}
+
+// Binary LRAT uses the same variable-length encoding as binary DRAT for
+// both literals and (positive) clause identifiers.
+
+inline void LratTracer::put_binary_number (int64_t x) {
+  assert (binary);
+  uint64_t u = 2*(uint64_t) (x < 0 ? -x : x) + (x < 0);
+  unsigned char ch;
+  while (u & ~(uint64_t) 0x7f) {
+    ch = (u & 0x7f) | 0x80;
+    file->put (ch);
+    u >>= 7;
+  }
+  ch = u;
+  file->put (ch);
+}
+
+inline void LratTracer::put_number (int64_t x) {
+  if (binary) put_binary_number (x);
+  else file->put (x), file->put (' ');
+}
+
+inline void LratTracer::put_lit (int lit) {
+  assert (lit != INT_MIN);
+  put_number (lit);
+}
+
+/*------------------------------------------------------------------------*/
+
+void LratTracer::add_original_clause (int64_t id,
+                                      const vector<int> & clause) {
+  if (begun) {
+    LOG ("LRAT can not trace original clause after proof start");
+    late++;
+    return;
+  }
+  LOG ("LRAT tracing original clause %" PRId64, id);
+  assert (id > 0);
+  for (const auto & external_lit : clause) {
+    clauses.push_back (external_lit);
+    if (abs (external_lit) > max_var) max_var = abs (external_lit);
+  }
+  clauses.push_back (0);
+  if ((size_t) id >= map.size ()) map.resize (id + 1, 0);
+  map[id] = ++originals;
+}
+
+/*------------------------------------------------------------------------*/
+
+void LratTracer::trace_derived_clause (int64_t id,
+                                       const vector<int> & clause,
+                                       const vector<int64_t> & chain) {
+  if (binary) file->put ('a');
+  put_number (id);
+  for (const auto & external_lit : clause)
+    put_lit (external_lit);
+  if (binary) file->put ((unsigned char) 0);
+  else file->put ("0 ");
+  for (const auto & hint : chain)
+    put_number (map_id (hint));
+  if (binary) file->put ((unsigned char) 0);
+  else file->put ("0\n");
+  latest = id;
+  added++;
+}
+
+void LratTracer::trace_delete_clause (int64_t id) {
+  if (binary) file->put ('d');
+  else file->put (latest), file->put (" d ");
+  put_number (id);
+  if (binary) file->put ((unsigned char) 0);
+  else file->put ("0\n");
+  deleted++;
+}
+
+// Steps without identifier (not justified by hints) are skipped.
+
+void LratTracer::add_derived_clause (int64_t id, const vector<int> & clause,
+                                     const vector<int64_t> & chain) {
+  if (file->closed ()) return;
+  if (!id) { skipped++; return; }
+  LOG ("LRAT tracing addition of derived clause %" PRId64, id);
+  if (begun) trace_derived_clause (id, clause, chain);
+  else pending.push_back ({id, true, clause, chain});
+}
+
+void LratTracer::delete_clause (int64_t id, const vector<int> &) {
+  if (file->closed ()) return;
+  if (!id) return;
+  LOG ("LRAT tracing deletion of clause %" PRId64, id);
+  if (begun) trace_delete_clause (map_id (id));
+  else pending.push_back ({id, false, vector<int> (), vector<int64_t> ()});
+}
+
+/*------------------------------------------------------------------------*/
+
+void LratTracer::begin_proof () {
+  if (begun || file->closed ()) return;
+  begun = true;
+  last = internal->clause_id;
+  if ((size_t) last >= map.size ()) map.resize (last + 1, 0);
+  if (internal->external->max_var > max_var)
+    max_var = internal->external->max_var;
+  LOG ("LRAT writing %" PRId64 " original clauses", originals);
+  formula->put ("p cnf "), formula->put (max_var);
+  formula->put (' '), formula->put (originals), formula->put ('\n');
+  for (const auto & lit : clauses) {
+    formula->put (lit);
+    formula->put (lit ? ' ' : '\n');
+  }
+  erase_vector (clauses);
+  formula->close ();
+  int64_t next = latest = originals;
+  for (const auto & step : pending)
+    if (step.added) {
+      map[step.id] = ++next;
+      trace_derived_clause (next, step.clause, step.chain);
+    } else trace_delete_clause (map_id (step.id));
+  erase_vector (pending);
+  assert (next <= last);
+}
+
+/*------------------------------------------------------------------------*/
+
+bool LratTracer::closed () { return file->closed (); }
+
+void LratTracer::close () {
+  assert (!closed ());
+  begin_proof ();
+  file->close ();
+}
+
+void LratTracer::flush () {
+  assert (!closed ());
+  file->flush ();
+  MSG ("traced %" PRId64 " original clauses, "
+    "%" PRId64 " added and %" PRId64 " deleted clauses",
+    originals, added, deleted);
+  if (skipped)
+    MSG ("skipped %" PRId64 " derived clauses without hints", skipped);
+  if (late)
+    MSG ("ignored %" PRId64 " original clauses added after proof start",
+      late);
+}
+
+}
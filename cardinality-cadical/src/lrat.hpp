@@ -0,0 +1,97 @@
+#ifndef _lrat_h_INCLUDED
+#define _lrat_h_INCLUDED
+
+#include "observer.hpp" // Alphabetically after 'lrat'.
+
+// Proof tracing in the LRAT format, where every derived clause comes with
+// the identifiers of the clauses needed to derive it by unit propagation
+// (hints), which allows linear time proof checking.  Cardinality
+// constraints are not clauses, thus the proof refers to a separate CNF
+// formula file, which contains the original clauses and a clausal encoding
+// of each original cardinality constraint over fresh auxiliary variables.
+// Propagations of cardinality constraints are justified by the hints
+// through the encoding clauses (see 'lratchain.cpp').
+
+namespace CaDiCaL {
+
+// The clausal encoding of an original cardinality constraint over local
+// variables: '1..n' are the literals of the constraint, 'n+1' its guard
+// and the remaining ones are auxiliary variables.
+
+struct LratEncoding {
+  vector<int> lits;             // internal literals of the constraint
+  int guard;                    // internal guard literal (or zero)
+  int vars;                     // number of local variables
+  vector<int> literals;         // local literals of all clauses
+  vector<unsigned> start;       // clause 'i' at 'start[i]..start[i+1]'
+  vector<int64_t> ids;          // clause identifiers
+  vector<unsigned> units;       // clauses with one literal
+  vector<unsigned> first;       // occurrences of local literal 'l' are
+  vector<unsigned> occs;        // 'occs[first[l]..first[l+1]]'
+  vector<signed char> committed;// auxiliary values in the current chain
+};
+
+class LratTracer : public Observer {
+
+  Internal * internal;
+  File * file;                  // proof steps
+  File * formula;               // original and encoding clauses
+  bool binary;
+  bool begun;                   // formula written
+
+  int64_t originals, added, deleted, late, skipped;
+  int64_t last;                 // last identifier before proof start
+  int64_t latest;               // last identifier written
+  int max_var;                  // maximum variable in formula
+
+  // Original clauses (zero terminated) and the mapping of identifiers up
+  // to 'last' to those in the proof (larger identifiers are kept).
+  //
+  vector<int> clauses;
+  vector<int64_t> map;
+
+  // Proof steps traced before the formula is complete (while parsing).
+  //
+  struct Step {
+    int64_t id;
+    bool added;
+    vector<int> clause;
+    vector<int64_t> chain;
+  };
+  vector<Step> pending;
+
+  int64_t map_id (int64_t id);
+
+  void put_binary_number (int64_t signed_number);
+  void put_number (int64_t);
+  void put_lit (int external_lit);
+
+  void trace_derived_clause (int64_t, const vector<int> &,
+                             const vector<int64_t> &);
+  void trace_delete_clause (int64_t);
+
+public:
+
+  // Own and delete 'file' and 'formula'.
+  //
+  LratTracer (Internal *, File * file, File * formula, bool binary);
+  ~LratTracer ();
+
+  void add_original_clause (int64_t, const vector<int> &);
+  void add_derived_clause (int64_t, const vector<int> &,
+                           const vector<int64_t> &);
+  void delete_clause (int64_t, const vector<int> &);
+
+  // Write the formula and the pending proof steps.  Original clauses
+  // added later can not be referenced anymore (non-incremental format).
+  //
+  void begin_proof ();
+
+  bool closed ();
+  void close ();
+  void flush ();
+};
+
+}
+
+#endif
@@ -0,0 +1,420 @@
+#include "internal.hpp"
+
+namespace CaDiCaL {
+
+/*------------------------------------------------------------------------*/
+
+// Hints for LRAT proofs.  Clauses are justified by the identifiers of the
+// clauses which become unit (or falsified) in order, after assuming the
+// negation of the derived clause.  Cardinality constraints are not
+// clauses, thus each original constraint is given to the proof as a
+// clausal encoding (the split encoding for AMO constraints and the
+// totalizer otherwise) over fresh auxiliary variables.  A propagation of a
+// constraint is then justified by unit propagation on its encoding, which
+// is done locally here over the (small) encoding, and only the clauses
+// needed to reach the propagated literal are used as hints.
+//
+// The values of auxiliary variables derived in the chain of a learned
+// clause are kept ('committed') since the checker keeps them too.  A
+// propagated guard can not be derived this way (all encoding clauses
+// contain the guard), thus it is justified by a lemma '{guard} | ants',
+// which is derived before the learned clause and deleted afterwards.
+
+enum {
+  LRAT_ASSUMED = 1,     // negation of literal in derived clause
+  LRAT_JUSTIFY = 2,     // true literal justified in the chain
+  LRAT_UNIT = 4,        // unit clause hint of variable added
+};
+
+enum {
+  LRAT_FREE = -1,       // seeded value (antecedent or committed)
+  LRAT_ROOT = -2,       // root-level value (needs a unit clause hint)
+};
+
+/*------------------------------------------------------------------------*/
+
+inline static unsigned lrat_local_index (int lit) {
+  return 2u * abs (lit) + (lit < 0);
+}
+
+// Encode the original cardinality constraint in 'original' and add the
+// encoding as original clauses to the proof.
+
+void Internal::lrat_add_original_cardinality_constraint () {
+  assert (encoding_clauses.empty ());
+  const int n = original.size ();
+  const int k = original_cardinality;
+  const int guard = n + 1;
+  int fresh = n + 2;
+  vector<int> locals;
+  for (int i = 1; i <= n; i++) locals.push_back (i);
+  if (k > n) encoding_clauses.push_back (vector<int> ());
+  else if (k == 1) encoding_clauses.push_back (locals);
+  else if (k == n) {
+    for (const auto & lit : locals) encoding_clauses.push_back ({lit});
+  } else if (k == n - 1)
+    fresh = split_full_encoding (locals, 0, fresh, false);
+  else if (k > 1) {
+    for (auto & lit : locals) lit = -lit;
+    fresh = totalizer_full_encoding (locals, n - k, fresh, false);
+  }
+  LratEncoding & e = lrat_encodings[original_id];
+  e.lits = original;
+  e.guard = original_guard;
+  e.vars = fresh - 1;
+  const int base = max (external->max_var, lrat_aux_max);
+  if (e.vars > guard) {
+    if (!lrat_aux_first) lrat_aux_first = base + 1;
+    lrat_aux_max = base + (e.vars - guard);
+  }
+  LOG ("LRAT encoding of constraint %" PRId64 " with %zd clauses "
+    "and %d auxiliary variables", original_id, encoding_clauses.size (),
+    e.vars - guard);
+  vector<unsigned> count (2*(e.vars + 1), 0);
+  vector<int> externals;
+  for (auto & clause : encoding_clauses) {
+    if (e.guard) clause.push_back (guard);
+    e.start.push_back (e.literals.size ());
+    if (clause.size () == 1) e.units.push_back (e.ids.size ());
+    for (const auto & lit : clause) {
+      e.literals.push_back (lit);
+      count[lrat_local_index (lit)]++;
+      const int idx = abs (lit);
+      int elit;
+      if (idx <= n) elit = externalize (e.lits[idx-1]);
+      else if (idx == guard) elit = externalize (e.guard);
+      else elit = base + (idx - guard);
+      externals.push_back (lit < 0 ? -elit : elit);
+    }
+    e.ids.push_back (++clause_id);
+    proof->add_original_external_clause (clause_id, externals);
+    externals.clear ();
+  }
+  e.start.push_back (e.literals.size ());
+  e.first.resize (count.size () + 1, 0);
+  for (size_t i = 0; i < count.size (); i++)
+    e.first[i+1] = e.first[i] + count[i];
+  e.occs.resize (e.literals.size ());
+  for (size_t i = 0; i + 1 < e.start.size (); i++)
+    for (unsigned j = e.start[i]; j < e.start[i+1]; j++) {
+      const unsigned l = lrat_local_index (e.literals[j]);
+      e.occs[e.first[l] + --count[l]] = i;
+    }
+  encoding_clauses.clear ();
+}
+
+LratEncoding & Internal::lrat_encoding (Clause * c) {
+  assert (c->cardinality_clause);
+  auto it = lrat_encodings.find (c->id);
+  assert (it != lrat_encodings.end ());
+  return it->second;
+}
+
+/*------------------------------------------------------------------------*/
+
+inline static void lrat_mark (vector<signed char> & marks,
+                              vector<int> & touched, int idx, int bit) {
+  if (!marks[idx]) touched.push_back (idx);
+  marks[idx] |= bit;
+}
+
+// Root-level literals are justified by their unit clauses, which are put
+// at the start of the chain.
+
+void Internal::lrat_add_unit (int lit) {
+  const int idx = vidx (lit);
+  assert (val (lit) && !var (idx).level);
+  if (lrat_marks[idx] & LRAT_UNIT) return;
+  lrat_mark (lrat_marks, lrat_touched, idx, LRAT_UNIT);
+  if (unit_clauses[idx]) lrat_units.push_back (unit_clauses[idx]);
+}
+
+// The (falsified) antecedents of 'lit' in 'reason', or of the conflict if
+// 'lit' is zero, exactly as in 'CARanalyze_reason'.
+
+void Internal::lrat_antecedents (int lit, Clause * reason,
+                                 vector<int> & ants) {
+  ants.clear ();
+  if (reason->unwatched == 2 && !reason->guard_literal) {
+    for (const auto & other : *reason)
+      if (other != lit) ants.push_back (other);
+    return;
+  }
+  for (int k = reason->unwatched; k < reason->size; k++)
+    ants.push_back (reason->literals[k]);
+  ants.push_back (reason->reason_literal);
+  if (!lit && lrat_conflict_literal)
+    ants.push_back (lrat_conflict_literal);
+  if (reason->guard_literal) {
+    if (lit && lit == reason->guard_literal)
+      ants.push_back (reason->guard_reason_literal);
+    else ants.push_back (reason->guard_literal);
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+// Unit propagation on the encoding 'e' starting with the falsified
+// internal literals 'seeds' (and root-level values) until 'target' is
+// propagated or a conflict is reached (for zero 'target').  Only
+// auxiliary variables and the target are propagated.  The identifiers of
+// the needed clauses are added to 'chain' and root-level literals used to
+// 'roots'.  Returns 'true' if the propagation reached a conflict.
+
+bool Internal::lrat_encoding_chain (LratEncoding & e,
+                                    const vector<int> & seeds, int target,
+                                    bool commit, vector<int> & roots,
+                                    vector<int64_t> & chain) {
+  const int n = e.lits.size ();
+  const int guard = n + 1;
+  for (int i = 0; i < n; i++) {
+    const int lit = e.lits[i];
+    lrat_locals[vidx (lit)] = lit < 0 ? -(i + 1) : i + 1;
+  }
+  if (e.guard)
+    lrat_locals[vidx (e.guard)] = e.guard < 0 ? -guard : guard;
+
+  auto local = [&] (int lit) {
+    const int res = lrat_locals[vidx (lit)];
+    return lit < 0 ? -res : res;
+  };
+
+  if ((size_t) e.vars >= lrat_vals.size ()) {
+    lrat_vals.resize (e.vars + 1, 0);
+    lrat_reasons.resize (e.vars + 1, 0);
+    lrat_needed.resize (e.vars + 1, 0);
+  }
+  assert (lrat_trail.empty ());
+
+  auto assign = [&] (int lit, int reason) {
+    const int idx = abs (lit);
+    lrat_vals[idx] = lit < 0 ? -1 : 1;
+    lrat_reasons[idx] = reason;
+    lrat_trail.push_back (lit);
+  };
+  auto value = [&] (int lit) {
+    const int res = lrat_vals[abs (lit)];
+    return lit < 0 ? -res : res;
+  };
+
+  for (const auto & lit : seeds) {
+    const int l = local (lit);
+    assert (l);
+    if (!value (l)) assign (-l, LRAT_FREE);
+  }
+  for (int i = 0; i < n; i++) {
+    const int lit = e.lits[i];
+    const int tmp = val (lit);
+    if (!tmp || var (lit).level) continue;
+    if (!lrat_vals[i + 1]) assign (tmp < 0 ? -(i + 1) : i + 1, LRAT_ROOT);
+  }
+  if (e.guard && val (e.guard) && !var (e.guard).level &&
+      !lrat_vals[guard])
+    assign (val (e.guard) < 0 ? -guard : guard, LRAT_ROOT);
+  if (commit)
+    for (size_t idx = guard + 1; idx < e.committed.size (); idx++)
+      if (e.committed[idx] && !lrat_vals[idx])
+        assign (e.committed[idx] < 0 ? -(int) idx : (int) idx, LRAT_FREE);
+
+  const int goal = target ? local (target) : 0;
+  assert (!target || goal);
+  int final = -1;               // conflicting or target reason clause
+  bool conflicting = false;
+
+  // Propagates the unit literal of clause 'c' (if any) or sets 'final' if
+  // it is falsified or propagates the target.
+  //
+  auto visit = [&] (unsigned c) {
+    int unit = 0;
+    for (unsigned j = e.start[c]; j < e.start[c+1]; j++) {
+      const int lit = e.literals[j];
+      const int tmp = value (lit);
+      if (tmp > 0) return;
+      if (tmp < 0) continue;
+      if (unit) return;
+      unit = lit;
+    }
+    if (!unit) final = c, conflicting = true;
+    else if (unit == goal) final = c;
+    else if (abs (unit) > guard) assign (unit, c);
+  };
+
+  for (const auto & c : e.units) {
+    if (final >= 0) break;
+    visit (c);
+  }
+  for (size_t i = 0; final < 0 && i < lrat_trail.size (); i++) {
+    const unsigned l = lrat_local_index (-lrat_trail[i]);
+    for (unsigned j = e.first[l]; final < 0 && j < e.first[l+1]; j++)
+      visit (e.occs[j]);
+  }
+
+  if (final >= 0) {
+    // Trim the propagation to the clauses needed for 'final'.
+    //
+    for (unsigned j = e.start[final]; j < e.start[final+1]; j++)
+      if (e.literals[j] != goal) lrat_needed[abs (e.literals[j])] = true;
+    vector<unsigned> used;
+    for (size_t i = lrat_trail.size (); i--; ) {
+      const int lit = lrat_trail[i];
+      const int idx = abs (lit);
+      if (!lrat_needed[idx]) continue;
+      const int reason = lrat_reasons[idx];
+      if (reason == LRAT_ROOT) {
+        roots.push_back (idx == guard ? (lit < 0 ? -e.guard : e.guard)
+                                      : (lit < 0 ? -e.lits[idx-1]
+                                                 : e.lits[idx-1]));
+      } else if (reason >= 0) {
+        used.push_back (reason);
+        for (unsigned j = e.start[reason]; j < e.start[reason+1]; j++)
+          lrat_needed[abs (e.literals[j])] = true;
+        if (commit) {
+          if (e.committed.empty ()) {
+            e.committed.resize (e.vars + 1, 0);
+            lrat_committed.push_back (&e);
+          }
+          e.committed[idx] = lit < 0 ? -1 : 1;
+        }
+      }
+    }
+    for (size_t i = used.size (); i--; )
+      chain.push_back (e.ids[used[i]]);
+    chain.push_back (e.ids[final]);
+  } else LOG ("LRAT encoding propagation failed");
+
+  for (const auto & lit : lrat_trail) {
+    const int idx = abs (lit);
+    lrat_vals[idx] = 0;
+    lrat_needed[idx] = false;
+  }
+  lrat_trail.clear ();
+  for (const auto & lit : e.lits) lrat_locals[vidx (lit)] = 0;
+  if (e.guard) lrat_locals[vidx (e.guard)] = 0;
+
+  assert (final >= 0);
+  return conflicting;
+}
+
+/*------------------------------------------------------------------------*/
+
+// Add the hints justifying the true literal 'lit' (or the conflict if
+// 'lit' is zero) by 'reason' to 'lrat_chain'.  All non-root antecedents
+// are assumed or already justified.  Returns 'true' if a conflict is
+// reached, which ends the chain.
+
+bool Internal::lrat_justify_literal (int lit, Clause * reason) {
+  lrat_antecedents (lit, reason, lrat_ants);
+  if (reason->unwatched == 2 && !reason->guard_literal) {
+    for (const auto & other : lrat_ants)
+      if (!var (other).level) lrat_add_unit (other);
+    lrat_chain.push_back (reason->id);
+    return false;
+  }
+  LratEncoding & e = lrat_encoding (reason);
+  vector<int> seeds, roots;
+  for (const auto & other : lrat_ants)
+    if (var (other).level) seeds.push_back (other);
+  if (lit && lit == e.guard) {
+    vector<int64_t> chain;
+    seeds.push_back (lit);
+    lrat_encoding_chain (e, seeds, 0, false, roots, chain);
+    vector<int64_t> units;
+    for (const auto & root : roots)
+      if (unit_clauses[vidx (root)])
+        units.push_back (unit_clauses[vidx (root)]);
+    chain.insert (chain.begin (), units.begin (), units.end ());
+    const int64_t id = ++clause_id;
+    proof->add_derived_clause (id, seeds, chain);
+    lrat_lemmas.push_back ({id, seeds});
+    lrat_chain.push_back (id);
+    return false;
+  }
+  const bool res =
+    lrat_encoding_chain (e, seeds, lit, true, roots, lrat_chain);
+  for (const auto & root : roots) lrat_add_unit (root);
+  return res;
+}
+
+void Internal::lrat_finish_chain () {
+  lrat_chain.insert (lrat_chain.begin (),
+                     lrat_units.begin (), lrat_units.end ());
+  lrat_units.clear ();
+  for (const auto & idx : lrat_touched) lrat_marks[idx] = 0;
+  lrat_touched.clear ();
+  for (const auto & e : lrat_committed) e->committed.clear ();
+  lrat_committed.clear ();
+}
+
+/*------------------------------------------------------------------------*/
+
+// Chains for literals (or the conflict for zero 'lit') implied on the
+// root-level, where all antecedents are root-level units.  The literals in
+// 'assumed' are further assumed to be false (for derived clauses).
+
+void Internal::lrat_chain_for_root (int lit, Clause * reason) {
+  assert (lrat_chain.empty ());
+  if (reason->unwatched == 2 && !reason->guard_literal) {
+    for (const auto & other : *reason)
+      if (other != lit) lrat_add_unit (other);
+    lrat_chain.push_back (reason->id);
+    lrat_finish_chain ();
+  } else lrat_chain_for_root (lit, lrat_encoding (reason));
+}
+
+void Internal::lrat_chain_for_root (int lit, LratEncoding & e,
+                                    const vector<int> * assumed) {
+  assert (lrat_chain.empty ());
+  vector<int> seeds, roots;
+  if (assumed) seeds = *assumed;
+  if (lit && lit == e.guard) seeds.push_back (lit), lit = 0;
+  lrat_encoding_chain (e, seeds, lit, false, roots, lrat_chain);
+  for (const auto & root : roots) lrat_add_unit (root);
+  lrat_finish_chain ();
+}
+
+/*------------------------------------------------------------------------*/
+
+// Chain for the learned clause in 'clause' after conflict analysis.  The
+// literals implied by the negation of the clause which are needed for the
+// conflict are collected and justified in trail order.
+
+void Internal::lrat_chain_for_learned_clause () {
+  assert (lrat_chain.empty ());
+  for (const auto & lit : clause)
+    lrat_mark (lrat_marks, lrat_touched, vidx (lit), LRAT_ASSUMED);
+  assert (lrat_justify.empty ());
+  auto collect = [&] () {
+    for (const auto & other : lrat_ants) {
+      const int idx = vidx (other);
+      if (!var (idx).level) continue;
+      if (lrat_marks[idx] & (LRAT_ASSUMED | LRAT_JUSTIFY)) continue;
+      lrat_mark (lrat_marks, lrat_touched, idx, LRAT_JUSTIFY);
+      lrat_justify.push_back (-other);
+    }
+  };
+  lrat_antecedents (0, conflict, lrat_ants);
+  collect ();
+  for (size_t i = 0; i < lrat_justify.size (); i++) {
+    const int lit = lrat_justify[i];
+    Clause * reason = var (lit).reason;
+    assert (reason);
+    lrat_antecedents (lit, reason, lrat_ants);
+    collect ();
+  }
+  sort (lrat_justify.begin (), lrat_justify.end (),
+    [this] (int a, int b) { return var (a).trail < var (b).trail; });
+  bool done = false;
+  for (const auto & lit : lrat_justify)
+    if ((done = lrat_justify_literal (lit, var (lit).reason))) break;
+  if (!done) lrat_justify_literal (0, conflict);
+  lrat_justify.clear ();
+  lrat_finish_chain ();
+}
+
+void Internal::lrat_delete_lemmas () {
+  for (const auto & lemma : lrat_lemmas)
+    proof->delete_clause (lemma.first, lemma.second);
+  lrat_lemmas.clear ();
+}
+
+}
@@ -4,6 +4,10 @@
 namespace CaDiCaL {
 
 // Proof observer class used to act on added, derived or deleted clauses.
+//
+// Clauses come with an identifier and derived clauses with the chain of
+// identifiers of their antecedents (hints in LRAT terminology), which is
+// only computed if there is an observer needing it (see 'lrat.hpp').
 
 class Observer {
 
@@ -15,15 +19,26 @@ public:
   // An online proof 'Checker' needs to know original clauses too while a
   // proof 'Tracer' will not implement this function.
   //
-  virtual void add_original_clause (const vector<int> &) { }
+  virtual void add_original_clause (int64_t, const vector<int> &) { }
+
+  // Original cardinality constraints 'at least bound of lits or guard'.
+  // Only observers with native support for them need to implement this,
+  // otherwise those which are actually clauses are passed on as such.
+  //
+  virtual void add_original_cardinality_constraint (int64_t id,
+                                                    const vector<int> & lits,
+                                                    int bound, int guard) {
+    if (bound == 1 && !guard) add_original_clause (id, lits);
+  }
 
   // Notify the observer that a new clause has been derived.
   //
-  virtual void add_derived_clause (const vector<int> &) { }
+  virtual void add_derived_clause (int64_t, const vector<int> &,
+                                   const vector<int64_t> &) { }
 
   // Notify the observer that a clause is not used anymore.
   //
-  virtual void delete_clause (const vector<int> &) { }
+  virtual void delete_clause (int64_t, const vector<int> &) { }
 
   virtual void flush () { }
 };
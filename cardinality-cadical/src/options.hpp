@@ -40,7 +40,7 @@ OPTION( ccdclAuxNoDecideMode,             0,  0,  1,0,0,0, "prevents decisions o
 OPTION( ccdclAuxRemoveClauses,             0,  0,  0,0,0,0, "Experimental (disabled) - delete clauses containing auxiliary variables (specified by auxCut)") \
 OPTION( ccdclBump,             0,  0,  1,0,0,0, "bump twice extra on reason literals in cardinality constraints that appear in conflict analysis") \
 OPTION( ccdclBumpGuard,             0,  0,  1,0,0,0, "bump once extra on guard literals from guarded cardinality constraints appearing in conflict analysis") \
-OPTION( ccdclEncoding,             0,  0,  0,0,0,0, "Experimental (disabled) - would allow encoding of cardinality constraints during solving") \
+OPTION( ccdclEncoding,             0,  0,  3,0,0,0, "encode cardinality constraints into clauses: 1=all initially, 2=during solving (experimental), 3=all initially but keep constraints (hybrid)") \
 OPTION( ccdclEncodingActivity,             0,  0,  2e9,0,0,0, "Experimental (disabled) - encodes cardinality constraints during solving based on activity") \
 OPTION( ccdclEncodingByScore,             0,  0,  2,0,0,0, "Experimental (disabled) - encodes cardinality constraints during solving based on variable score") \
 OPTION( ccdclEncodingFirstConflict,             0,  0,  2e9,0,0,0, "Experimental (disabled) - encodes cardinality constraints during solving after this given number of conflicts") \
@@ -121,6 +121,7 @@ OPTION( instantiateocclim, 1,  1,2e9,2,0,1, "maximum occurrence limit") \
 OPTION( instantiateonce,   1,  0,  1,0,0,1, "instantiate each clause once") \
 LOGOPT( log,               0,  0,  1,0,0,0, "enable logging") \
 LOGOPT( logsort,           0,  0,  1,0,0,0, "sort logged clauses") \
+OPTION( lrat,              0,  0,  1,0,0,0, "LRAT proof with CNF formula") \
 OPTION( lucky,             0,  0,  1,0,0,1, "search for lucky phases") \
 OPTION( minimize,          1,  0,  1,0,0,1, "minimize learned clauses") \
 OPTION( minimizedepth,   1e3,  0,1e3,0,0,1, "minimization depth") \
@@ -194,6 +195,7 @@ OPTION( transredmaxeff,  1e8,  0,2e9,1,0,1, "maximum efficiency") \
 OPTION( transredmineff,  1e6,  0,2e9,1,0,1, "minimum efficiency") \
 OPTION( transredreleff,  1e2,  1,1e5,1,0,1, "relative efficiency per mille") \
 QUTOPT( verbose,           0,  0,  3,0,0,0, "more verbose messages") \
+OPTION( veripb,            0,  0,  1,0,0,0, "VeriPB proof with OPB formula") \
 OPTION( vivify,            1,  0,  1,0,1,1, "vivification") \
 OPTION( vivifymaxeff,    2e7,  0,2e9,1,0,1, "maximum efficiency") \
 OPTION( vivifymineff,    2e4,  0,2e9,1,0,1, "minimum efficiency") \
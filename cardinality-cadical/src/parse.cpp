@@ -1,5 +1,9 @@
 #include "internal.hpp"
 
+// Binary KNF encoding shared with the tools and the extractor.
+
+#include "../../Tools/bknf.h"
+
 /*------------------------------------------------------------------------*/
 
 namespace CaDiCaL {
@@ -91,11 +95,6 @@ const char * Parser::parse_dimacs_non_profiled (int & vars, int strict) {
   vars = 0;
 
   bool knf = false;
-  bool cardinality = false;
-  bool guarded = false;
-  bool encoding = false;
-  bool parsed_bound = true;
-  bool parsed_guard = false;
 
   // First read comments before header with possibly embedded options.
   //
@@ -116,6 +115,11 @@ const char * Parser::parse_dimacs_non_profiled (int & vars, int strict) {
     if (*o) solver->set_long_option (o);
   }
 
+  if (ch == 'B') {
+    if (parse_inccnf_too) *parse_inccnf_too = false;
+    return parse_binary_knf (vars, strict);
+  }
+
   if (ch != 'p') PER ("expected 'c' or 'p'");
 
   ch = parse_char ();
@@ -207,9 +211,16 @@ const char * Parser::parse_dimacs_non_profiled (int & vars, int strict) {
   if (parse_inccnf_too)
     *parse_inccnf_too = false;
 
-  // Now read body of DIMACS part.
+  // Now read body of DIMACS part.  Literals are collected until the
+  // terminating zero and then the whole clause or constraint is handed over
+  // at once to the external solver, which avoids going through the API
+  // checks for every single literal.  In KNF a constraint is preceded by
+  // 'k' (cardinality constraint 'k <bound> <lits> 0') or 'g' (guarded
+  // constraint 'g <bound> <guard> <lits> 0') and possibly 'e' (encoding).
   //
-  int lit = 0, parsed = 0;
+  bool cardinality = false, guarded = false, encoding = false;
+  int lit = 0, parsed = 0, bound = 0, guard = 0;
+  vector<int> lits;
   while ((ch = parse_char ()) != EOF) {
     if (ch == ' ' || ch == '\n' || ch == '\t' || ch == '\r') continue;
     if (ch == 'c') {
@@ -219,17 +230,11 @@ const char * Parser::parse_dimacs_non_profiled (int & vars, int strict) {
       continue;
     }
     if (ch == 'a' && found_inccnf_header) break;
-    if (ch == 'k') {
-      cardinality = true;
-      continue;
-    }
-    if (ch == 'g') {
-      cardinality = true;
-      guarded = true;
-      continue;
-    }
-    if (ch == 'e') {
-      encoding = true;
+    if (knf && (ch == 'k' || ch == 'g' || ch == 'e')) {
+      if (bound || !lits.empty ())
+        PER ("unexpected '%c' in constraint", ch);
+      if (ch == 'e') encoding = true;
+      else cardinality = true, guarded = (ch == 'g');
       continue;
     }
     const char * err = parse_lit (ch, lit, vars, strict);
@@ -239,38 +244,33 @@ const char * Parser::parse_dimacs_non_profiled (int & vars, int strict) {
         if (ch == EOF)
           PER ("unexpected end-of-file in comment");
     }
-    if (knf) {
-      if (parsed_bound) {
-        if (!cardinality) {
-          solver->CARadd (1); // normal clause, cardinality 1
-          solver->CARadd (lit, encoding);
-        }
-        else
-          solver->CARadd (lit, encoding);
-        parsed_bound = false;
-        parsed_guard = true;
-      } else if (guarded && parsed_guard) {
-        solver->external->CARaddGuard (lit);
-        parsed_guard = false;
-        guarded = false;
-      } else {
-        solver->CARadd (lit, encoding);
-        cardinality = false;
-      }
-    } else solver->add (lit);
-
-    if (lit == 0) {
-      parsed_bound = true;
-      parsed_guard = false;
-      encoding = false;
+    if (cardinality && !bound) {
+      if (lit <= 0) PER ("expected positive bound");
+      bound = lit;
+      continue;
     }
-
-    if (!found_inccnf_header &&
-        !lit && parsed++ >= clauses && strict != FORCED)
+    if (guarded && !guard) {
+      if (!lit) PER ("expected guard literal");
+      guard = lit;
+      continue;
+    }
+    if (lit) { lits.push_back (lit); continue; }
+
+    solver->transition_to_unknown_state ();
+    if (!knf) external->add_clause (lits);
+    else if (cardinality)
+      external->CARadd_constraint (lits, bound, guard, encoding);
+    else external->CARadd_constraint (lits, 1, 0, encoding);
+    lits.clear ();
+    cardinality = guarded = encoding = false;
+    bound = guard = 0;
+
+    if (!found_inccnf_header && parsed++ >= clauses && strict != FORCED)
       PER ("too many clauses");
   }
 
-  if (lit) PER ("last clause without terminating '0'");
+  if (lit || !lits.empty () || cardinality || encoding)
+    PER ("last clause without terminating '0'");
 
   if (!found_inccnf_header && parsed < clauses && strict != FORCED)
     PER ("clause missing");
@@ -346,6 +346,159 @@ const char * Parser::parse_dimacs_non_profiled (int & vars, int strict) {
 
 /*------------------------------------------------------------------------*/
 
+// Parsing binary KNF (see 'Binary KNF format' in the top-level README and
+// 'Tools/bknf.h' for the encoding of numbers and literals).  Since there
+// are no lines, errors give the byte offset instead of the line number.
+
+#define BER(...) \
+do { \
+  internal->error_message.init ("%s: byte %" PRIu64 ": parse error: ", \
+    file->name (), (uint64_t) file->bytes ()); \
+  return internal->error_message.append (__VA_ARGS__); \
+} while (0)
+
+inline const char *
+Parser::parse_varint (uint64_t & res, const char * name) {
+  res = 0;
+  unsigned shift = 0;
+  int ch, more;
+  do {
+    if ((ch = parse_char ()) == EOF)
+      BER ("unexpected end-of-file in %s", name);
+    if ((more = bknf_get_varint (&res, &shift, ch)) < 0)
+      BER ("%s exceeds 64 bits", name);
+  } while (more);
+  return 0;
+}
+
+inline const char *
+Parser::parse_binary_count (int & res, const char * name) {
+  uint64_t tmp;
+  const char * err = parse_varint (tmp, name);
+  if (err) return err;
+  if (tmp > (uint64_t) INT_MAX) BER ("too large %s", name);
+  res = tmp;
+  return 0;
+}
+
+// Parse literal with zig-zag delta to 'prev' which is updated.
+
+inline const char *
+Parser::parse_binary_lit (uint64_t & prev, int & lit, int & vars,
+                          int strict) {
+  uint64_t zigzag;
+  const char * err = parse_varint (zigzag, "literal");
+  if (err) return err;
+  if (!(lit = bknf_undelta (&prev, zigzag)))
+    BER ("invalid literal");
+  const int idx = abs (lit);
+  if (idx > vars) {
+    if (strict != FORCED)
+      BER ("literal %d exceeds maximum variable %d", lit, vars);
+    else vars = idx;
+  }
+  return 0;
+}
+
+const char * Parser::parse_binary_knf (int & vars, int strict) {
+
+#ifndef QUIET
+  double start = internal->time ();
+#endif
+
+  if (parse_char () != 'K' || parse_char () != 'N' || parse_char () != 'F')
+    BER ("expected 'BKNF' signature");
+  int version = parse_char ();
+  if (version == EOF) BER ("unexpected end-of-file in header");
+  if (version != BKNF_VERSION)
+    BER ("unsupported binary KNF version %d (expected %d)",
+      version, (int) BKNF_VERSION);
+
+  int clauses = 0, cardinality = 0, guarded = 0;
+  const char * err = parse_binary_count (vars, "<max-var>");
+  if (!err) err = parse_binary_count (clauses, "<num-clauses>");
+  if (!err) err = parse_binary_count (cardinality, "<num-cardinality>");
+  if (!err) err = parse_binary_count (guarded, "<num-guarded>");
+  if (err) return err;
+  const int64_t total = (int64_t) clauses + cardinality + guarded;
+
+  MSG ("found %sbinary KNF version %d header with %d variables%s",
+    tout.green_code (), version, vars, tout.normal_code ());
+  MSG ("with %d clauses, %d cardinality and %d guarded constraints",
+    clauses, cardinality, guarded);
+
+  if (strict != FORCED)
+    solver->reserve (vars);
+
+  // Without cardinality constraints this is plain CNF.
+  //
+  const bool knf = cardinality || guarded;
+  int64_t parsed[3] = { 0, 0, 0 };
+  vector<int> lits;
+  int ch;
+  while ((ch = parse_char ()) != EOF) {
+    if ((ch & ~7) || ((ch & 3) == BKNF_COMMENT && (ch & BKNF_ENCODING)))
+      BER ("invalid record type %d", ch);
+    const int type = ch & 3;
+    if (type == BKNF_COMMENT) {
+      uint64_t length;
+      if ((err = parse_varint (length, "comment length"))) return err;
+      while (length--)
+        if (parse_char () == EOF)
+          BER ("unexpected end-of-file in comment");
+      continue;
+    }
+    const bool encoding = (ch & BKNF_ENCODING);
+    int bound = 1, guard = 0, size;
+    if (type != BKNF_CLAUSE) {
+      if ((err = parse_binary_count (bound, "bound"))) return err;
+      if (!bound) BER ("expected positive bound");
+    }
+    uint64_t prev = 0;
+    if (type == BKNF_GUARDED &&
+        (err = parse_binary_lit (prev, guard, vars, strict))) return err;
+    if ((err = parse_binary_count (size, "size"))) return err;
+    prev = 0;
+    assert (lits.empty ());
+    while (size--) {
+      int lit;
+      if ((err = parse_binary_lit (prev, lit, vars, strict))) return err;
+      lits.push_back (lit);
+    }
+    if (strict != FORCED &&
+        parsed[0] + parsed[1] + parsed[2] >= total)
+      BER ("too many constraints");
+    parsed[type]++;
+    solver->transition_to_unknown_state ();
+    if (knf) external->CARadd_constraint (lits, bound, guard, encoding);
+    else external->add_clause (lits);
+    lits.clear ();
+  }
+
+  if (strict != FORCED) {
+    if (parsed[BKNF_CLAUSE] != clauses)
+      BER ("parsed %" PRId64 " clauses but expected %d",
+        parsed[BKNF_CLAUSE], clauses);
+    if (parsed[BKNF_CARDINALITY] != cardinality)
+      BER ("parsed %" PRId64 " cardinality constraints but expected %d",
+        parsed[BKNF_CARDINALITY], cardinality);
+    if (parsed[BKNF_GUARDED] != guarded)
+      BER ("parsed %" PRId64 " guarded constraints but expected %d",
+        parsed[BKNF_GUARDED], guarded);
+  }
+
+#ifndef QUIET
+  double end = internal->time ();
+  MSG ("parsed %" PRId64 " constraints in %.2f seconds %s time",
+    parsed[0] + parsed[1] + parsed[2], end - start,
+    internal->opts.realtime ? "real" : "process");
+#endif
+
+  return 0;
+}
+
+/*------------------------------------------------------------------------*/
+
 // Parsing solution in competition output format.
 
 const char * Parser::parse_solution_non_profiled () {
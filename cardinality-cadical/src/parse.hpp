@@ -33,6 +33,12 @@ class Parser {
   const char * parse_positive_int (int & ch, int & res, const char * name);
   const char * parse_lit (int & ch, int & lit, int & vars, int strict);
   const char * parse_dimacs_non_profiled (int & vars, int strict);
+
+  const char * parse_varint (uint64_t & res, const char * name);
+  const char * parse_binary_count (int & res, const char * name);
+  const char * parse_binary_lit (uint64_t & prev, int & lit,
+                                 int & vars, int strict);
+  const char * parse_binary_knf (int & vars, int strict);
   const char * parse_solution_non_profiled ();
 
   bool * parse_inccnf_too;
@@ -58,6 +64,7 @@ public:
   // form of parsing is enforced  for the value '2' of 'strict', in which
   // case the header can not have additional white space, while a value of
   // '1' exactly relaxes this, e.g., 'p cnf \t  1   3  \r\n' becomes legal.
+  // Files starting with the 'BKNF' signature are parsed as binary KNF.
   //
   const char * parse_dimacs (int & vars, int strict);
 
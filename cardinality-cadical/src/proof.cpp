@@ -25,6 +25,30 @@ void Internal::trace (File * file) {
   proof->connect (tracer);
 }
 
+// Enable VeriPB proof tracing with original constraints to 'formula'.
+
+void Internal::trace_veripb (File * file, File * formula) {
+  assert (!tracer);
+  assert (!pbtracer);
+  new_proof_on_demand ();
+  pbtracer = new VeripbTracer (this, file, formula);
+  LOG ("PROOF connecting VeriPB proof tracer");
+  proof->connect (pbtracer);
+}
+
+// Enable LRAT proof tracing with original and encoding clauses to 'formula'.
+
+void Internal::trace_lrat (File * file, File * formula) {
+  assert (!tracer);
+  assert (!pbtracer);
+  assert (!lrattracer);
+  new_proof_on_demand ();
+  lrat = true;
+  lrattracer = new LratTracer (this, file, formula, opts.binary);
+  LOG ("PROOF connecting LRAT proof tracer");
+  proof->connect (lrattracer);
+}
+
 // Enable proof checking.
 
 void Internal::check () {
@@ -38,15 +62,26 @@ void Internal::check () {
 // We want to close a proof trace and stop checking as soon we are done.
 
 void Internal::close_trace () {
-  assert (tracer);
-  tracer->close ();
+  assert (tracer || pbtracer || lrattracer);
+  if (tracer) tracer->close ();
+  if (pbtracer) pbtracer->close ();
+  if (lrattracer) lrattracer->close ();
+}
+
+bool Internal::trace_closed () {
+  assert (tracer || pbtracer || lrattracer);
+  if (tracer) return tracer->closed ();
+  if (pbtracer) return pbtracer->closed ();
+  return lrattracer->closed ();
 }
 
 // We can flush a proof trace file before actually closing it.
 
 void Internal::flush_trace () {
-  assert (tracer);
-  tracer->flush ();
+  assert (tracer || pbtracer || lrattracer);
+  if (tracer) tracer->flush ();
+  if (pbtracer) pbtracer->flush ();
+  if (lrattracer) lrattracer->flush ();
 }
 
 /*------------------------------------------------------------------------*/
@@ -74,54 +109,77 @@ inline void Proof::add_literals (const vector<int> & c) {
 
 /*------------------------------------------------------------------------*/
 
-void Proof::add_original_clause (const vector<int> & c) {
+void Proof::add_original_clause (int64_t id, const vector<int> & c) {
   LOG (c, "PROOF adding original internal clause");
   add_literals (c);
-  add_original_clause ();
+  add_original_clause (id);
+}
+
+void Proof::add_original_external_clause (int64_t id,
+                                          const vector<int> & c) {
+  LOG (c, "PROOF adding original external clause");
+  assert (clause.empty ());
+  clause = c;
+  add_original_clause (id);
+}
+
+void Proof::add_original_cardinality_constraint (int64_t id,
+                                                 const vector<int> & c,
+                                                 int bound, int guard) {
+  LOG (c, "PROOF adding original internal cardinality constraint");
+  add_literals (c);
+  const int external_guard = guard ? internal->externalize (guard) : 0;
+  for (size_t i = 0; i < observers.size (); i++)
+    observers[i]->add_original_cardinality_constraint (id, clause, bound,
+                                                       external_guard);
+  clause.clear ();
 }
 
-void Proof::add_derived_empty_clause () {
+void Proof::add_derived_empty_clause (int64_t id,
+                                      const vector<int64_t> & chain) {
   LOG ("PROOF adding empty clause");
   assert (clause.empty ());
-  add_derived_clause ();
+  add_derived_clause (id, chain);
 }
 
-void Proof::add_derived_unit_clause (int internal_unit) {
+void Proof::add_derived_unit_clause (int64_t id, int internal_unit,
+                                     const vector<int64_t> & chain) {
   LOG ("PROOF adding unit clause %d", internal_unit);
   assert (clause.empty ());
   add_literal (internal_unit);
-  add_derived_clause ();
+  add_derived_clause (id, chain);
 }
 
 /*------------------------------------------------------------------------*/
 
-void Proof::add_derived_clause (Clause * c) {
+void Proof::add_derived_clause (Clause * c, const vector<int64_t> & chain) {
   LOG (c, "PROOF adding to proof derived");
   assert (clause.empty ());
   add_literals (c);
-  add_derived_clause ();
+  add_derived_clause (c->id, chain);
 }
 
 void Proof::delete_clause (Clause * c) {
   LOG (c, "PROOF deleting from proof");
   assert (clause.empty ());
   add_literals (c);
-  delete_clause ();
+  delete_clause (c->id);
 }
 
-void Proof::delete_clause (const vector<int> & c) {
+void Proof::delete_clause (int64_t id, const vector<int> & c) {
   LOG (c, "PROOF deleting from proof");
   assert (clause.empty ());
   add_literals (c);
-  delete_clause ();
+  delete_clause (id);
 }
 
-void Proof::add_derived_clause (const vector<int> & c) {
+void Proof::add_derived_clause (int64_t id, const vector<int> & c,
+                                const vector<int64_t> & chain) {
   LOG (internal->clause, "PROOF adding derived clause");
   assert (clause.empty ());
   for (const auto & lit : c)
     add_literal (lit);
-  add_derived_clause ();
+  add_derived_clause (id, chain);
 }
 
 /*------------------------------------------------------------------------*/
@@ -130,7 +188,8 @@ void Proof::add_derived_clause (const vector<int> & c) {
 // literals. To avoid copying the clause, we provide a specialized tracing
 // function here, which traces the required 'add' and 'remove' operations.
 
-void Proof::flush_clause (Clause * c) {
+void Proof::flush_clause (Clause * c, int64_t id,
+                          const vector<int64_t> & chain) {
   LOG (c, "PROOF flushing falsified literals in");
   assert (clause.empty ());
   for (int i = 0; i < c->size; i++) {
@@ -138,7 +197,7 @@ void Proof::flush_clause (Clause * c) {
     if (internal->fixed (internal_lit) < 0) continue;
     add_literal (internal_lit);
   }
-  add_derived_clause ();
+  add_derived_clause (id, chain);
   delete_clause (c);
 }
 
@@ -148,7 +207,7 @@ void Proof::flush_clause (Clause * c) {
 // to avoid copying the clause and instead provides tracing of the required
 // 'add' and 'remove' operations.
 
-void Proof::strengthen_clause (Clause * c, int remove) {
+void Proof::strengthen_clause (Clause * c, int remove, int64_t id) {
   LOG (c, "PROOF strengthen by removing %d in", remove);
   assert (clause.empty ());
   for (int i = 0; i < c->size; i++) {
@@ -156,30 +215,30 @@ void Proof::strengthen_clause (Clause * c, int remove) {
     if (internal_lit == remove) continue;
     add_literal (internal_lit);
   }
-  add_derived_clause ();
+  add_derived_clause (id, internal->lrat_chain);
   delete_clause (c);
 }
 
 /*------------------------------------------------------------------------*/
 
-void Proof::add_original_clause () {
+void Proof::add_original_clause (int64_t id) {
   LOG (clause, "PROOF adding original external clause");
   for (size_t i = 0; i < observers.size (); i++)
-    observers[i]->add_original_clause (clause);
+    observers[i]->add_original_clause (id, clause);
   clause.clear ();
 }
 
-void Proof::add_derived_clause () {
+void Proof::add_derived_clause (int64_t id, const vector<int64_t> & chain) {
   LOG (clause, "PROOF adding derived external clause");
   for (size_t i = 0; i < observers.size (); i++)
-    observers[i]->add_derived_clause (clause);
+    observers[i]->add_derived_clause (id, clause, chain);
   clause.clear ();
 }
 
-void Proof::delete_clause () {
+void Proof::delete_clause (int64_t id) {
   LOG (clause, "PROOF deleting external clause");
   for (size_t i = 0; i < observers.size (); i++)
-    observers[i]->delete_clause (clause);
+    observers[i]->delete_clause (id, clause);
   clause.clear ();
 }
 
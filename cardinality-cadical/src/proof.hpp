@@ -26,9 +26,11 @@ class Proof {
 
   void add_literals (const vector<int> &);      // ditto
 
-  void add_original_clause ();  // notify observers of original clauses
-  void add_derived_clause ();   // notify observers of derived clauses
-  void delete_clause ();        // notify observers of deleted clauses
+  // Notify observers of original, derived and deleted clauses.
+  //
+  void add_original_clause (int64_t id);
+  void add_derived_clause (int64_t id, const vector<int64_t> & chain);
+  void delete_clause (int64_t id);
 
 public:
 
@@ -37,24 +39,35 @@ public:
 
   void connect (Observer * v) { observers.push_back (v); }
 
-  // Add original clauses to the proof (for online proof checking).
+  // Add original clauses to the proof (for online proof checking).  The
+  // clausal encoding of cardinality constraints for proofs with hints
+  // refers to auxiliary variables and thus is already external.
   //
-  void add_original_clause (const vector<int> &);
-
-  // Add derived (such as learned) clauses to the proof.
+  void add_original_clause (int64_t id, const vector<int> &);
+  void add_original_external_clause (int64_t id, const vector<int> &);
+  void add_original_cardinality_constraint (int64_t id,
+                                            const vector<int> &,
+                                            int bound, int guard);
+
+  // Add derived (such as learned) clauses to the proof.  The 'chain' of
+  // antecedent clause identifiers is empty unless 'lrat' is enabled.
   //
-  void add_derived_empty_clause ();
-  void add_derived_unit_clause (int unit);
-  void add_derived_clause (Clause *);
-  void add_derived_clause (const vector<int> &);
-
-  void delete_clause (const vector<int> &);
+  void add_derived_empty_clause (int64_t id, const vector<int64_t> & chain);
+  void add_derived_unit_clause (int64_t id, int unit,
+                                const vector<int64_t> & chain);
+  void add_derived_clause (Clause *, const vector<int64_t> & chain);
+  void add_derived_clause (int64_t id, const vector<int> &,
+                           const vector<int64_t> & chain);
+
+  void delete_clause (int64_t id, const vector<int> &);
   void delete_clause (Clause *);
 
-  // These two actually pretend to add and remove a clause.
+  // These two actually pretend to add and remove a clause.  The clause
+  // gets the new identifier 'id' which has to be updated by the caller.
   //
-  void flush_clause (Clause *);           // remove falsified literals
-  void strengthen_clause (Clause *, int); // remove second argument
+  void flush_clause (Clause *, int64_t id,        // remove falsified
+                     const vector<int64_t> & chain); // literals
+  void strengthen_clause (Clause *, int, int64_t id); // remove second
 
   void flush ();
 };
@@ -63,7 +63,10 @@ inline void Internal::search_assign (int lit, Clause * reason) {
   else if (reason == decision_reason) lit_level = level, reason = 0;
   else if (opts.chrono) lit_level = assignment_level (lit, reason);
   else lit_level = level;
-  if (!lit_level) reason = 0;
+  if (!lit_level) {
+    if (lrat && reason) lrat_chain_for_root (lit, reason);
+    reason = 0;
+  }
 
   v.level = lit_level;
   v.trail = (int) trail.size ();
@@ -343,136 +346,97 @@ bool Internal::CARpropagate () {
 
             const int unwatched = w.clause->unwatched;
 
-            // check if this is a unit cardinality constraint
-            if (unwatched == w.clause->size) {
-              // try propagating or hit a conflict
-              assert (!cardinality_conflict_literal);
-              for (int i = 0; i < unwatched; i++) {
-                if (lits[i] != lit && val (lits[i]) < 0) {cardinality_conflict_literal = lits[i]; break;}
-              }
-
-              if (!cardinality_conflict_literal) { // propagate all other watches
-
-                for (int i = 0; i < unwatched; i++) { 
-                  if (lits[i] != lit) assert (val (lits[i]) >= 0);
-                  if (val (lits[i]) == 0) {
-                    car_propagated_literals++;
-                    search_assign (lits[i], w.clause);
-                  } else { if (lits[i] != lit) {
-                      mptab[abs(lits[i])]++;
-                      car_missed_propagated_literals++;
-                    }
-                  }
-                }
-
-                w.clause->reason_literal = lit; // update reason for propagation
-
-                car_propagation++; // increment propagation count
-
-              } else { //  conflict
-                // More than one watch assigned to false, breaking cardinality constraint
-
-                conflict = w.clause;
-
-                w.clause->reason_literal = lit; // update reason for propagation
-                car_conflict++;
+            // next check if there is a falsified watch
 
-                break;
-              }
-            } else {
+            int falsified = 0, pos_falsified = -1;
+            for (int i = 0; i < unwatched; i++) { 
+              if (val (lits[i]) < 0) {falsified++; pos_falsified = i;}
+              if (falsified > 1) break;
+            }
 
-              // next check if there is a falsified watch
+            if (falsified == 1) {
+              // a chance that we should propagate the cardinality constraint
 
-              int falsified = 0, pos_falsified = -1;
-              for (int i = 0; i < unwatched; i++) { 
-                if (val (lits[i]) < 0) {falsified++; pos_falsified = i;}
-                if (falsified > 1) break;
-              }
+              // check if we can swap this lit
+              const int size = w.clause->size;
+              const literal_iterator middle = lits + w.clause->pos;
+              const const_literal_iterator end = lits + size;
+              literal_iterator k = middle;
 
-              if (falsified == 1) {
-                // a chance that we should propagate the cardinality constraint
+              int lit_falsified = lits[pos_falsified];
 
-                // check if we can swap this lit
-                const int size = w.clause->size;
-                const literal_iterator middle = lits + w.clause->pos;
-                const const_literal_iterator end = lits + size;
-                literal_iterator k = middle;
+              // Find replacement watch 'r' at position 'k' with value 'v'.
 
-                int lit_falsified = lits[pos_falsified];
+              int r = 0;
+              signed char v = -1;
+              if (size > unwatched) { // at least 1 unwatched literal
 
-                // Find replacement watch 'r' at position 'k' with value 'v'.
+                while (k != end && (v = val (r = *k)) < 0)
+                  k++;
 
-                int r = 0;
-                signed char v = -1;
-                if (size > unwatched) { // at least 1 unwatched literal
+                if (v < 0) {  // need second search starting at the head?
 
-                  while (k != end && (v = val (r = *k)) < 0)
+                  k = lits + unwatched;
+                  assert (w.clause->pos <= size);
+                  while (k != middle && (v = val (r = *k)) < 0)
                     k++;
+                }
 
-                  if (v < 0) {  // need second search starting at the head?
-
-                    k = lits + unwatched;
-                    assert (w.clause->pos <= size);
-                    while (k != middle && (v = val (r = *k)) < 0)
-                      k++;
-                  }
-
-                  w.clause->pos = k - lits;  // always save position
-
-                  assert (lits + unwatched <= k), assert (k <= w.clause->end ());
-                } //else every literal is watched, no replacement possible
+                w.clause->pos = k - lits;  // always save position
 
+                assert (lits + unwatched <= k), assert (k <= w.clause->end ());
+              } //else every literal is watched, no replacement possible
 
-                if (v >= 0) { // Replacement satisfied or unassigned, simple swap
 
-                  assert (k-lits >= unwatched); // k is not watched currently
+              if (v >= 0) { // Replacement satisfied or unassigned, simple swap
 
-                  // swap position
-                  lits[pos_falsified] = r;
-                  *k = lit_falsified;
-                  
-                  // watch new literal at position my_lit_pos
-                  CARwatch_literal (r, pos_falsified, w.clause);
-                  remove_watch (watches (lit_falsified), w.clause);
-                  LOG (w.clause, "unwatch %d in", lit_falsified);
+                assert (k-lits >= unwatched); // k is not watched currently
 
-                } else {
-
-                  // check if we can propagate all unassigned watched literals
-                  // i.e., no other watched literal falsified
-                  assert (!cardinality_conflict_literal);
-                  // cardinality_conflict_literal = lit_falsified;
-                  // for (int i = 0; i < unwatched; i++) {
-                  //   if (lits[i] != lit_falsified && val (lits[i]) < 0) {cardinality_conflict_literal = lits[i]; break;}
-                  // }
+                // swap position
+                lits[pos_falsified] = r;
+                *k = lit_falsified;
+                
+                // watch new literal at position my_lit_pos
+                CARwatch_literal (r, pos_falsified, w.clause);
+                remove_watch (watches (lit_falsified), w.clause);
+                LOG (w.clause, "unwatch %d in", lit_falsified);
+
+              } else {
+
+                // check if we can propagate all unassigned watched literals
+                // i.e., no other watched literal falsified
+                assert (!cardinality_conflict_literal);
+                // cardinality_conflict_literal = lit_falsified;
+                // for (int i = 0; i < unwatched; i++) {
+                //   if (lits[i] != lit_falsified && val (lits[i]) < 0) {cardinality_conflict_literal = lits[i]; break;}
+                // }
 
-                  assert (!guard_literal || val (guard_literal) < 0);
+                assert (!guard_literal || val (guard_literal) < 0);
 
-                  for (int i = 0; i < unwatched; i++) { 
-                    if (lits[i] != lit_falsified) assert (val (lits[i]) >= 0);
-                    if (val (lits[i]) == 0) {
-                      car_propagated_literals++;
-                      search_assign (lits[i], w.clause);
-                    } else { if (lits[i] != lit_falsified) {
-                        mptab[abs(lits[i])]++;
-                        car_missed_propagated_literals++;
-                      }
+                for (int i = 0; i < unwatched; i++) { 
+                  if (lits[i] != lit_falsified) assert (val (lits[i]) >= 0);
+                  if (val (lits[i]) == 0) {
+                    car_propagated_literals++;
+                    search_assign (lits[i], w.clause);
+                  } else { if (lits[i] != lit_falsified) {
+                      mptab[abs(lits[i])]++;
+                      car_missed_propagated_literals++;
                     }
                   }
+                }
 
-                  w.clause->reason_literal = lit_falsified; // update reason for propagation
+                w.clause->reason_literal = lit_falsified; // update reason for propagation
 
-                  car_propagation++; // increment propagation count
+                car_propagation++; // increment propagation count
 
-                  // guard literal options here
-                  /*
-                    Problem with assigning guard literal here is there is no reason
-                    would need to assign when guarded (-lit) is falsified. Hmmm, assigning here probably better for descrepancy problem though.
-                  */
-                  // if (guard_literal && !guard_val) 
-                  //   search_assign (-guard_literal, w.clause);
-                  
-                }
+                // guard literal options here
+                /*
+                  Problem with assigning guard literal here is there is no reason
+                  would need to assign when guarded (-lit) is falsified. Hmmm, assigning here probably better for descrepancy problem though.
+                */
+                // if (guard_literal && !guard_val) 
+                //   search_assign (-guard_literal, w.clause);
+                
               }
             }
           } else {
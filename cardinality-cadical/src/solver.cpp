@@ -548,6 +548,35 @@ void Solver::CARaddGuard (int lit) {
   LOG_API_CALL_END ("add", lit);
 }
 
+void Solver::CARadd_constraint (const int * lits, size_t size,
+                                int bound, int guard) {
+  LOG_API_CALL_BEGIN ("CARadd_constraint", bound);
+  REQUIRE_VALID_STATE ();
+  REQUIRE (!adding_clause,
+    "can not add a whole constraint while adding a clause or constraint");
+  REQUIRE (bound > 0, "invalid cardinality bound %d", bound);
+  REQUIRE (lits || !size, "zero literal array");
+  if (guard) REQUIRE_VALID_LIT (guard);
+  for (size_t i = 0; i < size; i++) REQUIRE_VALID_LIT (lits[i]);
+  transition_to_unknown_state ();
+  external->CARadd_constraint (vector<int> (lits, lits + size), bound, guard, false);
+  if (!adding_constraint) STATE (UNKNOWN);
+  LOG_API_CALL_END ("CARadd_constraint", bound);
+}
+
+void Solver::add_clause (const int * lits, size_t size) {
+  LOG_API_CALL_BEGIN ("add_clause");
+  REQUIRE_VALID_STATE ();
+  REQUIRE (!adding_clause,
+    "can not add a whole clause while adding a clause or constraint");
+  REQUIRE (lits || !size, "zero literal array");
+  for (size_t i = 0; i < size; i++) REQUIRE_VALID_LIT (lits[i]);
+  transition_to_unknown_state ();
+  external->add_clause (vector<int> (lits, lits + size));
+  if (!adding_constraint) STATE (UNKNOWN);
+  LOG_API_CALL_END ("add_clause");
+}
+
 void Solver::add (int lit) {
   TRACE ("add", lit);
   REQUIRE_VALID_STATE ();
@@ -794,6 +823,35 @@ void Solver::disconnect_learner () {
   LOG_API_CALL_END ("disconnect_learner");
 }
 
+/*------------------------------------------------------------------------*/
+
+void Solver::connect_importer (Importer * importer) {
+  LOG_API_CALL_BEGIN ("connect_importer");
+  REQUIRE_VALID_STATE ();
+  REQUIRE (importer, "can not connect zero importer");
+#ifdef LOGGING
+  if (external->importer)
+    LOG ("connecting new importer (disconnecting previous one)");
+  else
+    LOG ("connecting new importer (no previous one)");
+#endif
+  external->importer = importer;
+  LOG_API_CALL_END ("connect_importer");
+}
+
+void Solver::disconnect_importer () {
+  LOG_API_CALL_BEGIN ("disconnect_importer");
+  REQUIRE_VALID_STATE ();
+#ifdef LOGGING
+    if (external->importer)
+      LOG ("disconnecting previous importer");
+    else
+      LOG ("ignoring to disconnect importer (no previous one)");
+#endif
+  external->importer = 0;
+  LOG_API_CALL_END ("disconnect_importer");
+}
+
 /*===== IPASIR END =======================================================*/
 
 int Solver::active () const {
@@ -857,7 +915,13 @@ bool Solver::trace_proof (FILE * external_file, const char * name) {
   REQUIRE (state () == CONFIGURING,
     "can only start proof tracing to '%s' right after initialization",
     name);
-  REQUIRE (!internal->tracer, "already tracing proof");
+  REQUIRE (!internal->tracer && !internal->pbtracer &&
+           !internal->lrattracer,
+    "already tracing proof");
+  REQUIRE (!internal->opts.veripb,
+    "VeriPB proof tracing needs a path for the formula");
+  REQUIRE (!internal->opts.lrat,
+    "LRAT proof tracing needs a path for the formula");
   File * internal_file = File::write (internal, external_file, name);
   assert (internal_file);
   internal->trace (internal_file);
@@ -871,10 +935,34 @@ bool Solver::trace_proof (const char * path) {
   REQUIRE (state () == CONFIGURING,
     "can only start proof tracing to '%s' right after initialization",
     path);
-  REQUIRE (!internal->tracer, "already tracing proof");
+  REQUIRE (!internal->tracer && !internal->pbtracer &&
+           !internal->lrattracer,
+    "already tracing proof");
   File * internal_file = File::write (internal, path);
   bool res = (internal_file != 0);
-  internal->trace (internal_file);
+  if (internal->opts.veripb) {
+    // The original constraints go to '<path>.opb'.
+    string formula_path = string (path) + ".opb";
+    File * formula_file = File::write (internal, formula_path.c_str ());
+    if (res && formula_file)
+      internal->trace_veripb (internal_file, formula_file);
+    else {
+      delete internal_file;
+      delete formula_file;
+      res = false;
+    }
+  } else if (internal->opts.lrat) {
+    // The original and encoding clauses go to '<path>.cnf'.
+    string formula_path = string (path) + ".cnf";
+    File * formula_file = File::write (internal, formula_path.c_str ());
+    if (res && formula_file)
+      internal->trace_lrat (internal_file, formula_file);
+    else {
+      delete internal_file;
+      delete formula_file;
+      res = false;
+    }
+  } else internal->trace (internal_file);
   LOG_API_CALL_RETURNS ("trace_proof", path, res);
   return res;
 }
@@ -882,8 +970,9 @@ bool Solver::trace_proof (const char * path) {
 void Solver::flush_proof_trace () {
   LOG_API_CALL_BEGIN ("flush_proof_trace");
   REQUIRE_VALID_STATE ();
-  REQUIRE (internal->tracer, "proof is not traced");
-  REQUIRE (!internal->tracer->closed (), "proof trace already closed");
+  REQUIRE (internal->tracer || internal->pbtracer || internal->lrattracer,
+    "proof is not traced");
+  REQUIRE (!internal->trace_closed (), "proof trace already closed");
   internal->flush_trace ();
   LOG_API_CALL_END ("flush_proof_trace");
 }
@@ -891,8 +980,9 @@ void Solver::flush_proof_trace () {
 void Solver::close_proof_trace () {
   LOG_API_CALL_BEGIN ("close_proof_trace");
   REQUIRE_VALID_STATE ();
-  REQUIRE (internal->tracer, "proof is not traced");
-  REQUIRE (!internal->tracer->closed (), "proof trace already closed");
+  REQUIRE (internal->tracer || internal->pbtracer || internal->lrattracer,
+    "proof is not traced");
+  REQUIRE (!internal->trace_closed (), "proof trace already closed");
   internal->close_trace ();
   LOG_API_CALL_END ("close_proof_trace");
 }
@@ -147,6 +147,11 @@ void Stats::print (Internal * internal) {
   PRT ("  promoted2:     %15" PRId64 "   %10.2f %%  per learned", stats.promoted2, percent (stats.promoted2, stats.learned.clauses));
   PRT ("  improvedglue:  %15" PRId64 "   %10.2f %%  per learned", stats.improvedglue, percent (stats.improvedglue, stats.learned.clauses));
   }
+  if (all || stats.imported.clauses) {
+  PRT ("imported:        %15" PRId64 "   %10.2f %%  per conflict", stats.imported.clauses, percent (stats.imported.clauses, stats.conflicts));
+  PRT ("  importedunits: %15" PRId64 "   %10.2f %%  per imported", stats.imported.units, percent (stats.imported.units, stats.imported.clauses));
+  PRT ("  importskipped: %15" PRId64 "   %10.2f %%  per imported", stats.imported.skipped, percent (stats.imported.skipped, stats.imported.clauses));
+  }
   if (all || stats.lucky.succeeded) {
   PRT ("lucky:           %15" PRId64 "   %10.2f %%  of tried", stats.lucky.succeeded, percent (stats.lucky.succeeded, stats.lucky.tried));
   PRT ("  constantzero   %15" PRId64 "   %10.2f %%  of tried", stats.lucky.constant.zero, percent (stats.lucky.constant.zero, stats.lucky.tried));
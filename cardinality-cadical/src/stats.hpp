@@ -73,6 +73,12 @@ struct Stats {
     struct { int64_t positive, negative; } horn;
   } lucky;
 
+  struct {
+    int64_t clauses;    // imported clauses (including units)
+    int64_t units;      // imported unit clauses
+    int64_t skipped;    // satisfied or with inactive variables
+  } imported;
+
   struct {
     int64_t total;      // total number of happened rephases
     int64_t best;       // how often reset to best phases
@@ -160,7 +160,12 @@ void Internal::strengthen_clause (Clause * c, int lit) {
   stats.strengthened++;
   assert (c->size > 2);
   LOG (c, "removing %d in", lit);
-  if (proof) proof->strengthen_clause (c, lit);
+  if (proof) {
+    const int64_t id = ++clause_id;
+    proof->strengthen_clause (c, lit, id);
+    lrat_chain.clear ();
+    c->id = id;
+  }
   if (!c->redundant) mark_removed (lit);
   auto new_end = remove (c->begin (), c->end (), lit);
   assert (new_end + 1 == c->end ()), (void) new_end;
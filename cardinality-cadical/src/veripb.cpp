@@ -0,0 +1,186 @@
+#include "internal.hpp"
+
+namespace CaDiCaL {
+
+/*------------------------------------------------------------------------*/
+
+VeripbTracer::VeripbTracer (Internal * i, File * f, File * g) :
+  internal (i),
+  file (f), formula (g), begun (false),
+  originals (0), added (0), deleted (0), late (0), empty (0), max_var (0)
+{
+  (void) internal;
+  LOG ("VERIPB new");
+}
+
+VeripbTracer::~VeripbTracer () {
+  LOG ("VERIPB delete");
+  delete file;
+  delete formula;
+}
+
+/*------------------------------------------------------------------------*/
+
+// Literals are written as 'x<idx>' and negated as '~x<idx>'.
+
+inline void VeripbTracer::put_lit (File * f, int coeff, int lit) {
+  assert (coeff > 0);
+  assert (lit != INT_MIN);
+  f->put (coeff), f->put (' ');
+  if (lit < 0) f->put ('~');
+  f->put ('x'), f->put (abs (lit)), f->put (' ');
+}
+
+// Clauses are identified by their sorted literals, and we keep a stack of
+// identifiers for each to cope with duplicated clauses.
+
+void VeripbTracer::remember (const vector<int> & clause, int64_t id) {
+  vector<int> key = clause;
+  sort (key.begin (), key.end ());
+  ids[key].push_back (id);
+}
+
+int64_t VeripbTracer::forget (const vector<int> & clause) {
+  vector<int> key = clause;
+  sort (key.begin (), key.end ());
+  auto it = ids.find (key);
+  if (it == ids.end ()) return 0;
+  const int64_t res = it->second.back ();
+  it->second.pop_back ();
+  if (it->second.empty ()) ids.erase (it);
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+void VeripbTracer::add_original_clause (int64_t id,
+                                        const vector<int> & clause) {
+  add_original_cardinality_constraint (id, clause, 1, 0);
+}
+
+// The OPB header needs the number of variables and constraints, thus the
+// original constraints are only buffered here and written at proof start.
+
+void VeripbTracer::add_original_cardinality_constraint (
+  int64_t, const vector<int> & lits, int bound, int guard)
+{
+  if (formula->closed ()) return;
+  if (begun) {
+    LOG ("VERIPB can not trace original constraint after proof start");
+    late++;
+    return;
+  }
+  LOG ("VERIPB tracing original constraint");
+  assert (bound > 0);
+  constraints.push_back (bound);
+  constraints.push_back (guard);
+  constraints.push_back (lits.size ());
+  for (const auto & external_lit : lits) {
+    constraints.push_back (external_lit);
+    max_var = max (max_var, abs (external_lit));
+  }
+  if (guard) max_var = max (max_var, abs (guard));
+  originals++;
+  if (bound == 1 && !guard) remember (lits, originals);
+}
+
+/*------------------------------------------------------------------------*/
+
+void VeripbTracer::trace_derived_clause (const vector<int> & clause) {
+  const int64_t id = originals + ++added;
+  file->put ("rup ");
+  for (const auto & external_lit : clause)
+    put_lit (file, 1, external_lit);
+  file->put (">= 1 ;\n");
+  if (clause.empty ()) { if (!empty) empty = id; }
+  else remember (clause, id);
+}
+
+// Deleting clauses unknown to the proof, e.g., encoding clauses which are
+// not traced, is simply skipped.
+
+void VeripbTracer::trace_delete_clause (const vector<int> & clause) {
+  const int64_t id = forget (clause);
+  if (!id) return;
+  file->put ("del id "), file->put (id), file->put ('\n');
+  deleted++;
+}
+
+void VeripbTracer::add_derived_clause (int64_t, const vector<int> & clause,
+                                       const vector<int64_t> &) {
+  if (file->closed ()) return;
+  LOG ("VERIPB tracing addition of derived clause");
+  if (begun) trace_derived_clause (clause);
+  else pending.push_back ({true, clause});
+}
+
+void VeripbTracer::delete_clause (int64_t, const vector<int> & clause) {
+  if (file->closed ()) return;
+  LOG ("VERIPB tracing deletion of clause");
+  if (begun) trace_delete_clause (clause);
+  else pending.push_back ({false, clause});
+}
+
+/*------------------------------------------------------------------------*/
+
+// A guarded constraint is satisfied by its guard, thus the guard gets the
+// bound as coefficient: 'bound guard + lit_1 + ... + lit_n >= bound'.
+
+void VeripbTracer::write_formula () {
+  formula->put ("* #variable= "), formula->put (max_var);
+  formula->put (" #constraint= "), formula->put (originals);
+  formula->put ('\n');
+  const int * p = constraints.data (), * end = p + constraints.size ();
+  while (p < end) {
+    const int bound = *p++, guard = *p++, size = *p++;
+    if (guard) put_lit (formula, bound, guard);
+    for (const int * q = p + size; p < q; p++)
+      put_lit (formula, 1, *p);
+    formula->put (">= "), formula->put (bound), formula->put (" ;\n");
+  }
+  erase_vector (constraints);
+}
+
+void VeripbTracer::begin_proof () {
+  if (begun || file->closed ()) return;
+  begun = true;
+  LOG ("VERIPB loading %" PRId64 " original constraints", originals);
+  if (!formula->closed ()) write_formula ();
+  file->put ("pseudo-Boolean proof version 2.0\n");
+  file->put ("f "), file->put (originals), file->put (" ;\n");
+  for (const auto & step : pending)
+    if (step.first) trace_derived_clause (step.second);
+    else trace_delete_clause (step.second);
+  erase_vector (pending);
+  formula->flush ();
+}
+
+/*------------------------------------------------------------------------*/
+
+bool VeripbTracer::closed () { return file->closed (); }
+
+void VeripbTracer::close () {
+  assert (!closed ());
+  begin_proof ();
+  file->put ("output NONE ;\n");
+  if (empty) {
+    file->put ("conclusion UNSAT : "), file->put (empty), file->put (" ;\n");
+  } else file->put ("conclusion NONE ;\n");
+  file->put ("end pseudo-Boolean proof ;\n");
+  file->close ();
+  if (!formula->closed ()) formula->close ();
+}
+
+void VeripbTracer::flush () {
+  assert (!closed ());
+  file->flush ();
+  if (!formula->closed ()) formula->flush ();
+  MSG ("traced %" PRId64 " original constraints, "
+    "%" PRId64 " added and %" PRId64 " deleted clauses",
+    originals, added, deleted);
+  if (late)
+    MSG ("ignored %" PRId64 " original constraints added after proof start",
+      late);
+}
+
+}
@@ -0,0 +1,83 @@
+#ifndef _veripb_h_INCLUDED
+#define _veripb_h_INCLUDED
+
+#include "observer.hpp" // Alphabetically after 'veripb'.
+
+#include <unordered_map>
+
+// Proof tracing in the pseudo-Boolean VeriPB format.  In contrast to DRAT
+// the original cardinality constraints are written as pseudo-Boolean
+// constraints to a separate OPB formula file, which allows the checker to
+// justify cardinality propagations directly from the constraints.  Thus
+// the clausal encoding and its derivation are not needed anymore.
+
+namespace CaDiCaL {
+
+struct VeripbClauseHash {
+  size_t operator () (const vector<int> & clause) const {
+    uint64_t res = 0;
+    for (const auto & lit : clause)
+      res = (res + (unsigned) lit) * 1111111121u;
+    return res;
+  }
+};
+
+class VeripbTracer : public Observer {
+
+  Internal * internal;
+  File * file;                  // proof steps
+  File * formula;               // original constraints in OPB format
+  bool begun;                   // 'f' step written
+
+  int64_t originals, added, deleted, late;
+  int64_t empty;                // identifier of derived empty clause
+  int max_var;                  // of the original constraints
+
+  // Original constraints as 'bound guard size lit_1 ... lit_size' until
+  // the formula is written with its '#variable= #constraint=' header.
+  //
+  vector<int> constraints;
+
+  // Constraint identifiers of clauses in the proof database (for 'del').
+  //
+  unordered_map<vector<int>, vector<int64_t>, VeripbClauseHash> ids;
+
+  // Proof steps traced before the formula is complete (while parsing).
+  //
+  vector<pair<bool, vector<int>>> pending;
+
+  void put_lit (File *, int coeff, int external_lit);
+  void remember (const vector<int> &, int64_t id);
+  int64_t forget (const vector<int> &);
+
+  void write_formula ();
+  void trace_derived_clause (const vector<int> &);
+  void trace_delete_clause (const vector<int> &);
+
+public:
+
+  // Own and delete 'file' and 'formula'.
+  //
+  VeripbTracer (Internal *, File * file, File * formula);
+  ~VeripbTracer ();
+
+  void add_original_clause (int64_t, const vector<int> &);
+  void add_original_cardinality_constraint (int64_t, const vector<int> &,
+                                            int bound, int guard);
+  void add_derived_clause (int64_t, const vector<int> &,
+                           const vector<int64_t> &);
+  void delete_clause (int64_t, const vector<int> &);
+
+  // Write the formula and the loading step.  Original constraints added later
+  // can not be referenced anymore (non-incremental format).
+  //
+  void begin_proof ();
+
+  bool closed ();
+  void close ();
+  void flush ();
+};
+
+}
+
+#endif
@@ -0,0 +1,62 @@
+#include "../../src/ccadical.h"
+#include "../../src/ipasir.h"
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+
+#include <assert.h>
+
+static const int n = 6;
+
+static int ph (int p, int h) { return 1 + h * (n+1) + p; }
+
+int main () {
+  CCaDiCaL * solver = ccadical_init ();
+  int lits[] = { 1, 2, 3 }, unit[] = { -1 }, res;
+
+  // at least 2 of 1, 2, 3 (from an array) and -1
+  ccadical_add_cardinality (solver, 2, 0, lits, 3);
+  ccadical_add_clause (solver, unit, 1);
+  res = ccadical_solve (solver);
+  assert (res == 10);
+  assert (ccadical_val (solver, 2) > 0);
+  assert (ccadical_val (solver, 3) > 0);
+  ccadical_assume (solver, -2);
+  res = ccadical_solve (solver);
+  assert (res == 20);
+  assert (ccadical_failed (solver, -2));
+
+  // at least 3 of 1, 2, 3 unless 4 (literal by literal)
+  ccadical_add_card (solver, 3);
+  ccadical_add_card_guard (solver, 4);
+  ccadical_add_card (solver, 1);
+  ccadical_add_card (solver, 2);
+  ccadical_add_card (solver, 3);
+  ccadical_add_card (solver, 0);
+  res = ccadical_solve (solver);
+  assert (res == 10);
+  assert (ccadical_val (solver, 4) > 0);
+  ccadical_assume (solver, -4);
+  res = ccadical_solve (solver);
+  assert (res == 20);
+  ccadical_release (solver);
+
+  // pigeon hole with 'n+1' pigeons and 'n' holes through IPASIR, where
+  // every hole has at least 'n' of the 'n+1' pigeons absent
+  void * ipasir = ipasir_init ();
+  int clause[n], absent[n+1];
+  for (int p = 0; p < n + 1; p++) {
+    for (int h = 0; h < n; h++) clause[h] = ph (p, h);
+    ipasir_add_clause (ipasir, clause, n);
+  }
+  for (int h = 0; h < n; h++) {
+    for (int p = 0; p < n + 1; p++) absent[p] = -ph (p, h);
+    ipasir_add_cardinality (ipasir, n, 0, absent, n + 1);
+  }
+  res = ipasir_solve (ipasir);
+  assert (res == 20);
+  ipasir_release (ipasir);
+
+  return 0;
+}
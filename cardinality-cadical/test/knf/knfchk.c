@@ -0,0 +1,134 @@
+// Checks that the solution ('s SATISFIABLE' and 'v' lines) written by the
+// solver satisfies a KNF formula, i.e., every clause, every cardinality
+// constraint 'k <bound> <lits> 0' and every guarded constraint 'g <bound>
+// <guard> <lits> 0' (which a true guard satisfies).  Encoding constraints
+// prefixed with 'e' are checked too.
+//
+//   knfchk <knf> <solution>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <ctype.h>
+
+static void
+die (const char * fmt, ...)
+{
+  va_list ap;
+  fputs ("*** knfchk: ", stdout);
+  va_start (ap, fmt);
+  vfprintf (stdout, fmt, ap);
+  va_end (ap);
+  fputc ('\n', stdout);
+  exit (1);
+}
+
+static signed char * vals;      // indexed by variable
+static int size_vals;
+
+static void
+set_val (int lit)
+{
+  int idx = abs (lit);
+  if (idx >= size_vals)
+    {
+      int new_size = size_vals ? 2 * size_vals : 1024;
+      while (new_size <= idx) new_size *= 2;
+      if (!(vals = realloc (vals, new_size))) die ("out of memory");
+      memset (vals + size_vals, 0, new_size - size_vals);
+      size_vals = new_size;
+    }
+  if (vals[idx]) die ("variable %d assigned twice", idx);
+  vals[idx] = lit < 0 ? -1 : 1;
+}
+
+// Unassigned variables are considered false.
+
+static int
+val (int lit)
+{
+  int idx = abs (lit), res = idx < size_vals ? vals[idx] : 0;
+  if (!res) res = -1;
+  return lit < 0 ? -res : res;
+}
+
+static void
+parse_solution (const char * name)
+{
+  FILE * file = fopen (name, "r");
+  if (!file) die ("can not read '%s'", name);
+  char * line = 0;
+  size_t capacity = 0;
+  int satisfiable = 0;
+  while (getline (&line, &capacity, file) > 0)
+    if (line[0] == 's')
+      {
+	if (strcmp (line, "s SATISFIABLE\n")) die ("expected satisfiable");
+	satisfiable = 1;
+      }
+    else if (line[0] == 'v')
+      {
+	char * p = line + 1, * end;
+	long lit;
+	while ((lit = strtol (p, &end, 10)), end != p)
+	  {
+	    if (lit) set_val (lit);
+	    p = end;
+	  }
+      }
+  if (!satisfiable) die ("no solution line in '%s'", name);
+  free (line);
+  fclose (file);
+}
+
+int
+main (int argc, char ** argv)
+{
+  if (argc != 3) die ("usage: knfchk <knf> <solution>");
+  parse_solution (argv[2]);
+  FILE * file = fopen (argv[1], "r");
+  if (!file) die ("can not read '%s'", argv[1]);
+  int ch, count = 0, vars, constraints;
+  while ((ch = getc (file)) == 'c')
+    while ((ch = getc (file)) != '\n')
+      if (ch == EOF) die ("unexpected end-of-file in '%s'", argv[1]);
+  if (ch != 'p' ||
+      fscanf (file, " %*[ck]nf %d %d", &vars, &constraints) != 2)
+    die ("invalid header in '%s'", argv[1]);
+  char type;
+  while (fscanf (file, " %c", &type) == 1)
+    {
+      if (type == 'c')
+	{
+	  while ((ch = getc (file)) != '\n' && ch != EOF)
+	    ;
+	  continue;
+	}
+      if (type == 'e' && fscanf (file, " %c", &type) != 1)
+	die ("expected constraint after 'e'");
+      int bound = 1, guard = 0, satisfied = 0, lit = 0;
+      if (type == 'k' || type == 'g')
+	{
+	  if (fscanf (file, "%d", &bound) != 1) die ("expected bound");
+	  if (type == 'g' && fscanf (file, "%d", &guard) != 1)
+	    die ("expected guard");
+	}
+      else if (type == '-' || isdigit ((unsigned char) type))
+	ungetc (type, file);
+      else die ("unexpected character '%c'", type);
+      while (fscanf (file, "%d", &lit) == 1 && lit)
+	if (val (lit) > 0) satisfied++;
+      if (lit) die ("expected zero after constraint %d", count + 1);
+      count++;
+      if (guard && val (guard) > 0) continue;
+      if (satisfied < bound)
+	die ("constraint %d falsified (%d true literals but bound %d)",
+	     count, satisfied, bound);
+    }
+  fclose (file);
+  if (count != constraints)
+    die ("parsed %d constraints but expected %d", count, constraints);
+  printf ("c [knfchk] all %d constraints satisfied\n", count);
+  return 0;
+}
@@ -0,0 +1,274 @@
+// Checks an LRAT proof (text or binary) of the solver against the CNF
+// formula written to '<proof>.cnf'.  Every added clause has to follow by
+// unit propagation over its hints in the given order (RAT hints are not
+// supported) and the proof has to derive the empty clause.
+//
+//   lratchk <cnf> <lrat>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+
+static const char * proof_name;
+static FILE * proof;
+
+static void
+die (const char * fmt, ...)
+{
+  va_list ap;
+  fputs ("*** lratchk: ", stdout);
+  va_start (ap, fmt);
+  vfprintf (stdout, fmt, ap);
+  va_end (ap);
+  fputc ('\n', stdout);
+  exit (1);
+}
+
+/*------------------------------------------------------------------------*/
+
+static int ** clauses;          // zero terminated, indexed by identifier
+static int64_t size_clauses;
+
+static signed char * vals;      // indexed by variable
+static int size_vals;
+static int * trail, size_trail, capacity_trail;
+
+static int * lits, size_lits, capacity_lits;
+
+static void
+push_lit (int lit)
+{
+  int idx = abs (lit);
+  if (idx >= size_vals)
+    {
+      int new_size = size_vals ? 2 * size_vals : 1024;
+      while (new_size <= idx) new_size *= 2;
+      vals = realloc (vals, new_size);
+      if (!vals) die ("out of memory");
+      memset (vals + size_vals, 0, new_size - size_vals);
+      size_vals = new_size;
+    }
+  if (size_lits == capacity_lits)
+    {
+      capacity_lits = capacity_lits ? 2 * capacity_lits : 64;
+      lits = realloc (lits, capacity_lits * sizeof *lits);
+      if (!lits) die ("out of memory");
+    }
+  lits[size_lits++] = lit;
+}
+
+static void
+add_clause (int64_t id)
+{
+  if (id <= 0) die ("invalid clause identifier %lld", (long long) id);
+  if (id >= size_clauses)
+    {
+      int64_t new_size = size_clauses ? 2 * size_clauses : 1024;
+      while (new_size <= id) new_size *= 2;
+      clauses = realloc (clauses, new_size * sizeof *clauses);
+      if (!clauses) die ("out of memory");
+      memset (clauses + size_clauses, 0,
+	      (new_size - size_clauses) * sizeof *clauses);
+      size_clauses = new_size;
+    }
+  if (clauses[id]) die ("clause %lld added twice", (long long) id);
+  int * c = malloc ((size_lits + 1) * sizeof *c);
+  if (!c) die ("out of memory");
+  memcpy (c, lits, size_lits * sizeof *c);
+  c[size_lits] = 0;
+  clauses[id] = c;
+}
+
+static int
+val (int lit)
+{
+  int res = vals[abs (lit)];
+  return lit < 0 ? -res : res;
+}
+
+static void
+assign (int lit)
+{
+  if (size_trail == capacity_trail)
+    {
+      capacity_trail = capacity_trail ? 2 * capacity_trail : 64;
+      trail = realloc (trail, capacity_trail * sizeof *trail);
+      if (!trail) die ("out of memory");
+    }
+  trail[size_trail++] = lit;
+  vals[abs (lit)] = lit < 0 ? -1 : 1;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+parse_cnf (const char * name)
+{
+  FILE * file = fopen (name, "r");
+  if (!file) die ("can not read '%s'", name);
+  int ch, lit, vars, count;
+  while ((ch = getc (file)) == 'c')
+    while ((ch = getc (file)) != '\n')
+      if (ch == EOF) die ("unexpected end-of-file in '%s'", name);
+  if (ch != 'p' || fscanf (file, " cnf %d %d", &vars, &count) != 2)
+    die ("invalid header in '%s'", name);
+  int64_t id = 0;
+  while (fscanf (file, "%d", &lit) == 1)
+    if (lit) push_lit (lit);
+    else add_clause (++id), size_lits = 0;
+  if (size_lits || getc (file) != EOF)
+    die ("invalid clause in '%s'", name);
+  if (id != count)
+    die ("'%s' has %lld clauses but expected %d",
+	 name, (long long) id, count);
+  fclose (file);
+  return count;
+}
+
+/*------------------------------------------------------------------------*/
+
+// Numbers of binary proofs are varints of '2*|x| + (x < 0)' (as in binary
+// DRAT), while text proofs use plain numbers.
+
+static int binary;
+
+static void
+read_number (int64_t * res)
+{
+  if (binary)
+    {
+      uint64_t u = 0;
+      unsigned shift = 0;
+      int ch;
+      do
+	{
+	  if ((ch = getc (proof)) == EOF)
+	    die ("unexpected end-of-file in '%s'", proof_name);
+	  if (shift > 63) die ("number too large in '%s'", proof_name);
+	  u |= (uint64_t) (ch & 0x7f) << shift;
+	  shift += 7;
+	}
+      while (ch & 0x80);
+      *res = (u & 1) ? -(int64_t) (u >> 1) : (int64_t) (u >> 1);
+      return;
+    }
+  long long tmp;
+  if (fscanf (proof, "%lld", &tmp) != 1)
+    die ("expected number in '%s'", proof_name);
+  *res = tmp;
+}
+
+// Reads 'a' or 'd' (or the identifier and 'd' in text proofs) and returns
+// zero at the end of the proof.
+
+static int
+read_step (int64_t * id, int * deletion)
+{
+  int ch;
+  if (binary)
+    {
+      if ((ch = getc (proof)) == EOF) return 0;
+      if (ch != 'a' && ch != 'd')
+	die ("invalid binary step '%c' in '%s'", ch, proof_name);
+      *deletion = (ch == 'd');
+      if (!*deletion) read_number (id);
+      return 1;
+    }
+  long long tmp;
+  if (fscanf (proof, "%lld", &tmp) != 1)
+    {
+      char tail;
+      if (fscanf (proof, " %c", &tail) != EOF)
+	die ("expected identifier in '%s'", proof_name);
+      return 0;
+    }
+  *id = tmp;
+  while ((ch = getc (proof)) == ' ')
+    ;
+  *deletion = (ch == 'd');
+  if (!*deletion) ungetc (ch, proof);
+  return 1;
+}
+
+static void
+check_addition (int64_t id)
+{
+  int conflict = 0;
+  size_trail = 0;
+  for (int i = 0; i < size_lits; i++)
+    if (!val (lits[i])) assign (-lits[i]);
+  int64_t hint;
+  while (read_number (&hint), hint)
+    {
+      if (conflict) continue;
+      if (hint < 0) die ("RAT hint in clause %lld", (long long) id);
+      if (hint >= size_clauses || !clauses[hint])
+	die ("unknown hint %lld in clause %lld",
+	     (long long) hint, (long long) id);
+      int unit = 0, unassigned = 0;
+      for (const int * p = clauses[hint]; *p; p++)
+	{
+	  int tmp = val (*p);
+	  if (tmp > 0)
+	    die ("satisfied hint %lld in clause %lld",
+		 (long long) hint, (long long) id);
+	  if (!tmp) unit = *p, unassigned++;
+	}
+      if (!unassigned) conflict = 1;
+      else if (unassigned > 1)
+	die ("hint %lld in clause %lld is not unit",
+	     (long long) hint, (long long) id);
+      else assign (unit);
+    }
+  for (int i = 0; i < size_trail; i++) vals[abs (trail[i])] = 0;
+  if (!conflict)
+    die ("hints of clause %lld without conflict", (long long) id);
+}
+
+int
+main (int argc, char ** argv)
+{
+  if (argc != 3) die ("usage: lratchk <cnf> <lrat>");
+  int originals = parse_cnf (argv[1]);
+  proof_name = argv[2];
+  if (!(proof = fopen (proof_name, "r")))
+    die ("can not read '%s'", proof_name);
+  int ch = getc (proof);
+  binary = (ch == 'a' || ch == 'd');
+  ungetc (ch, proof);
+  int64_t id, added = 0, deleted = 0, empty = 0;
+  int deletion;
+  while (read_step (&id, &deletion))
+    if (deletion)
+      {
+	int64_t other;
+	while (read_number (&other), other)
+	  {
+	    if (other < 0 || other >= size_clauses || !clauses[other])
+	      die ("deleting unknown clause %lld", (long long) other);
+	    free (clauses[other]);
+	    clauses[other] = 0;
+	    deleted++;
+	  }
+      }
+    else
+      {
+	int64_t lit;
+	size_lits = 0;
+	while (read_number (&lit), lit) push_lit (lit);
+	check_addition (id);
+	add_clause (id);
+	if (!size_lits && !empty) empty = id;
+	added++;
+      }
+  fclose (proof);
+  printf ("c [lratchk] %d original clauses, %lld added and %lld deleted\n",
+	  originals, (long long) added, (long long) deleted);
+  if (!empty) die ("no empty clause derived");
+  printf ("s VERIFIED\n");
+  for (int64_t i = 0; i < size_clauses; i++) free (clauses[i]);
+  free (clauses), free (vals), free (trail), free (lits);
+  return 0;
+}
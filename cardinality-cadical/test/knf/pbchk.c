@@ -0,0 +1,337 @@
+// Checks a VeriPB proof of the solver against the OPB formula written to
+// '<proof>.opb', as a stand-in for 'veripb' (which is not needed to run the
+// tests).  Only the steps written by the solver are supported: clauses
+// derived by reverse unit propagation ('rup') over the pseudo-Boolean
+// constraints, deletions by identifier and the unsatisfiability conclusion
+// which has to refer to a derived empty clause.
+//
+//   pbchk <opb> <proof>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+
+static const char * name;
+static int lineno;
+
+static void
+die (const char * fmt, ...)
+{
+  va_list ap;
+  fputs ("*** pbchk: ", stdout);
+  if (name) printf ("%s:%d: ", name, lineno);
+  va_start (ap, fmt);
+  vfprintf (stdout, fmt, ap);
+  va_end (ap);
+  fputc ('\n', stdout);
+  exit (1);
+}
+
+static void *
+grow (void * ptr, int * capacity, size_t bytes)
+{
+  *capacity = *capacity ? 2 * *capacity : 16;
+  if (!(ptr = realloc (ptr, *capacity * bytes))) die ("out of memory");
+  return ptr;
+}
+
+/*------------------------------------------------------------------------*/
+
+// Constraints 'sum coefs[i] lits[i] >= bound' indexed by identifier.
+
+typedef struct Constraint {
+  int64_t bound;
+  int size, deleted;
+  int64_t * coefs;
+  int * lits;
+} Constraint;
+
+static Constraint * constraints;
+static int size_constraints, capacity_constraints;
+
+// Constraints with literal 'lit' are in 'occs[2*|lit| + (lit < 0)]'.
+
+typedef struct Occs { int * ids, size, capacity; } Occs;
+
+static Occs * occs;
+static signed char * vals;
+static int size_vals;
+
+static int * trail, size_trail, capacity_trail;
+
+static int64_t * coefs;
+static int * lits, size_lits, capacity_lits;
+
+static unsigned
+ulit (int lit)
+{
+  return 2u * abs (lit) + (lit < 0);
+}
+
+static void
+push_term (int64_t coef, int lit)
+{
+  int idx = abs (lit);
+  if (idx >= size_vals)
+    {
+      int new_size = size_vals ? 2 * size_vals : 1024;
+      while (new_size <= idx) new_size *= 2;
+      if (!(vals = realloc (vals, new_size))) die ("out of memory");
+      if (!(occs = realloc (occs, 2 * new_size * sizeof *occs)))
+	die ("out of memory");
+      memset (vals + size_vals, 0, new_size - size_vals);
+      memset (occs + 2 * size_vals, 0,
+	      2 * (new_size - size_vals) * sizeof *occs);
+      size_vals = new_size;
+    }
+  if (size_lits == capacity_lits)
+    {
+      int tmp = capacity_lits;
+      lits = grow (lits, &capacity_lits, sizeof *lits);
+      coefs = grow (coefs, &tmp, sizeof *coefs);
+    }
+  coefs[size_lits] = coef;
+  lits[size_lits++] = lit;
+}
+
+static int
+add_constraint (int64_t bound)
+{
+  if (size_constraints == capacity_constraints)
+    constraints = grow (constraints, &capacity_constraints,
+			sizeof *constraints);
+  int id = size_constraints++;
+  Constraint * c = constraints + id;
+  c->bound = bound;
+  c->size = size_lits;
+  c->deleted = 0;
+  if (!(c->coefs = malloc (size_lits * sizeof *c->coefs + 1)) ||
+      !(c->lits = malloc (size_lits * sizeof *c->lits + 1)))
+    die ("out of memory");
+  memcpy (c->coefs, coefs, size_lits * sizeof *coefs);
+  memcpy (c->lits, lits, size_lits * sizeof *lits);
+  for (int i = 0; i < size_lits; i++)
+    {
+      Occs * o = occs + ulit (lits[i]);
+      if (o->size == o->capacity)
+	o->ids = grow (o->ids, &o->capacity, sizeof *o->ids);
+      o->ids[o->size++] = id;
+    }
+  return id;
+}
+
+/*------------------------------------------------------------------------*/
+
+static int
+val (int lit)
+{
+  int res = vals[abs (lit)];
+  return lit < 0 ? -res : res;
+}
+
+static void
+assign (int lit)
+{
+  if (size_trail == capacity_trail)
+    trail = grow (trail, &capacity_trail, sizeof *trail);
+  trail[size_trail++] = lit;
+  vals[abs (lit)] = lit < 0 ? -1 : 1;
+}
+
+// Assigns the literals implied by the constraint and returns zero if it is
+// falsified, where the slack is the sum of the coefficients of all
+// literals which are not false minus the bound.
+
+static int
+propagate_constraint (const Constraint * c)
+{
+  int64_t slack = -c->bound;
+  for (int i = 0; i < c->size; i++)
+    if (val (c->lits[i]) >= 0) slack += c->coefs[i];
+  if (slack < 0) return 0;
+  for (int i = 0; i < c->size; i++)
+    if (!val (c->lits[i]) && c->coefs[i] > slack) assign (c->lits[i]);
+  return 1;
+}
+
+// Checks that assigning the literals of the clause to false leads to a
+// conflict by unit propagation over all (not deleted) constraints.
+
+static int
+rup (void)
+{
+  int res = 0;
+  size_trail = 0;
+  for (int i = 0; i < size_lits; i++)
+    if (!val (lits[i])) assign (-lits[i]);
+  for (int id = 0; !res && id < size_constraints; id++)
+    if (!constraints[id].deleted)
+      res = !propagate_constraint (constraints + id);
+  for (int next = 0; !res && next < size_trail; next++)
+    {
+      const Occs * o = occs + ulit (-trail[next]);
+      for (int i = 0; !res && i < o->size; i++)
+	if (!constraints[o->ids[i]].deleted)
+	  res = !propagate_constraint (constraints + o->ids[i]);
+    }
+  for (int i = 0; i < size_trail; i++) vals[abs (trail[i])] = 0;
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static FILE * file;
+static char token[64];
+
+static const char *
+next_token (void)
+{
+  int ch;
+  while ((ch = getc (file)) == ' ' || ch == '\t' || ch == '\n')
+    if (ch == '\n') lineno++;
+  if (ch == EOF) return 0;
+  size_t n = 0;
+  do
+    {
+      if (n + 1 == sizeof token) die ("token too long");
+      token[n++] = ch;
+    }
+  while ((ch = getc (file)) != EOF && ch != ' ' && ch != '\t' && ch != '\n');
+  token[n] = 0;
+  if (ch == '\n') ungetc (ch, file);
+  return token;
+}
+
+static const char *
+expect_token (void)
+{
+  const char * res = next_token ();
+  if (!res) die ("unexpected end-of-file");
+  return res;
+}
+
+static int64_t
+parse_number (const char * str)
+{
+  char * end;
+  long long res = strtoll (str, &end, 10);
+  if (!*str || *end) die ("expected number but got '%s'", str);
+  return res;
+}
+
+// Parses 'coef lit ... >= bound ;' into 'coefs' and 'lits'.
+
+static int64_t
+parse_constraint (void)
+{
+  const char * tok;
+  size_lits = 0;
+  while (strcmp (tok = expect_token (), ">="))
+    {
+      int64_t coef = parse_number (tok);
+      tok = expect_token ();
+      int sign = 1;
+      if (*tok == '~') sign = -1, tok++;
+      if (*tok++ != 'x') die ("expected variable but got '%s'", token);
+      int64_t idx = parse_number (tok);
+      if (idx <= 0 || idx > INT32_MAX) die ("invalid variable");
+      if (coef <= 0) die ("expected positive coefficient");
+      push_term (coef, sign * (int) idx);
+    }
+  int64_t bound = parse_number (expect_token ());
+  if (strcmp (expect_token (), ";")) die ("expected ';'");
+  return bound;
+}
+
+static void
+skip_line (void)
+{
+  int ch;
+  while ((ch = getc (file)) != '\n')
+    if (ch == EOF) return;
+  lineno++;
+}
+
+static int
+parse_opb (const char * path)
+{
+  if (!(file = fopen (name = path, "r"))) die ("can not read formula");
+  lineno = 1;
+  int ch;
+  while ((ch = getc (file)) != EOF)
+    if (ch == '*') skip_line ();
+    else if (ch == '\n') lineno++;
+    else
+      {
+	ungetc (ch, file);
+	add_constraint (parse_constraint ());
+      }
+  fclose (file);
+  return size_constraints;
+}
+
+static void
+expect (const char * str)
+{
+  if (strcmp (expect_token (), str)) die ("expected '%s'", str);
+}
+
+int
+main (int argc, char ** argv)
+{
+  if (argc != 3) die ("usage: pbchk <opb> <proof>");
+  int originals = parse_opb (argv[1]);
+  if (!(file = fopen (name = argv[2], "r"))) die ("can not read proof");
+  lineno = 1;
+  expect ("pseudo-Boolean"), expect ("proof"), expect ("version");
+  expect_token ();
+  expect ("f");
+  if (parse_number (expect_token ()) != originals)
+    die ("expected %d original constraints", originals);
+  expect (";");
+  int64_t added = 0, deleted = 0, empty = 0, concluded = 0;
+  const char * tok;
+  while ((tok = expect_token ()) && strcmp (tok, "end"))
+    if (!strcmp (tok, "rup"))
+      {
+	if (parse_constraint () != 1) die ("only clauses are supported");
+	for (int i = 0; i < size_lits; i++)
+	  if (coefs[i] != 1) die ("only clauses are supported");
+	if (!rup ()) die ("clause %d does not follow by unit propagation",
+			  size_constraints + 1);
+	add_constraint (1);
+	if (!size_lits && !empty) empty = size_constraints;
+	added++;
+      }
+    else if (!strcmp (tok, "del"))
+      {
+	expect ("id");
+	int64_t id = parse_number (expect_token ());
+	if (id <= 0 || id > size_constraints || constraints[id - 1].deleted)
+	  die ("deleting unknown constraint %lld", (long long) id);
+	constraints[id - 1].deleted = 1;
+	deleted++;
+      }
+    else if (!strcmp (tok, "output"))
+      {
+	expect ("NONE"), expect (";");
+      }
+    else if (!strcmp (tok, "conclusion"))
+      {
+	expect ("UNSAT"), expect (":");
+	concluded = parse_number (expect_token ());
+	expect (";");
+      }
+    else die ("unsupported rule '%s'", tok);
+  expect ("pseudo-Boolean"), expect ("proof"), expect (";");
+  fclose (file);
+  name = 0;
+  printf ("c [pbchk] %d original constraints, %lld added and %lld deleted\n",
+	  originals, (long long) added, (long long) deleted);
+  if (!empty) die ("no empty clause derived");
+  if (concluded != empty) die ("conclusion does not refer to empty clause");
+  printf ("s VERIFIED\n");
+  return 0;
+}
@@ -0,0 +1,211 @@
+#!/bin/sh
+
+#--------------------------------------------------------------------------#
+
+die () {
+  cecho "${HIDE}test/knf/run.sh:${NORMAL} ${BAD}error:${NORMAL} $*"
+  exit 1
+}
+
+msg () {
+  cecho "${HIDE}test/knf/run.sh:${NORMAL} $*"
+}
+
+for dir in . .. ../..
+do
+  [ -f $dir/scripts/colors.sh ] || continue
+  . $dir/scripts/colors.sh || exit 1
+  break
+done
+
+#--------------------------------------------------------------------------#
+
+[ -d ../test -a -d ../test/knf ] || \
+die "needs to be called from a top-level sub-directory of CaDiCaL"
+
+[ x"$CADICALBUILD" = x ] && CADICALBUILD="../build"
+
+[ -x "$CADICALBUILD/cadical" ] || \
+  die "can not find '$CADICALBUILD/cadical' (run 'make' first)"
+
+cecho -n "$HILITE"
+cecho "---------------------------------------------------------"
+cecho "KNF testing in '$CADICALBUILD'" 
+cecho "---------------------------------------------------------"
+cecho -n "$NORMAL"
+
+make -C $CADICALBUILD
+res=$?
+[ $res = 0 ] || exit $res
+
+#--------------------------------------------------------------------------#
+
+solver="$CADICALBUILD/cadical"
+solutionchecker=$CADICALBUILD/knfchk
+pbchecker=$CADICALBUILD/pbchk
+lratchecker=$CADICALBUILD/lratchk
+
+if [ ! -f $solutionchecker -o ../test/knf/knfchk.c -nt $solutionchecker ]
+then
+  cmd="cc -O -o $solutionchecker ../test/knf/knfchk.c"
+  cecho "$cmd"
+  if $cmd 2>/dev/null
+  then
+    msg "external solution checking with '$solutionchecker'"
+  else
+    msg "no external solution checking " \
+        "(compiling '../test/knf/knfchk.c' failed)"
+    solutionchecker=none
+  fi
+fi
+
+if [ ! -f $pbchecker -o ../test/knf/pbchk.c -nt $pbchecker ]
+then
+  cmd="cc -O -o $pbchecker ../test/knf/pbchk.c"
+  cecho "$cmd"
+  if $cmd 2>/dev/null
+  then
+    msg "external VeriPB proof checking with '$pbchecker'"
+  else
+    msg "no external VeriPB proof checking " \
+        "(compiling '../test/knf/pbchk.c' failed)"
+    pbchecker=none
+  fi
+fi
+
+if [ ! -f $lratchecker -o ../test/knf/lratchk.c -nt $lratchecker ]
+then
+  cmd="cc -O -o $lratchecker ../test/knf/lratchk.c"
+  cecho "$cmd"
+  if $cmd 2>/dev/null
+  then
+    msg "external LRAT proof checking with '$lratchecker'"
+  else
+    msg "no external LRAT proof checking " \
+        "(compiling '../test/knf/lratchk.c' failed)"
+    lratchecker=none
+  fi
+fi
+
+#--------------------------------------------------------------------------#
+
+ok=0
+failed=0
+
+run () {
+  msg "running KNF test ${HILITE}'$1'${NORMAL}"
+  prefix=$CADICALBUILD/test-knf
+  knf=../test/knf/$1.knf
+  log=$prefix-$1.log
+  err=$prefix-$1.err
+  chk=$prefix-$1.chk
+  opts="$knf $3"
+  cecho "$solver \\"
+  cecho "$opts"
+  cecho -n "# $2 ..."
+  "$solver" $opts 1>$log 2>$err
+  res=$?
+  if [ ! $res = $2 ] 
+  then
+    cecho " ${BAD}FAILED${NORMAL} (actual exit code $res)"
+    failed=`expr $failed + 1`
+  elif [ $res = 10 -a ! x"$solutionchecker" = xnone ]
+  then
+    cecho " ${GOOD}ok${NORMAL} (exit code '$res' as expected)"
+    cecho "$solutionchecker \\"
+    cecho "$knf $log"
+    cecho -n "# 0 ..."
+    if $solutionchecker $knf $log 1>$chk 2>&1
+    then
+      cecho " ${GOOD}ok${NORMAL} (solution checked externally)"
+      ok=`expr $ok + 1`
+    else
+      cecho " ${BAD}FAILED${NORMAL} (incorrect solution)"
+      failed=`expr $failed + 1`
+    fi
+  else
+    cecho " ${GOOD}ok${NORMAL} (exit code '$res' as expected)"
+    ok=`expr $ok + 1`
+  fi
+}
+
+# Runs an unsatisfiable formula with a proof in format '$2' (VeriPB or
+# LRAT), where the formula goes to '<proof>.$4', and checks it with '$3'.
+
+proof () {
+  msg "running KNF test ${HILITE}'$1'${NORMAL} with $2 proof"
+  prefix=$CADICALBUILD/test-knf-$2
+  knf=../test/knf/$1.knf
+  prf=$prefix-$1.prf
+  log=$prefix-$1.log
+  err=$prefix-$1.err
+  chk=$prefix-$1.chk
+  opts="$knf --$2 $prf $5"
+  cecho "$solver \\"
+  cecho "$opts"
+  cecho -n "# 20 ..."
+  "$solver" $opts 1>$log 2>$err
+  res=$?
+  if [ ! $res = 20 ]
+  then
+    cecho " ${BAD}FAILED${NORMAL} (actual exit code $res)"
+    failed=`expr $failed + 1`
+  elif [ x"$3" = xnone ]
+  then
+    cecho " ${GOOD}ok${NORMAL} (proof not checked)"
+    ok=`expr $ok + 1`
+  else
+    cecho " ${GOOD}ok${NORMAL} (exit code '20' as expected)"
+    cecho "$3 \\"
+    cecho "$prf.$4 $prf"
+    cecho -n "# 0 ..."
+    if $3 $prf.$4 $prf 1>$chk 2>&1
+    then
+      cecho " ${GOOD}ok${NORMAL} (proof checked)"
+      ok=`expr $ok + 1`
+    else
+      cecho " ${BAD}FAILED${NORMAL} (proof check failed)"
+      failed=`expr $failed + 1`
+    fi
+  fi
+}
+
+veripb () {
+  proof $1 veripb $pbchecker opb "$2"
+}
+
+lrat () {
+  proof $1 lrat $lratchecker cnf "$2"
+}
+
+run guard1 10
+run guard2 10
+run guard3 20
+run guard4 20 "--ccdclMode=1 --ccdclEncoding=3"
+
+veripb guard3
+veripb guard4
+veripb ph5
+veripb ph5 "--ccdclMode=1 --ccdclEncoding=3"
+
+lrat guard3
+lrat guard4
+lrat ph5
+lrat ph5 "--no-binary"
+lrat ph5 "--ccdclMode=1 --ccdclEncoding=3"
+
+compact="--compact --compactint=1 --compactlim=0 --compactmin=1"
+
+run compact1 10 "$compact"
+run compact1 10 "$compact --ccdclEncoding=1"
+run compact2 20 "$compact"
+veripb compact2 "$compact"
+
+#--------------------------------------------------------------------------#
+
+[ $ok -gt 0 ] && OK="$GOOD"
+[ $failed -gt 0 ] && FAILED="$BAD"
+
+msg "${HILITE}KNF testing results:${NORMAL} ${OK}$ok ok${NORMAL}, ${FAILED}$failed failed${NORMAL}"
+
+exit $failed
@@ -6,3 +6,4 @@ rm -r tmp
 (cd Extractor/cnf2knf; sh clean.sh)
 (cd cardinality-cadical; make clean)
 rm Tools/check-sat/check-sat
+rm Tools/ccdcl/ccdcl